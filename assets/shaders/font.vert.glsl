@@ -1,9 +1,11 @@
 #version 330 core
 
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec2 texCoord;
-layout(location = 2) in vec4 color;
-layout(location = 3) in float texIndex;
+// One instance per quad, drawn as a strip of 4 vertices that only differ by gl_VertexID
+layout(location = 0) in vec3 origin;    // Bottom left corner
+layout(location = 1) in vec2 size;      // Clip space times 8192
+layout(location = 2) in vec4 texRect;   // s, t, u, v
+layout(location = 3) in vec4 color;
+layout(location = 4) in float texIndex;
 
 uniform sampler2D u_textures[10];
 
@@ -13,8 +15,10 @@ out float v_texIndex;
 
 void main()
 {
-    v_texCoord = texCoord;
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    v_texCoord = vec2(mix(texRect.x, texRect.z, corner.x), mix(texRect.w, texRect.y, corner.y));
     v_color = color;
     v_texIndex = texIndex;
-    gl_Position = vec4(position, 1.0);
+    gl_Position = vec4(origin.xy + corner * size / 8192.0, origin.z, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+
+layout(location = 0) in vec3 star;      // Position in the playground (0 to 1) and depth
+layout(location = 1) in vec2 corner;    // Offset of this corner from the star in playground units
+layout(location = 2) in vec2 texCoord;
+
+uniform vec2 u_playground;
+uniform vec2 u_parallax;    // Offset of the nearest stars, further ones move less
+uniform vec4 u_transform;   // Scale (xy) and offset (zw) from playground to screen units
+uniform vec2 u_screenSize;
+uniform float u_z;
+
+out vec2 v_texCoord;
+
+void main()
+{
+    vec2 position = u_playground * star.xy + (1.0 - star.z * star.z) * u_parallax + corner;
+    vec2 screen   = u_transform.xy * position + u_transform.zw;
+
+    vec2 clip = 2.0 * (screen / u_screenSize) - 1.0;
+    clip.y = -clip.y;
+
+    v_texCoord = texCoord;
+    gl_Position = vec4(clip, u_z, 1.0);
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Builds the headless gameplay benchmark (no window, GPU or audio)
+# Run the resulting executable from the repository root so it can find the assets
+
+set -e
+
+executable_name="benchmark"
+
+compiler=${CXX:-g++}
+c_compiler=${CC:-gcc}
+
+defines="-DGN_PLATFORM_LINUX -DGN_USE_OPENGL -DGN_HEADLESS -DGN_CUSTOM_MAIN -DGN_RELEASE -DNDEBUG -DGN_COMPILER_GCC"
+# String literals go straight into ref(), which takes a char*, all over the code base
+compile_flags="-std=c++17 -O2 -msse4.1 -Wno-write-strings"
+
+includes="-I src -I dependencies/glad/include -I dependencies/stb/include -I dependencies/miniz/include"
+
+mkdir -p _benchmark_build
+cd _benchmark_build
+
+# Dependencies
+$c_compiler -O2 -c ../dependencies/glad/src/glad.c -I ../dependencies/glad/include
+$c_compiler -O2 -w -c ../dependencies/miniz/src/miniz.c -I ../dependencies/miniz/include
+$compiler $compile_flags -w -c ../dependencies/stb/src/stb_image.cpp -I ../src
+
+# Source
+cd ..
+sources="src/serialization/json/*.cpp src/serialization/binary/*.cpp src/audio/*.cpp src/fileio/*.cpp
+         src/graphics/*.cpp src/platform/*.cpp src/application/*.cpp src/core/*.cpp src/math/*.cpp
+         src/engine/*.cpp src/game/*.cpp src/benchmark/*.cpp"
+
+$compiler $compile_flags $defines $includes $sources _benchmark_build/*.o -o $executable_name -lpthread
+
+rm -rf _benchmark_build
@@ -47,11 +47,11 @@ struct Application
 
     bool is_running;
 
-    Function<void(Application& app)> on_init     = [](Application&) {};
-    Function<void(Application& app)> on_update   = [](Application&) {};
-    Function<void(Application& app)> on_render   = [](Application&) {};
-    Function<void(Application& app)> on_shutdown = [](Application&) {};
-    Function<void(Application& app)> on_window_resize = [](Application&) {};
+    Function<void(Application& app)> on_init     { [](Application&) {} };
+    Function<void(Application& app)> on_update   { [](Application&) {} };
+    Function<void(Application& app)> on_render   { [](Application&) {} };
+    Function<void(Application& app)> on_shutdown { [](Application&) {} };
+    Function<void(Application& app)> on_window_resize { [](Application&) {} };
 };
 
 void application_set_active(Application& app);
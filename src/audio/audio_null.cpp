@@ -0,0 +1,91 @@
+#include "audio.h"
+
+#ifndef GN_PLATFORM_WINDOWS
+
+#include "containers/bytes.h"
+#include "core/types.h"
+
+// Silent backend for platforms without an audio implementation (and headless tools).
+// Everything succeeds but nothing is ever played, so sources are never active.
+
+namespace Audio
+{
+
+bool init()
+{
+    return true;
+}
+
+void shutdown()
+{
+}
+
+void pool_sources()
+{
+}
+
+bool load_from_bytes(const Bytes, Sound& sound)
+{
+    // The samples are never played so there's no need to keep them around
+    sound = Sound {};
+    return true;
+}
+
+Source source_create(const WavFmtData&)
+{
+    return nullptr;
+}
+
+void source_destroy(Audio::Source& source)
+{
+    source = nullptr;
+}
+
+void source_resume(Audio::Source&)
+{
+}
+
+void source_pause(Audio::Source&)
+{
+}
+
+void source_stop(Audio::Source&)
+{
+}
+
+void source_set_volume(Audio::Source&, f32)
+{
+}
+
+bool source_is_playing(const Audio::Source&)
+{
+    return false;
+}
+
+bool play_buffer(Source&, const Bytes, bool, bool)
+{
+    return true;
+}
+
+bool play_sound(const Sound&, bool)
+{
+    return true;
+}
+
+void set_master_volume(f32)
+{
+}
+
+s32 get_active_source_count()
+{
+    return 0;
+}
+
+s32 get_total_source_count()
+{
+    return 0;
+}
+
+} // namespace Audio
+
+#endif // GN_PLATFORM_WINDOWS
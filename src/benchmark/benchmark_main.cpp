@@ -0,0 +1,763 @@
+// Headless gameplay benchmark
+// Runs game_state_simulate as fast as possible with fixed time steps and
+// reports the tick times and entity counts as json. No window, GPU or audio is used.
+//
+// Usage: benchmark [--ticks N] [--dt SECONDS] [--stage N] [--enemy-multiplier N] [--seed N] [--bot-seed N] [--bot-skill 0-1]
+//                  [--threads N] [--pattern-stage N] [--replay FILE] [--record FILE] [--snapshot-interval N]
+//                  [--render-interval N] [--render-backend null|software] [--commands FILE] [--frame FILE] [--output FILE]
+//
+// The input comes from GameBot, --bot-seed defaults to --seed. Memory use doesn't grow with the tick count
+// (tick times and entity counts go into histograms) so it can soak for hours.
+//
+// Entity histograms count ticks by entity count, bucket 0 is an empty tick and bucket i (> 0) holds counts in [2^(i-1), 2^i).
+//
+// --pattern-stage overrides the stage the bullet pattern script starts at, 0 turns the patterns off.
+// Replays have to be played back with the same value they were recorded with.
+//
+// --threads is the total thread count of the job system, 0 uses every processor and 1 runs everything inline.
+//
+// --record saves the bot's input as a replay (always starting from stage 1), playing it back
+// with --replay has to end with the same final score or the simulation isn't deterministic.
+//
+// --snapshot-interval takes a snapshot every N ticks, restores it right away and checks that
+// snapshotting the restored state gives the same bytes. This must not change the final score.
+//
+// --render-interval runs game_state_render every N ticks and reports how long it took (backend included).
+// With the null backend (default) the hash of the last frame is a hash of its commands, --commands saves them as text to diff.
+// With the software backend every frame is rasterized on the CPU and the hash is a hash of the pixels,
+// --frame saves the last one as a png. Either hash only changes if what's rendered does, so they work as golden values.
+// The star background is drawn outside Imgui and isn't part of either.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "application/application.h"
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "engine/imgui.h"
+#include "engine/render_backend.h"
+#include "engine/render_commands.h"
+#include "engine/sprite.h"
+#include "engine/sprite_atlas.h"
+#include "engine/sprite_serialization.h"
+#include "fileio/fileio.h"
+#include "game/game_bot.h"
+#include "game/game_input.h"
+#include "game/game_replay.h"
+#include "game/game_settings.h"
+#include "game/game_snapshot.h"
+#include "game/game_state.h"
+#include "math/common.h"
+#include "platform/platform.h"
+#include "serialization/json.h"
+
+struct BenchmarkOptions
+{
+    u64 tick_count;
+    f32 time_step;
+    u32 stage_number;
+    u32 enemy_multiplier;
+    u64 seed;
+    u64 bot_seed;
+    f32 bot_skill;
+    u64 snapshot_interval;
+    u64 render_interval;
+    u32 thread_count;
+    s64 pattern_stage;      // Negative keeps the one from bullet_patterns.json
+    const char* replay_path;
+    const char* record_path;
+    const char* commands_path;
+    const char* frame_path;
+    bool software_render;
+    const char* output_path;
+};
+
+namespace EntityCategory
+{
+    enum
+    {
+        PLAYER_BULLETS,
+        ENEMY_BULLETS,
+        PATTERN_BULLETS,
+        ENEMIES,
+        KAMIKAZE_ENEMIES,
+        EXPLOSIONS,
+        PICKUPS,
+        PARTICLES,
+
+        COUNT
+    };
+}
+
+static const char* entity_category_names[EntityCategory::COUNT] = {
+    "player_bullets", "enemy_bullets", "pattern_bullets", "enemies", "kamikaze_enemies", "explosions", "pickups", "particles"
+};
+
+static constexpr u64 entity_histogram_bucket_count = 65;
+
+// Every power of 2 of nanoseconds is split into 8 buckets, so a percentile is within 1/8 of the real time
+static constexpr u64 tick_histogram_sub_bucket_bits = 3;
+static constexpr u64 tick_histogram_sub_buckets     = 1 << tick_histogram_sub_bucket_bits;
+static constexpr u64 tick_histogram_bucket_count    = 64 * tick_histogram_sub_buckets;
+
+struct TickHistogram
+{
+    u64 counts[tick_histogram_bucket_count];
+    u64 total;
+    f64 max_time;
+};
+
+struct AllocationResults
+{
+    u64 total;          // During ticks only
+    u64 max_per_tick;
+    u64 allocating_ticks;
+};
+
+struct SnapshotResults
+{
+    u64 count;
+    u64 max_size;
+    f64 total_snapshot_time;
+    f64 max_snapshot_time;
+    f64 total_restore_time;
+    f64 max_restore_time;
+    bool roundtrip_ok;
+};
+
+struct RenderResults
+{
+    TickHistogram frame_times;
+    u64 max_packet_count;
+    u64 max_quad_count;
+    u64 max_texture_bind_count;
+    u64 max_batch_split_count;
+    u64 max_upload_bytes;
+    u64 last_hash;
+};
+
+struct BenchmarkResults
+{
+    TickHistogram tick_times;
+    f64 total_time;
+
+    u64 peak_counts[EntityCategory::COUNT];
+    u64 entity_histograms[EntityCategory::COUNT][entity_histogram_bucket_count];
+
+    AllocationResults allocations;
+    u64 restarts;
+    u32 final_score;
+
+    SnapshotResults snapshots;
+    RenderResults render;
+};
+
+static bool parse_options(int argc, char** argv, BenchmarkOptions& options)
+{
+    options.tick_count       = 10000;
+    options.time_step        = replay_default_time_step;
+    options.stage_number     = 1;
+    options.enemy_multiplier = 1;
+    options.seed             = 1;
+    options.bot_seed         = 0;
+    options.bot_skill        = 0.5f;
+    options.snapshot_interval = 0;
+    options.render_interval  = 0;
+    options.thread_count     = 0;
+    options.pattern_stage    = -1;
+    options.replay_path      = nullptr;
+    options.record_path      = nullptr;
+    options.commands_path    = nullptr;
+    options.frame_path       = nullptr;
+    options.software_render  = false;
+    options.output_path      = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!value)
+        {
+            print_error("Missing value for option %\n", arg);
+            return false;
+        }
+
+        if (strcmp(arg, "--ticks") == 0)
+            options.tick_count = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--dt") == 0)
+            options.time_step = strtof(value, nullptr);
+        else if (strcmp(arg, "--stage") == 0)
+            options.stage_number = (u32) strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--enemy-multiplier") == 0)
+            options.enemy_multiplier = (u32) strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--seed") == 0)
+            options.seed = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--bot-seed") == 0)
+            options.bot_seed = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--bot-skill") == 0)
+            options.bot_skill = strtof(value, nullptr);
+        else if (strcmp(arg, "--threads") == 0)
+            options.thread_count = (u32) strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--pattern-stage") == 0)
+            options.pattern_stage = strtoll(value, nullptr, 10);
+        else if (strcmp(arg, "--snapshot-interval") == 0)
+            options.snapshot_interval = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--render-interval") == 0)
+            options.render_interval = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--commands") == 0)
+            options.commands_path = value;
+        else if (strcmp(arg, "--frame") == 0)
+            options.frame_path = value;
+        else if (strcmp(arg, "--render-backend") == 0)
+        {
+            if (strcmp(value, "software") == 0)
+                options.software_render = true;
+            else if (strcmp(value, "null") != 0)
+            {
+                print_error("Unknown render backend %\n", value);
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--replay") == 0)
+            options.replay_path = value;
+        else if (strcmp(arg, "--record") == 0)
+            options.record_path = value;
+        else if (strcmp(arg, "--output") == 0)
+            options.output_path = value;
+        else
+        {
+            print_error("Unknown option %\n", arg);
+            return false;
+        }
+
+        i++;
+    }
+
+    if (options.tick_count == 0 || options.time_step <= 0.0f || options.stage_number == 0 || options.enemy_multiplier == 0)
+    {
+        print_error("Ticks, dt, stage and enemy multiplier must all be greater than 0!\n");
+        return false;
+    }
+
+    if (options.replay_path && options.record_path)
+    {
+        print_error("Can't play back and record a replay at the same time!\n");
+        return false;
+    }
+
+    if (options.bot_skill < 0.0f || options.bot_skill > 1.0f)
+    {
+        print_error("Bot skill must be between 0 and 1!\n");
+        return false;
+    }
+
+    if ((options.commands_path || options.frame_path) && options.render_interval == 0)
+    {
+        print_error("Saving the render commands or frame needs a render interval!\n");
+        return false;
+    }
+
+    if ((options.commands_path && options.software_render) || (options.frame_path && !options.software_render))
+    {
+        print_error("The commands can only be saved with the null render backend and the frame with the software one!\n");
+        return false;
+    }
+
+    if (options.bot_seed == 0)
+        options.bot_seed = options.seed;
+
+    return true;
+}
+
+static void load_game(Application& app, GameState& state)
+{
+    {   // Load Animations
+        String json = file_load_string(ref("assets/art/Spritesheet.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        animation_load_from_json(document, state.anims);
+
+        free(document);
+        free(json);
+    }
+
+    {   // Load Settings
+        String json = file_load_string(ref("assets/settings/game_settings.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        settings_load_from_json(document);
+
+        free(document);
+        free(json);
+    }
+
+    {   // Load Stage Schedule
+        String json = file_load_string(ref("assets/settings/stage_schedule.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        stage_schedule_load_from_json(document, state.stage_schedule);
+
+        free(document);
+        free(json);
+    }
+
+    {   // Load Bullet Patterns
+        String json = file_load_string(ref("assets/settings/bullet_patterns.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        bullet_patterns_load_from_json(document, state.bullet_patterns);
+
+        free(document);
+        free(json);
+    }
+
+    game_state_init(app, state);
+    game_background_init(app, state);
+
+    // Make sure the benchmark never overwrites the player's settings file with a new high score
+    state.player_settings.high_score = 0xffffffff;
+}
+
+static void start_game(Application& app, GameState& state, const BenchmarkOptions& options)
+{
+    Math::random_seed(state.rng, options.seed);
+
+    state.enemy_count_multiplier = options.enemy_multiplier;
+    game_state_reset(app, state);
+    state.current_screen = GameScreen::GAME;
+
+    if (options.stage_number > 1)
+        game_state_skip_to_stage(app, state, options.stage_number);
+}
+
+// Bucket 0 is 0, bucket i holds [2^(i-1), 2^i)
+static u64 get_power_of_2_bucket(u64 value)
+{
+    u64 bucket = 0;
+    while (value > 0)
+    {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static void tick_histogram_add(TickHistogram& histogram, f64 time)
+{
+    const u64 nanoseconds = (u64) (time * 1e9);
+
+    // The first buckets are exact, after that the top bits after the leading one pick the sub bucket
+    u64 bucket = nanoseconds;
+    if (nanoseconds >= tick_histogram_sub_buckets)
+    {
+        const u64 power = get_power_of_2_bucket(nanoseconds) - 1;
+        const u64 sub_bucket = (nanoseconds >> (power - tick_histogram_sub_bucket_bits)) & (tick_histogram_sub_buckets - 1);
+        bucket = (power - tick_histogram_sub_bucket_bits + 1) * tick_histogram_sub_buckets + sub_bucket;
+    }
+
+    histogram.counts[min(bucket, tick_histogram_bucket_count - 1)]++;
+    histogram.total++;
+    histogram.max_time = max(histogram.max_time, time);
+}
+
+// Middle of the bucket the percentile falls in, in seconds
+static f64 tick_histogram_percentile(const TickHistogram& histogram, f64 percentile)
+{
+    if (histogram.total == 0)
+        return 0.0;
+
+    const u64 rank = (u64) (percentile * (histogram.total - 1));
+
+    u64 seen = 0;
+    for (u64 bucket = 0; bucket < tick_histogram_bucket_count; bucket++)
+    {
+        seen += histogram.counts[bucket];
+        if (seen <= rank)
+            continue;
+
+        if (bucket < tick_histogram_sub_buckets)
+            return bucket * 1e-9;
+
+        const u64 power = bucket / tick_histogram_sub_buckets + tick_histogram_sub_bucket_bits - 1;
+        const u64 sub_bucket = bucket % tick_histogram_sub_buckets;
+        const u64 width = 1ull << (power - tick_histogram_sub_bucket_bits);
+        const u64 start = (tick_histogram_sub_buckets + sub_bucket) * width;
+
+        return (start + 0.5 * width) * 1e-9;
+    }
+
+    return histogram.max_time;
+}
+
+static void update_entity_counts(const GameState& state, BenchmarkResults& results)
+{
+    u64 counts[EntityCategory::COUNT];
+    counts[EntityCategory::PLAYER_BULLETS]   = state.player_bullets.positions.size;
+    counts[EntityCategory::ENEMY_BULLETS]    = state.enemy_bullets.positions.size;
+    counts[EntityCategory::PATTERN_BULLETS]  = state.pattern_bullets.count;
+    counts[EntityCategory::ENEMIES]          = state.enemies[0].positions.size + state.enemies[1].positions.size + state.enemies[2].positions.size;
+    counts[EntityCategory::KAMIKAZE_ENEMIES] = state.kamikaze_enemies.positions.size;
+    counts[EntityCategory::EXPLOSIONS]       = state.explosions.positions.size + state.power_shot_explosions.positions.size;
+    counts[EntityCategory::PICKUPS]          = state.pickups.positions.size;
+    counts[EntityCategory::PARTICLES]        = state.particles.count;
+
+    for (u64 i = 0; i < EntityCategory::COUNT; i++)
+    {
+        results.peak_counts[i] = max(results.peak_counts[i], counts[i]);
+        results.entity_histograms[i][get_power_of_2_bucket(counts[i])]++;
+    }
+}
+
+static void test_snapshot(Application& app, GameState& state, DynamicArray<u8> (&buffers)[2], SnapshotResults& results)
+{
+    const f64 snapshot_start = platform_get_time();
+    game_state_snapshot(app, state, buffers[0]);
+    const f64 snapshot_end = platform_get_time();
+
+    const bool success = game_state_restore(app, state, Bytes { buffers[0].data, buffers[0].size });
+    const f64 restore_end = platform_get_time();
+
+    game_state_snapshot(app, state, buffers[1]);
+
+    const f64 snapshot_time = snapshot_end - snapshot_start;
+    const f64 restore_time  = restore_end - snapshot_end;
+
+    results.count++;
+    results.max_size = max(results.max_size, buffers[0].size);
+    results.total_snapshot_time += snapshot_time;
+    results.max_snapshot_time = max(results.max_snapshot_time, snapshot_time);
+    results.total_restore_time += restore_time;
+    results.max_restore_time = max(results.max_restore_time, restore_time);
+
+    const bool same = (buffers[0].size == buffers[1].size) && platform_compare_memory(buffers[0].data, buffers[1].data, buffers[0].size);
+    results.roundtrip_ok = results.roundtrip_ok && success && same;
+}
+
+static void test_render(Application& app, GameState& state, const Imgui::Font& font, bool software_render, RenderResults& results)
+{
+    const f64 render_start = platform_get_time();
+
+    Imgui::begin();
+    game_state_render(app, state, font);
+    Imgui::end();
+
+    tick_histogram_add(results.frame_times, platform_get_time() - render_start);
+
+    const Imgui::FrameStats frame_stats = Imgui::get_frame_stats();
+    results.max_packet_count = max(results.max_packet_count, (u64) frame_stats.draw_call_count);
+    results.max_quad_count   = max(results.max_quad_count, (u64) frame_stats.quad_count);
+    results.max_texture_bind_count = max(results.max_texture_bind_count, (u64) frame_stats.texture_bind_count);
+    results.max_batch_split_count  = max(results.max_batch_split_count, (u64) frame_stats.batch_split_count);
+    results.max_upload_bytes       = max(results.max_upload_bytes, frame_stats.upload_bytes);
+
+    if (software_render)
+        results.last_hash = raster_hash(render_backend_software_get_rasterizer());
+    else
+        results.last_hash = render_commands_hash(render_backend_null_get_last_commands());
+
+    Imgui::update();
+}
+
+static void run_benchmark(Application& app, GameState& state, const Imgui::Font& font, const BenchmarkOptions& options, BenchmarkResults& results)
+{
+    Replay replay = {};
+
+    if (options.replay_path)
+    {
+        const bool success = replay_load_file(ref((char*) options.replay_path), replay);
+        gn_assert_with_message(success, "Couldn't load replay! (filepath: %)", options.replay_path);
+
+        replay_start_playback(app, replay, state);
+    }
+    else if (options.record_path)
+    {
+        app.time = 0.0f;
+        state.enemy_count_multiplier = options.enemy_multiplier;
+        replay_start_recording(app, replay, state, options.seed, options.time_step);
+    }
+    else
+    {
+        app.time = 0.0f;
+        start_game(app, state, options);
+    }
+
+    GameBot bot = make<GameBot>(options.bot_seed, options.bot_skill);
+
+    DynamicArray<u8> snapshot_buffers[2] = {};
+    results.snapshots.roundtrip_ok = true;
+
+    const f64 benchmark_start = platform_get_time();
+
+    for (u64 tick = 0; tick < options.tick_count; tick++)
+    {
+        const u64 allocations_start = platform_get_allocation_count();
+        const f64 tick_start = platform_get_time();
+
+        if (options.replay_path)
+        {
+            if (!replay_step(app, replay, state))
+                break;
+        }
+        else if (options.record_path)
+        {
+            // Recording stops by itself once the bot dies
+            state.input = game_bot_get_input(bot, state, options.time_step);
+            if (!replay_step(app, replay, state))
+                break;
+        }
+        else
+        {
+            // Keep stressing the simulation if the bot dies
+            if (state.current_screen & GameScreen::GAME_OVER)
+            {
+                start_game(app, state, options);
+                results.restarts++;
+            }
+
+            app.time = tick * options.time_step;
+            app.delta_time = options.time_step;
+
+            state.input = game_bot_get_input(bot, state, options.time_step);
+            game_state_simulate(app, state);
+        }
+
+        const f64 tick_end = platform_get_time();
+        tick_histogram_add(results.tick_times, tick_end - tick_start);
+
+        const u64 tick_allocations = platform_get_allocation_count() - allocations_start;
+        results.allocations.total += tick_allocations;
+        results.allocations.max_per_tick = max(results.allocations.max_per_tick, tick_allocations);
+        results.allocations.allocating_ticks += (tick_allocations > 0);
+
+        update_entity_counts(state, results);
+
+        // Not part of the tick time
+        if (options.snapshot_interval > 0 && (tick + 1) % options.snapshot_interval == 0)
+            test_snapshot(app, state, snapshot_buffers, results.snapshots);
+
+        if (options.render_interval > 0 && (tick + 1) % options.render_interval == 0)
+            test_render(app, state, font, options.software_render, results.render);
+    }
+
+    results.total_time = platform_get_time() - benchmark_start;
+    results.final_score = state.player_score;
+
+    if (options.record_path)
+        replay_save_file(ref((char*) options.record_path), replay);
+
+    if (options.commands_path)
+        render_commands_save(render_backend_null_get_last_commands(), ref((char*) options.commands_path));
+
+    if (options.frame_path)
+        raster_save_png(render_backend_software_get_rasterizer(), ref((char*) options.frame_path));
+
+    free(replay);
+    free(snapshot_buffers[0]);
+    free(snapshot_buffers[1]);
+}
+
+static void write_results(FILE* file, const BenchmarkOptions& options, const BenchmarkResults& results)
+{
+    const u64 ticks = results.tick_times.total;
+
+    const f64 p50 = tick_histogram_percentile(results.tick_times, 0.50);
+    const f64 p99 = tick_histogram_percentile(results.tick_times, 0.99);
+    const f64 ticks_per_second = (results.total_time > 0.0) ? ticks / results.total_time : 0.0;
+
+    fprintf(file, "{\n");
+    fprintf(file, "    \"input\": \"%s\",\n", options.replay_path ? "replay" : (options.record_path ? "bot_recording" : "bot"));
+    fprintf(file, "    \"ticks\": %llu,\n", ticks);
+    fprintf(file, "    \"dt\": %f,\n", options.time_step);
+    fprintf(file, "    \"stage\": %u,\n", options.stage_number);
+    fprintf(file, "    \"enemy_multiplier\": %u,\n", options.enemy_multiplier);
+    fprintf(file, "    \"seed\": %llu,\n", options.seed);
+    fprintf(file, "    \"bot_seed\": %llu,\n", options.bot_seed);
+    fprintf(file, "    \"bot_skill\": %f,\n", options.bot_skill);
+    fprintf(file, "    \"threads\": %u,\n", Jobs::get_thread_count());
+    fprintf(file, "    \"restarts\": %llu,\n", results.restarts);
+    fprintf(file, "    \"final_score\": %u,\n", results.final_score);
+    fprintf(file, "    \"total_time_s\": %f,\n", results.total_time);
+    fprintf(file, "    \"ticks_per_second\": %f,\n", ticks_per_second);
+    fprintf(file, "    \"tick_time_p50_us\": %f,\n", p50 * 1e6);
+    fprintf(file, "    \"tick_time_p99_us\": %f,\n", p99 * 1e6);
+    fprintf(file, "    \"tick_time_max_us\": %f,\n", results.tick_times.max_time * 1e6);
+    fprintf(file, "    \"allocations\": {\n");
+    fprintf(file, "        \"total\": %llu,\n", results.allocations.total);
+    fprintf(file, "        \"max_per_tick\": %llu,\n", results.allocations.max_per_tick);
+    fprintf(file, "        \"allocating_ticks\": %llu\n", results.allocations.allocating_ticks);
+    fprintf(file, "    },\n");
+    if (results.snapshots.count > 0)
+    {
+        const SnapshotResults& snapshots = results.snapshots;
+
+        fprintf(file, "    \"snapshots\": {\n");
+        fprintf(file, "        \"count\": %llu,\n", snapshots.count);
+        fprintf(file, "        \"max_size_bytes\": %llu,\n", snapshots.max_size);
+        fprintf(file, "        \"snapshot_time_avg_us\": %f,\n", snapshots.total_snapshot_time / snapshots.count * 1e6);
+        fprintf(file, "        \"snapshot_time_max_us\": %f,\n", snapshots.max_snapshot_time * 1e6);
+        fprintf(file, "        \"restore_time_avg_us\": %f,\n", snapshots.total_restore_time / snapshots.count * 1e6);
+        fprintf(file, "        \"restore_time_max_us\": %f,\n", snapshots.max_restore_time * 1e6);
+        fprintf(file, "        \"roundtrip_ok\": %s\n", snapshots.roundtrip_ok ? "true" : "false");
+        fprintf(file, "    },\n");
+    }
+    if (results.render.frame_times.total > 0)
+    {
+        const RenderResults& render = results.render;
+
+        fprintf(file, "    \"render\": {\n");
+        fprintf(file, "        \"backend\": \"%s\",\n", options.software_render ? "software" : "null");
+        fprintf(file, "        \"frames\": %llu,\n", render.frame_times.total);
+        fprintf(file, "        \"frame_time_p50_us\": %f,\n", tick_histogram_percentile(render.frame_times, 0.50) * 1e6);
+        fprintf(file, "        \"frame_time_p99_us\": %f,\n", tick_histogram_percentile(render.frame_times, 0.99) * 1e6);
+        fprintf(file, "        \"frame_time_max_us\": %f,\n", render.frame_times.max_time * 1e6);
+        fprintf(file, "        \"max_packets\": %llu,\n", render.max_packet_count);
+        fprintf(file, "        \"max_quads\": %llu,\n", render.max_quad_count);
+        fprintf(file, "        \"max_texture_binds\": %llu,\n", render.max_texture_bind_count);
+        fprintf(file, "        \"max_batch_splits\": %llu,\n", render.max_batch_split_count);
+        fprintf(file, "        \"max_upload_bytes\": %llu,\n", render.max_upload_bytes);
+        fprintf(file, "        \"last_frame_hash\": \"%016llx\"\n", render.last_hash);
+        fprintf(file, "    },\n");
+    }
+
+    fprintf(file, "    \"peak_entities\": {\n");
+    for (u64 i = 0; i < EntityCategory::COUNT; i++)
+        fprintf(file, "        \"%s\": %llu%s\n", entity_category_names[i], results.peak_counts[i], (i + 1 < EntityCategory::COUNT) ? "," : "");
+    fprintf(file, "    },\n");
+
+    // Trailing empty buckets are left out
+    fprintf(file, "    \"entity_histograms\": {\n");
+    for (u64 i = 0; i < EntityCategory::COUNT; i++)
+    {
+        const u64* histogram = results.entity_histograms[i];
+
+        u64 bucket_count = entity_histogram_bucket_count;
+        while (bucket_count > 1 && histogram[bucket_count - 1] == 0)
+            bucket_count--;
+
+        fprintf(file, "        \"%s\": [", entity_category_names[i]);
+        for (u64 bucket = 0; bucket < bucket_count; bucket++)
+            fprintf(file, "%s%llu", (bucket > 0) ? ", " : "", histogram[bucket]);
+        fprintf(file, "]%s\n", (i + 1 < EntityCategory::COUNT) ? "," : "");
+    }
+    fprintf(file, "    }\n");
+    fprintf(file, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    platform_init_clock();
+    srand((u32) options.seed);
+
+    Application app = {};
+
+    {   // Same virtual window as the game so the playground has the same size
+        constexpr f32 aspect_ratio = 224.0f / 256.0f;
+        app.window.height = 900;
+        app.window.width  = aspect_ratio * app.window.height;
+
+        app.window.ref_height = 720;
+        app.window.ref_width  = aspect_ratio * app.window.ref_height;
+
+        app.window.style = WindowStyle::WINDOWED;
+    }
+
+    application_set_active(app);
+
+    GameState* state = (GameState*) platform_allocate(sizeof(GameState));
+    *state = GameState {};
+
+    load_game(app, *state);
+
+    // Only rendering needs the ui, neither backend uses the GPU
+    Imgui::Font font = {};
+    SpriteAtlas atlas = {};
+    if (options.render_interval > 0)
+    {
+        if (options.software_render)
+        {
+            render_backend_software_set_target((u32) app.window.width, (u32) app.window.height, app.clear_color);
+            Imgui::init(app, render_backend_software());
+        }
+        else
+            Imgui::init(app, render_backend_null());
+
+        String content = file_load_string(ref("assets/fonts/gamer.font.json"));
+
+        Json::Document document = {};
+        Json::parse_string(content, document);
+
+        font = Imgui::font_load_from_json(document, ref("assets/fonts/gamer.font.png"));
+
+        free(document);
+        free(content);
+
+        // Same pages as the game
+        atlas = make<SpriteAtlas>();
+
+        Texture font_texture = font.atlas;
+        Texture sheet        = state->anims[0].sprites[0].atlas;
+
+        Imgui::add_to_atlas(atlas);
+        sprite_atlas_add_texture(atlas, font.atlas);
+        sprite_atlas_add_animations(atlas, state->anims);
+
+        sprite_atlas_pack(atlas, ref((char*) sprite_atlas_cache_path));
+
+        Imgui::move_to_atlas(atlas);
+        Imgui::font_move_to_atlas(font, atlas);
+        sprite_atlas_remap_animations(atlas, state->anims);
+
+        sprite_atlas_free_source(atlas, font_texture);
+        sprite_atlas_free_source(atlas, sheet);
+
+        // Stars were built from the unpacked sprite sheet in load_game
+        game_background_upload(*state);
+    }
+
+    if (options.pattern_stage >= 0)
+        state->bullet_patterns.start_stage = (u32) options.pattern_stage;
+
+    // 1 thread means no workers at all, everything runs inline on this thread
+    if (options.thread_count != 1)
+        Jobs::init(options.thread_count > 1 ? options.thread_count - 1 : 0);
+
+    BenchmarkResults results = {};
+    run_benchmark(app, *state, font, options, results);
+
+    FILE* file = options.output_path ? fopen(options.output_path, "w") : stdout;
+    gn_assert_with_message(file, "Couldn't open output file! (filepath: %)", options.output_path);
+
+    write_results(file, options, results);
+
+    if (file != stdout)
+        fclose(file);
+
+    Jobs::shutdown();
+
+    if (options.render_interval > 0)
+    {
+        free(font);
+        free(atlas);
+        Imgui::shutdown();
+    }
+
+    return 0;
+}
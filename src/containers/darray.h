@@ -98,11 +98,19 @@ inline void resize(DynamicArray<T>& arr, u64 new_capacity)
     arr.data = new_data;
 }
 
+// Grows the array to at least min_capacity, never shrinks it
+template <typename T>
+inline void reserve(DynamicArray<T>& arr, u64 min_capacity)
+{
+    if (arr.capacity < min_capacity)
+        resize(arr, min_capacity);
+}
+
 template <typename T>
 inline DynamicArray<T>& append(DynamicArray<T>& arr, const T& elem)
 {
     if (arr.size >= arr.capacity)
-        resize(arr, max(2 * arr.capacity, 16ui64));
+        resize(arr, max(2 * arr.capacity, 16ull));
     
     arr.data[arr.size++] = elem;
     return arr;
@@ -126,7 +134,7 @@ inline DynamicArray<T>& insert(DynamicArray<T>& arr, u64 index, const T& elem)
     gn_assert_with_message(index < arr.size,  "Trying to insert at an out of bounds index! (index: %, array size: %)", index, arr.size);
 
     if (arr.size >= arr.capacity)
-        resize(arr, max(2 * arr.capacity, 16ui64));
+        resize(arr, max(2 * arr.capacity, 16ull));
 
     // Move all values ahead by 1 index    
     for (u64 i = arr.size; i > index; i--)
@@ -198,6 +206,16 @@ inline void shuffle(DynamicArray<T>& arr)
     }
 }
 
+template <typename T>
+inline void shuffle(DynamicArray<T>& arr, Math::Random& rng)
+{
+    for (u64 i = 0; i < arr.size; i++)
+    {
+        u64 swap_with_index = (u64) Math::floor(arr.size * Math::random(rng));
+        swap(arr[i], arr[swap_with_index]);
+    }
+}
+
 template <template <typename> typename ArrayType, typename T>
 void print_to_file(FILE* file, const ArrayType<T>& array)
 {
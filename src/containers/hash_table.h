@@ -40,7 +40,7 @@ struct HashTableElement
     inline operator bool() const
     {
         using HashTable = HashTable<KeyType, ValueType, Hasher>;
-        using State     = HashTable::State;
+        using State     = typename HashTable::State;
 
         gn_assert_with_message(table, "Element doesn't point to a valid hash table!");
         return index < table->capacity && table->states[index] == State::ALIVE;
@@ -50,7 +50,7 @@ struct HashTableElement
     inline KeyType& key() const
     {
         using HashTable = HashTable<KeyType, ValueType, Hasher>;
-        using State     = HashTable::State;
+        using State     = typename HashTable::State;
 
         gn_assert_with_message(table, "Element doesn't point to a valid hash table!");
         gn_assert_with_message(index < table->capacity, "Element not valid!");
@@ -61,7 +61,7 @@ struct HashTableElement
     inline ValueType& value() const
     {
         using HashTable = HashTable<KeyType, ValueType, Hasher>;
-        using State     = HashTable::State;
+        using State     = typename HashTable::State;
 
         gn_assert_with_message(table, "Element doesn't point to a valid hash table!");
         gn_assert_with_message(index < table->capacity, "Element not valid!");
@@ -74,11 +74,11 @@ HASH_TABLE_TEMPLATE
 inline HashTable<KeyType, ValueType, Hasher> make(Type<HashTable<KeyType, ValueType, Hasher>>, u32 start_cap = 32)
 {
     using HashTable = HashTable<KeyType, ValueType, Hasher>;
-    using State     = HashTable::State;
+    using State     = typename HashTable::State;
 
     HashTable table;
 
-    table.capacity = max(start_cap, 2Ui32);
+    table.capacity = max(start_cap, 2u);
     table.filled   = 0;
     
     const u64 size_in_bytes = table.capacity * (sizeof(State) + sizeof(Hash) + sizeof(KeyType) + sizeof(ValueType));
@@ -99,7 +99,7 @@ HASH_TABLE_TEMPLATE
 inline HashTable<KeyType, ValueType, Hasher> copy(const HashTable<KeyType, ValueType, Hasher>& other)
 {
     using HashTable = HashTable<KeyType, ValueType, Hasher>;
-    using State     = HashTable::State;
+    using State     = typename HashTable::State;
 
     HashTable table;
 
@@ -203,7 +203,7 @@ void resize(HashTable<KeyType, ValueType, Hasher>& table, u32 new_capacity)
     gn_assert_with_message(new_capacity > table.capacity, "Table can't be resized to be smaller than before! (new_capacity: %, old_capacity: %)", new_capacity, table.capacity);
 
     using HashTable = HashTable<KeyType, ValueType, Hasher>;
-    using State     = HashTable::State;
+    using State     = typename HashTable::State;
 
     HashTable new_table;
     new_table.capacity = new_capacity;
@@ -258,7 +258,7 @@ HashTableElement<KeyType, ValueType, Hasher> find(const HashTable<KeyType, Value
 {
     using HashTable        = HashTable<KeyType, ValueType, Hasher>;
     using HashTableElement = HashTableElement<KeyType, ValueType, Hasher>;
-    using State            = HashTable::State;
+    using State            = typename HashTable::State;
 
     const Hash hash = table.hasher(key);
     const u32 end_index   = hash % table.capacity;
@@ -291,7 +291,7 @@ HashTableElement<KeyType, ValueType, Hasher> put(HashTable<KeyType, ValueType, H
 {
     using HashTable        = HashTable<KeyType, ValueType, Hasher>;
     using HashTableElement = HashTableElement<KeyType, ValueType, Hasher>;
-    using State            = HashTable::State;
+    using State            = typename HashTable::State;
 
     const float load = (float) table.filled / (float) table.capacity;
     if (load >= HASH_TABLE_MAX_LOAD_FACTOR)
@@ -338,7 +338,7 @@ inline void remove(HashTableElement<KeyType, ValueType, Hasher>& element)
 {
     using HashTable        = HashTable<KeyType, ValueType, Hasher>;
     using HashTableElement = HashTableElement<KeyType, ValueType, Hasher>;
-    using State            = HashTable::State;
+    using State            = typename HashTable::State;
 
     HashTable& table = *(HashTable*)element.table;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -116,7 +117,7 @@ inline void reverse(String& str)
     }
 }
 
-inline String get_substring(String src, u64 start = 0Ui64, u64 length = _UI64_MAX)
+inline String get_substring(String src, u64 start = 0ull, u64 length = UINT64_MAX)
 {
     String str;
 
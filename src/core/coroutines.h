@@ -8,7 +8,7 @@
 
 #define COROUTINE_NESTING_LIMIT 8
 #define COROUTINE_CALL_OFFSET   1024 * 1024
-#define COROUTINE_STACK_SIZE    512ui64
+#define COROUTINE_STACK_SIZE    512ull
 
 struct Coroutine
 {
@@ -34,6 +34,7 @@ struct Coroutine
 #define coroutine_yield(co) do { co.line[co.depth] = __LINE__; co.running = true; goto _co_end; case __LINE__:; } while (false)
 #define coroutine_wait_until(co, cond) while (!(cond)) { coroutine_yield(co); }
 #define coroutine_wait_seconds(co, seconds) do { co.prev_time = platform_get_time(); coroutine_wait_until(co, (platform_get_time() - co.prev_time) >= seconds); } while (false)
+#define coroutine_wait_seconds_at(co, seconds, time) do { co.prev_time = (time); coroutine_wait_until(co, ((time) - co.prev_time) >= seconds); } while (false)   // Waits on the given clock instead of the platform one
 
 #define coroutine_call(co, ...) do { gn_assert_with_message(co.depth + 1 < COROUTINE_NESTING_LIMIT, "Exceeded coroutine nesting limit! (max depth: %)", COROUTINE_NESTING_LIMIT); co.line[co.depth] = __LINE__; co.running = false; case __LINE__: co.depth++; __VA_ARGS__; co.depth--; if (co.running) { goto _co_end; } co.line[co.depth] = __LINE__ + COROUTINE_CALL_OFFSET; co.line[co.depth + 1] = 0; case __LINE__ + COROUTINE_CALL_OFFSET:; } while (false)
 
@@ -5,6 +5,7 @@
 #include "application/application.h"
 #include "graphics/graphics.h"
 #include "core/input_processing.h"
+#include "core/jobs.h"
 #include "platform/platform.h"
 #include "engine/imgui.h"
 #include "audio/audio.h"
@@ -51,8 +52,9 @@ int main()
 
     srand((u32) platform_get_time_absolute());
 
-    Imgui::init(app);
+    Imgui::init(app, render_backend_opengl());
     Audio::init();
+    Jobs::init();
 
     // In case on_init needs time for some reason
     app.time = platform_get_time();
@@ -83,6 +85,7 @@ int main()
 
     app.on_shutdown(app);
 
+    Jobs::shutdown();
     Audio::shutdown();
     Imgui::shutdown();
 
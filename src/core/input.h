@@ -153,20 +153,20 @@ using MouseScrollCallback = Function<void(Application&, s32)>;
 namespace Input
 {
 
-extern inline bool get_key(Key key);
-extern inline bool get_key_down(Key key);
-extern inline bool get_key_up(Key key);
+extern bool get_key(Key key);
+extern bool get_key_down(Key key);
+extern bool get_key_up(Key key);
 
-extern inline bool get_mouse_button(MouseButton button);
-extern inline bool get_mouse_button_down(MouseButton button);
-extern inline bool get_mouse_button_up(MouseButton button);
+extern bool get_mouse_button(MouseButton button);
+extern bool get_mouse_button_down(MouseButton button);
+extern bool get_mouse_button_up(MouseButton button);
 
-extern inline Vector2 mouse_position(); 
-extern inline Vector2 mouse_delta_position(); 
+extern Vector2 mouse_position(); 
+extern Vector2 mouse_delta_position(); 
 
-extern inline void register_key_down_event_callback(KeyDownCallback callback);
-extern inline void register_mouse_scroll_event_callback(MouseScrollCallback callback);
+extern void register_key_down_event_callback(KeyDownCallback callback);
+extern void register_mouse_scroll_event_callback(MouseScrollCallback callback);
 
-extern inline void center_mouse(bool value);
+extern void center_mouse(bool value);
 
 } // namespace Input
\ No newline at end of file
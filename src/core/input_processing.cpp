@@ -106,41 +106,41 @@ inline void input_process_mouse_wheel(s32 z)
 namespace Input
 {
 
-inline bool get_key(Key key)
+bool get_key(Key key)
 {
     return current_input_state.keyboard_state.keys[(int) key];
 }
 
-inline bool get_key_down(Key key)
+bool get_key_down(Key key)
 {
     return current_input_state.keyboard_state.keys[(int) key] &&
            !previous_input_state.keyboard_state.keys[(int) key];
 }
 
-inline bool get_key_up(Key key)
+bool get_key_up(Key key)
 {
     return !current_input_state.keyboard_state.keys[(int) key] &&
            previous_input_state.keyboard_state.keys[(int) key];
 }
 
-inline bool get_mouse_button(MouseButton button)
+bool get_mouse_button(MouseButton button)
 {
     return current_input_state.mouse_state.buttons[(int) button];
 }
 
-inline bool get_mouse_button_down(MouseButton button)
+bool get_mouse_button_down(MouseButton button)
 {
     return current_input_state.mouse_state.buttons[(int) button] &&
            !previous_input_state.mouse_state.buttons[(int) button];
 }
 
-inline bool get_mouse_button_up(MouseButton button)
+bool get_mouse_button_up(MouseButton button)
 {
     return !current_input_state.mouse_state.buttons[(int) button] &&
            previous_input_state.mouse_state.buttons[(int) button];
 }
 
-inline Vector2 mouse_position()
+Vector2 mouse_position()
 {
     return Vector2(
         current_input_state.mouse_state.x,
@@ -148,24 +148,24 @@ inline Vector2 mouse_position()
     );
 }
 
-inline Vector2 mouse_delta_position()
+Vector2 mouse_delta_position()
 {
     s32 del_x = current_input_state.mouse_state.x - previous_input_state.mouse_state.x;
     s32 del_y = current_input_state.mouse_state.y - previous_input_state.mouse_state.y;
     return Vector2(del_x, del_y);
 }
 
-inline void register_key_down_event_callback(KeyDownCallback callback)
+void register_key_down_event_callback(KeyDownCallback callback)
 {
     append(input_events.key_down_callbacks, callback);
 }
 
-inline void register_mouse_scroll_event_callback(MouseScrollCallback callback)
+void register_mouse_scroll_event_callback(MouseScrollCallback callback)
 {
     append(input_events.mouse_scroll_callbacks, callback);
 }
 
-inline void center_mouse(bool value)
+void center_mouse(bool value)
 {
     current_input_state.mouse_state.center_cursor = value;
 }
@@ -0,0 +1,272 @@
+#include "jobs.h"
+
+#include <atomic>
+
+#include "types.h"
+#include "logger.h"
+#include "math/common.h"
+#include "platform/platform.h"
+
+namespace Jobs
+{
+
+static constexpr u32 max_worker_count = 63;
+static constexpr u64 queue_capacity   = 256;    // Power of 2
+
+// The owner pushes and pops at the tail, thieves take from the head
+// Jobs are tiny and short lived so a spin lock is cheaper than anything fancier
+struct alignas(64) WorkQueue
+{
+    std::atomic_flag lock;
+
+    Job jobs[queue_capacity];
+    u64 head;
+    u64 tail;
+};
+
+struct JobSystem
+{
+    // Queue 0 belongs to the thread that called init (and anyone else that isn't a worker)
+    WorkQueue queues[max_worker_count + 1];
+    PlatformThread workers[max_worker_count];
+    u32 worker_count;
+
+    // Sleeping workers wait on this, every queued job signals it once
+    PlatformSemaphore job_semaphore;
+    std::atomic<bool> running;
+};
+
+static JobSystem* job_system = nullptr;
+static thread_local u32 queue_index = 0;
+
+static inline void queue_lock(WorkQueue& queue)
+{
+    while (queue.lock.test_and_set(std::memory_order_acquire))
+        ;
+}
+
+static inline void queue_unlock(WorkQueue& queue)
+{
+    queue.lock.clear(std::memory_order_release);
+}
+
+static bool queue_push(WorkQueue& queue, const Job& job)
+{
+    queue_lock(queue);
+
+    const bool has_space = (queue.tail - queue.head) < queue_capacity;
+    if (has_space)
+    {
+        queue.jobs[queue.tail & (queue_capacity - 1)] = job;
+        queue.tail++;
+    }
+
+    queue_unlock(queue);
+    return has_space;
+}
+
+static bool queue_pop(WorkQueue& queue, Job& out_job)
+{
+    queue_lock(queue);
+
+    const bool has_job = queue.tail > queue.head;
+    if (has_job)
+    {
+        queue.tail--;
+        out_job = queue.jobs[queue.tail & (queue_capacity - 1)];
+    }
+
+    queue_unlock(queue);
+    return has_job;
+}
+
+static bool queue_steal(WorkQueue& queue, Job& out_job)
+{
+    queue_lock(queue);
+
+    const bool has_job = queue.tail > queue.head;
+    if (has_job)
+    {
+        out_job = queue.jobs[queue.head & (queue_capacity - 1)];
+        queue.head++;
+    }
+
+    queue_unlock(queue);
+    return has_job;
+}
+
+static inline void execute(const Job& job)
+{
+    job.proc(job.data, job.start, job.end);
+    job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Own queue first (newest job, still hot in the cache) and then the oldest job of everyone else
+static bool find_job(Job& out_job)
+{
+    const u32 queue_count = job_system->worker_count + 1;
+
+    if (queue_pop(job_system->queues[queue_index], out_job))
+        return true;
+
+    for (u32 i = 1; i < queue_count; i++)
+    {
+        const u32 victim = (queue_index + i) % queue_count;
+        if (queue_steal(job_system->queues[victim], out_job))
+            return true;
+    }
+
+    return false;
+}
+
+static void worker_main(void* data)
+{
+    queue_index = (u32) (u64) data;
+
+    while (true)
+    {
+        Job job;
+        if (find_job(job))
+        {
+            execute(job);
+            continue;
+        }
+
+        if (!job_system->running.load(std::memory_order_acquire))
+            break;
+
+        platform_semaphore_wait(job_system->job_semaphore);
+    }
+}
+
+void init(u32 worker_count)
+{
+    gn_assert_with_message(job_system == nullptr, "Job system is already initialized!");
+
+    if (worker_count == 0)
+        worker_count = platform_get_processor_count() - 1;
+
+    worker_count = min(worker_count, max_worker_count);
+
+    job_system = (JobSystem*) platform_allocate(sizeof(JobSystem));
+    platform_zero_memory(job_system, sizeof(JobSystem));
+
+    for (u32 i = 0; i <= max_worker_count; i++)
+        job_system->queues[i].lock.clear();
+
+    const bool success = platform_semaphore_create(job_system->job_semaphore, 0);
+    gn_assert_with_message(success, "Couldn't create the job semaphore!");
+
+    job_system->running = true;
+    queue_index = 0;
+
+    // Set before any worker starts since they all read it
+    job_system->worker_count = worker_count;
+
+    for (u32 i = 0; i < worker_count; i++)
+    {
+        const bool started = platform_thread_start(job_system->workers[i], worker_main, (void*) (u64) (i + 1));
+        gn_assert_with_message(started, "Couldn't start worker thread! (worker index: %)", i);
+    }
+}
+
+void shutdown()
+{
+    if (!job_system)
+        return;
+
+    job_system->running = false;
+    platform_semaphore_signal(job_system->job_semaphore, job_system->worker_count);
+
+    for (u32 i = 0; i < job_system->worker_count; i++)
+        platform_thread_join(job_system->workers[i]);
+
+    platform_semaphore_destroy(job_system->job_semaphore);
+
+    platform_free(job_system);
+    job_system = nullptr;
+}
+
+u32 get_thread_count()
+{
+    return job_system ? job_system->worker_count + 1 : 1;
+}
+
+void run(const Job& job)
+{
+    job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (get_thread_count() <= 1 || !queue_push(job_system->queues[queue_index], job))
+    {
+        // No workers or the queue is full, doing it right away is still correct
+        execute(job);
+        return;
+    }
+
+    platform_semaphore_signal(job_system->job_semaphore);
+}
+
+void wait(Counter& counter)
+{
+    while (counter.pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+        if (find_job(job))
+            execute(job);
+        else
+            platform_thread_yield();
+    }
+}
+
+static inline bool phases_conflict(u64 reads_a, u64 writes_a, u64 reads_b, u64 writes_b)
+{
+    return (writes_a & (reads_b | writes_b)) || (writes_b & reads_a);
+}
+
+static void run_phase_job(void* data, u64, u64)
+{
+    const Phase& phase = *(const Phase*) data;
+    phase.proc(phase.data);
+}
+
+void run_phases(const Phase* phases, u64 count)
+{
+    u64 first = 0;
+    while (first < count)
+    {
+        // Grow the batch until the next phase conflicts with any phase in it
+        u64 reads = phases[first].reads;
+        u64 writes = phases[first].writes;
+        u64 work = phases[first].work;
+
+        u64 last = first + 1;
+        while (last < count && !phases_conflict(reads, writes, phases[last].reads, phases[last].writes))
+        {
+            reads |= phases[last].reads;
+            writes |= phases[last].writes;
+            work += phases[last].work;
+            last++;
+        }
+
+        if (last - first == 1 || get_thread_count() <= 1 || work < min_parallel_work)
+        {
+            for (u64 i = first; i < last; i++)
+                phases[i].proc(phases[i].data);
+        }
+        else
+        {
+            Counter counter;
+            counter.pending = 0;
+
+            for (u64 i = first + 1; i < last; i++)
+                run(Job { run_phase_job, (void*) &phases[i], 0, 1, &counter });
+
+            phases[first].proc(phases[first].data);
+            wait(counter);
+        }
+
+        first = last;
+    }
+}
+
+} // namespace Jobs
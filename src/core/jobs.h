@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+
+#include "types.h"
+#include "math/common.h"
+
+// Work stealing job system
+// A fixed pool of worker threads, each with its own queue. Threads pop their own newest jobs first
+// and steal the oldest jobs of other queues when they run out. The thread that calls init is
+// counted as a worker too and helps out while waiting on a counter.
+//
+// Without init (or with 0 workers) everything runs inline on the calling thread.
+
+namespace Jobs
+{
+
+typedef void (*JobProc)(void* data, u64 start, u64 end);
+
+// Every job decrements its counter when it's done, waiting on it joins all of them
+struct Counter
+{
+    std::atomic<u64> pending;
+};
+
+struct Job
+{
+    JobProc proc;
+    void* data;
+    u64 start;
+    u64 end;
+    Counter* counter;
+};
+
+// A worker count of 0 uses one worker per processor (minus the calling thread)
+void init(u32 worker_count = 0);
+void shutdown();
+
+// Worker threads plus the thread that called init
+u32 get_thread_count();
+
+void run(const Job& job);
+
+// Runs other jobs until the counter reaches zero
+void wait(Counter& counter);
+
+// Splits [0, count) into batches of at least min_batch_size and calls func(start, end) for each of them
+// The calling thread runs the first batch itself, small ranges never leave the calling thread
+template <typename Func>
+void parallel_for(u64 count, u64 min_batch_size, const Func& func)
+{
+    if (count == 0)
+        return;
+
+    const u64 thread_count = get_thread_count();
+    if (thread_count <= 1 || count <= min_batch_size)
+    {
+        func((u64) 0, count);
+        return;
+    }
+
+    // A few batches per thread so stealing can even out uneven work
+    const u64 batch_count = 4 * thread_count;
+    const u64 batch_size  = max(min_batch_size, (count + batch_count - 1) / batch_count);
+
+    const JobProc proc = [](void* data, u64 start, u64 end) { (*(const Func*) data)(start, end); };
+
+    Counter counter;
+    counter.pending = 0;
+
+    for (u64 start = batch_size; start < count; start += batch_size)
+        run(Job { proc, (void*) &func, start, min(start + batch_size, count), &counter });
+
+    func((u64) 0, batch_size);
+    wait(counter);
+}
+
+// A piece of work with the data it reads and writes, one bit per piece of data (the meaning is up to the caller)
+struct Phase
+{
+    const char* name;
+    u64 reads;
+    u64 writes;
+
+    // Roughly how many items the phase touches, batches smaller than min_parallel_work stay on the calling thread
+    u64 work;
+
+    void (*proc)(void* data);
+    void* data;
+};
+
+constexpr u64 min_parallel_work = 1024;
+
+// Runs the phases in the given order. Consecutive phases that don't write anything the others
+// read or write run at the same time, so the result is the same as running them one by one.
+void run_phases(const Phase* phases, u64 count);
+
+} // namespace Jobs
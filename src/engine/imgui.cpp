@@ -9,15 +9,13 @@
 #include "containers/darray.h"
 #include "containers/hash_table.h"
 #include "graphics/texture.h"
-#include "graphics/shader.h"
 #include "math/math.h"
 #include "serialization/json/json_document.h"
 #include "serialization/binary.h"
-#include "batch.h"
 #include "rect.h"
-#include "shader_paths.h"
-
-#include <glad/glad.h>
+#include "render_backend.h"
+#include "render_commands.h"
+#include "sprite_atlas.h"
 
 #define imgui_invalid_id (ID { -1, -1 })
 
@@ -26,22 +24,8 @@ namespace Imgui
 
 static const Application* active_app = nullptr;
 
-static constexpr s32 max_quad_count = 500;
-static constexpr s32 max_tex_count  = 10;
-static s32 active_tex_slots[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
-
 static constexpr f32 z_offset = -0.0000001f;
 
-struct Vertex
-{
-    Vector3 position;
-    Vector2 tex_coord;
-    Vector4 color;
-    float tex_index;
-};
-
-using ImguiBatchData = BatchData<Vertex, max_tex_count>;
-
 struct UIStateData
 {
     ID hot, active;
@@ -50,24 +34,58 @@ struct UIStateData
 
 static struct
 {
-    u32 vao, vbo, ibo;
-    ImguiBatchData quad_batch;
-    ImguiBatchData font_batch;
+    // Everything pushed this frame, sorted and submitted to the backend at end()
+    RenderCommandBuffer commands;
+    RenderBackend backend;
 
     Texture white_texture;
 
+    // What rects are drawn with, the white texture or its spot in a sprite atlas page
+    Texture rect_texture;
+    Vector4 rect_tex_coords;
+
     UIStateData state_prev_frame;
     UIStateData state_current_frame;
 
     Vector4 offset_v2;  // x,z and y,w are the same
     Vector4 scale_v2;   // x,z and y,w are the same
 
-    Vertex* batch_shared_buffer = nullptr;
-
     DynamicArray<Callback> button_callbacks;
-    bool batch_begun = false;
+    bool frame_begun = false;
+
+    RetainedSection* recording;     // Widgets drawn while it's set are added to it
+
+    FrameStats frame_stats;
 } ui_data;
 
+// Laid out text, kept between frames so strings drawn every frame are only laid out once
+// A run is found by a hash of the text, the font, the size and what a ui unit is in clip space. It's set
+// associative, a new run takes the place of the least recently used one in its set.
+static constexpr u32 text_cache_set_count = 32;
+static constexpr u32 text_cache_way_count = 8;
+
+struct TextRun
+{
+    u64 key;
+    u64 last_used;      // Lookup count it was last used at, 0 if it was never filled
+
+    DynamicArray<char> text;
+
+    // Finished instances relative to the top left corner of the text (in clip space) and to its z, the color
+    // and the position are filled in when it's drawn
+    DynamicArray<RenderInstance> glyphs;
+    Vector2 size;       // What get_rendered_text_size returns
+};
+
+static struct
+{
+    TextRun runs[text_cache_set_count * text_cache_way_count];
+    u64 lookup_count;
+} text_cache;
+
+// Fonts get a new one whenever their glyphs change, so runs made from the old glyphs aren't found anymore
+static u32 next_font_id = 1;
+
 static void init_white_texture(int width, int height)
 {
     // Use existing white texture if available
@@ -84,105 +102,39 @@ static void init_white_texture(int width, int height)
     platform_free(pixels);
 }
 
-static void init_batches()
-{
-    // Set up batching for elems
-    constexpr size_t batch_size = 4 * max_quad_count;
-    ui_data.batch_shared_buffer = (Vertex*) platform_allocate(2 * batch_size * sizeof(Vertex));
-
-    {   // Init Quad Batch
-        ui_data.quad_batch.elem_vertices_buffer = ui_data.batch_shared_buffer;
-
-        // Compile Shaders
-        gn_assert_with_message(
-            shader_compile_from_file(ui_data.quad_batch.shader, ref(ui_quad_vert_shader_path), Shader::Type::VERTEX),
-            "Failed to compile UI Quad Vertex Shader! (shader path: %)", ui_quad_vert_shader_path
-        );
-
-        gn_assert_with_message(
-            shader_compile_from_file(ui_data.quad_batch.shader, ref(ui_quad_frag_shader_path), Shader::Type::FRAGMENT),
-            "Failed to compile UI Quad Fragment Shader! (shader path: %)", ui_quad_frag_shader_path
-        );
-
-        gn_assert_with_message(
-            shader_link(ui_data.quad_batch.shader),
-            "Failed to link UI Quad Shader!"
-        );
-    }
-    
-    {   // Init Font Batch
-        ui_data.font_batch.elem_vertices_buffer = ui_data.batch_shared_buffer + batch_size;
-
-        // Compile Shaders
-        gn_assert_with_message(
-            shader_compile_from_file(ui_data.font_batch.shader, ref(ui_font_vert_shader_path), Shader::Type::VERTEX),
-            "Failed to compile UI Font Vertex Shader! (shader path: %)", ui_font_vert_shader_path
-        );
-
-        gn_assert_with_message(
-            shader_compile_from_file(ui_data.font_batch.shader, ref(ui_font_frag_shader_path), Shader::Type::FRAGMENT),
-            "Failed to compile UI Font Fragment Shader! (shader path: %)", ui_font_frag_shader_path
-        );
-
-        gn_assert_with_message(
-            shader_link(ui_data.font_batch.shader),
-            "Failed to link UI Font Shader!"
-        );
-    }
-}
-
-void init(const Application& app)
+void init(const Application& app, const RenderBackend& backend)
 {
     // Set currentlt active application
     gn_assert_with_message(active_app == nullptr, "Imgui was already initialized!");
     active_app = &app;
 
-    glGenBuffers(1, &ui_data.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, ui_data.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * max_quad_count * 4, nullptr, GL_DYNAMIC_DRAW);
-
-    glGenVertexArrays(1, &ui_data.vao);
-    glBindVertexArray(ui_data.vao);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), (const void*) offsetof(Vertex, position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(Vertex), (const void*) offsetof(Vertex, tex_coord));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 4, GL_FLOAT, false, sizeof(Vertex), (const void*) offsetof(Vertex, color));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, false, sizeof(Vertex), (const void*) offsetof(Vertex, tex_index));
-
-    u32 indices[max_quad_count * 6];
-    u32 offset = 0;
-    for (int i = 0; i < max_quad_count * 6; i += 6)
-    {
-        indices[i + 0] = offset + 0;
-        indices[i + 1] = offset + 1;
-        indices[i + 2] = offset + 2;
-        indices[i + 3] = offset + 2;
-        indices[i + 4] = offset + 3;
-        indices[i + 5] = offset + 0;
-        offset += 4;
-    }
+    ui_data.backend = backend;
+    ui_data.backend.init();
 
-    glGenBuffers(1, &ui_data.ibo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ui_data.ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    ui_data.commands = make<RenderCommandBuffer>();
 
     ui_data.state_current_frame.hot = ui_data.state_current_frame.active = ui_data.state_current_frame.interacted = imgui_invalid_id;
     ui_data.state_prev_frame.hot = ui_data.state_prev_frame.active = ui_data.state_prev_frame.interacted = imgui_invalid_id;
 
-    init_batches();
-
     init_white_texture(4, 4);
+    ui_data.rect_texture    = ui_data.white_texture;
+    ui_data.rect_tex_coords = Vector4 { 0.0f, 0.0f, 1.0f, 1.0f };
 
-    ui_data.batch_begun = false;
+    ui_data.frame_begun = false;
 
     ui_data.offset_v2 = Vector4(0.0f);
     ui_data.scale_v2  = Vector4(1.0f);
 
     ui_data.button_callbacks = make<DynamicArray<Callback>>();
+
+    for (TextRun& run : text_cache.runs)
+    {
+        run = {};
+        run.text   = make<DynamicArray<char>>(32ull);
+        run.glyphs = make<DynamicArray<RenderInstance>>(32ull);
+    }
+
+    text_cache.lookup_count = 0;
 }
 
 void shutdown()
@@ -191,57 +143,64 @@ void shutdown()
 
     free(ui_data.white_texture);
 
-    platform_free(ui_data.batch_shared_buffer);
+    for (TextRun& run : text_cache.runs)
+    {
+        free(run.text);
+        free(run.glyphs);
+    }
 
-    glDeleteBuffers(1, &ui_data.vbo);
-    glDeleteBuffers(1, &ui_data.ibo);
-    glDeleteVertexArrays(1, &ui_data.vao);
+    free(ui_data.commands);
+    ui_data.backend.shutdown();
 }
 
 void begin()
 {
     gn_assert_with_message(active_app, "Imgui was never initialized!");
 
-    batch_begin(ui_data.quad_batch);
-    batch_begin(ui_data.font_batch);
-
-    ui_data.batch_begun = true;
+    ui_data.frame_begun = true;
 }
 
-static void flush_batch(ImguiBatchData& batch)
+// Retained ranges count as the packets they're made of
+static void add_packet_stats(FrameStats& stats, const RenderCommandBuffer& commands)
 {
-    if (batch.elem_count == 0)
-        return;
-    
-    shader_bind(batch.shader);
+    // A quad packet only follows one with the same shader when that one was out of texture slots
+    for (u64 i = 0; i < commands.packets.size; i++)
+    {
+        const RenderPacket& packet = commands.packets[i];
+        if (packet.shader == RenderShader::RETAINED)
+        {
+            add_packet_stats(stats, *render_commands_get_retained(commands, packet).commands);
+            continue;
+        }
 
-    // Set all textures for the batch
-    for (u32 i = 0; i < batch.next_active_tex_slot; i++)
-        texture_bind(batch.textures[i], i);
-    
-    shader_set_uniform_1iv(batch.shader, ref("u_textures"), batch.next_active_tex_slot, active_tex_slots);
-    
-    // Bind and Update Data
-    GLsizeiptr size = (u8*) batch.elem_vertices_ptr - (u8*) batch.elem_vertices_buffer;
-    glBufferSubData(GL_ARRAY_BUFFER, 0, size, batch.elem_vertices_buffer);
+        const bool split = i > 0 && packet.shader == commands.packets[i - 1].shader && packet.shader != RenderShader::STARFIELD;
 
-    // Draw Elements
-    glDrawElements(GL_TRIANGLES, 6 * batch.elem_count, GL_UNSIGNED_INT, nullptr);
+        stats.draw_call_count    += 1;
+        stats.texture_bind_count += packet.texture_count;
+        stats.batch_split_count  += split;
+    }
 }
 
 void end()
 {
     gn_assert_with_message(active_app, "Imgui was never initialized!");
 
-    // Both Quads and Font passes use the same vao, vbo, and ibo
-    glBindVertexArray(ui_data.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, ui_data.vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ui_data.ibo);
+    render_commands_sort(ui_data.commands);
+
+    {   // Frame Stats
+        const RenderCommandBuffer& commands = ui_data.commands;
+        FrameStats& stats = ui_data.frame_stats;
+
+        add_packet_stats(stats, commands);
+
+        for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+            stats.upload_bytes += commands.quads[i].size * sizeof(RenderInstance);
+    }
 
-    flush_batch(ui_data.quad_batch);
-    flush_batch(ui_data.font_batch);
+    ui_data.backend.submit(ui_data.commands);
+    render_commands_clear(ui_data.commands);
 
-    ui_data.batch_begun = false;
+    ui_data.frame_begun = false;
 }
 
 void update()
@@ -251,14 +210,26 @@ void update()
 
     ui_data.state_prev_frame = ui_data.state_current_frame;
     ui_data.state_current_frame.hot = ui_data.state_current_frame.active = ui_data.state_current_frame.interacted = imgui_invalid_id;
+
+    ui_data.frame_stats = {};
     // That's pretty much it...
 }
 
+FrameStats get_frame_stats()
+{
+    return ui_data.frame_stats;
+}
+
+
+static inline u32 get_kerning_index(s32 a, s32 b)
+{
+    // Both are printable ascii
+    return (u32) (a - ' ') * Font::glyph_count + (u32) (b - ' ');
+}
 
-static inline s32 get_kerning_index(s32 a, s32 b)
+static inline bool is_kerning_pair(s64 a, s64 b)
 {
-    // Since all unicodes are less than 128
-    return ((a << 8) | b);
+    return a >= ' ' && a <= '~' && b >= ' ' && b <= '~';
 }
 
 static inline Font::Type get_font_type(const String type_string)
@@ -277,12 +248,39 @@ static inline Font::Type get_font_type(const String type_string)
     return Font::Type::SDF;
 }
 
+void add_to_atlas(SpriteAtlas& atlas)
+{
+    sprite_atlas_add_texture(atlas, ui_data.white_texture);
+}
+
+void move_to_atlas(const SpriteAtlas& atlas)
+{
+    ui_data.rect_texture    = ui_data.white_texture;
+    ui_data.rect_tex_coords = Vector4 { 0.0f, 0.0f, 1.0f, 1.0f };
+    sprite_atlas_remap(atlas, ui_data.rect_texture, ui_data.rect_tex_coords);
+}
+
+void font_move_to_atlas(Font& font, const SpriteAtlas& atlas)
+{
+    // Every glyph points into the font's own texture until the last one is moved
+    Texture page = font.atlas;
+    for (Font::GlyphData& glyph : font.glyphs)
+    {
+        page = font.atlas;
+        sprite_atlas_remap(atlas, page, glyph.atlas_bounds);
+    }
+
+    font.atlas = page;
+    font.id    = next_font_id++;
+}
+
 Font font_load_from_json(const Json::Document& document, const String atlas_path)
 {
     Font font = {};
+    font.id = next_font_id++;
 
     // Load font altas
-    font.atlas = texture_load_file(atlas_path, TextureSettings::default(), 4);
+    font.atlas = texture_load_file(atlas_path, TextureSettings::defaults(), 4);
 
     // Load font data
     const Json::Value& data = document.start();
@@ -337,11 +335,19 @@ Font font_load_from_json(const Json::Document& document, const String atlas_path
     }
 
     const Json::Array& kerning = data[ref("kerning")].array();
-    font.kerning_table = make<Font::KerningTable>();
+    font.kerning = (f32*) platform_allocate(Font::glyph_count * Font::glyph_count * sizeof(f32));
+    platform_set_memory(font.kerning, 0, Font::glyph_count * Font::glyph_count * sizeof(f32));
+
     for (u64 i = 0; i < kerning.size(); i++)
     {
-        s32 k_index = get_kerning_index(kerning[i][(ref("unicode1"))].int64(), kerning[i][(ref("unicode2"))].int64());
-        put(font.kerning_table, k_index, (f32) kerning[i][ref("advance")].float64());
+        const s64 unicode1 = kerning[i][ref("unicode1")].int64();
+        const s64 unicode2 = kerning[i][ref("unicode2")].int64();
+
+        // No glyphs to kern outside of ascii
+        if (!is_kerning_pair(unicode1, unicode2))
+            continue;
+
+        font.kerning[get_kerning_index(unicode1, unicode2)] = (f32) kerning[i][ref("advance")].float64();
     }
 
     return font;
@@ -350,6 +356,7 @@ Font font_load_from_json(const Json::Document& document, const String atlas_path
 Font font_load_from_bytes(const Bytes& bytes)
 {
     Font font = {};
+    font.id = next_font_id++;
 
     u64 offset = 1; // Skip object start byte
 
@@ -372,14 +379,17 @@ Font font_load_from_bytes(const Bytes& bytes)
     {   // Kerning Data
         u32 num_kernings = Binary::get_next_uint(bytes, offset) / 2;
 
-        const u32 kerning_table_size = 1.5f * (num_kernings);
-        font.kerning_table = make<Font::KerningTable>(kerning_table_size);
+        font.kerning = (f32*) platform_allocate(Font::glyph_count * Font::glyph_count * sizeof(f32));
+        platform_set_memory(font.kerning, 0, Font::glyph_count * Font::glyph_count * sizeof(f32));
 
         while (num_kernings--)
         {
+            // Pairs are stored as unicode1 << 8 | unicode2
             s32 key = Binary::get<s32>(bytes, offset);
             f32 advance = Binary::get<f32>(bytes, offset);
-            put(font.kerning_table, key, advance);
+
+            if (is_kerning_pair(key >> 8, key & 0xFF))
+                font.kerning[get_kerning_index(key >> 8, key & 0xFF)] = advance;
         }
     }
 
@@ -392,7 +402,7 @@ Font font_load_from_bytes(const Bytes& bytes)
 
         Bytes pixels = Binary::get<Bytes>(bytes, offset);
 
-        font.atlas = texture_load_pixels(name, pixels.data, width, height, bytes_pp, TextureSettings::default());
+        font.atlas = texture_load_pixels(name, pixels.data, width, height, bytes_pp, TextureSettings::defaults());
     }
 
     gn_assert_with_message(offset == bytes.size - 1, "For some reason there's extra data in the font bytes! (file size: %, stopped parsing at: %)", bytes.size, offset);
@@ -400,21 +410,22 @@ Font font_load_from_bytes(const Bytes& bytes)
     return font;
 }
 
-Vector2 get_rendered_text_size(const String text, const Font& font, f32 size)
+static void layout_text_run(TextRun& run, const String text, const Font& font, f32 size, const Vector4& clip_unit)
 {
-    size = (size < 0.0f) ? font.size : size;
+    clear(run.glyphs);
 
-    Vector2 position = Vector2 {};
-    position.y += size * font.ascender;
+    // Text measures from the ascender, glyphs are drawn a bit higher
+    Vector2 position = Vector2 { 0.0f, size * font.ascender * 0.85f };
+    Vector2 total_size = Vector2 { 0.0f, size * font.ascender };
 
-    Vector2 total_size = position;
+    const Vector4 size_v4 = Vector4(size);
 
     u64 line_start = 0;
     for (u64 i = 0; i < text.size; i++)
     {
         const char current_char = text[i];
-        
-        switch (current_char)        
+
+        switch (current_char)
         {
             case '\n':
             {
@@ -440,22 +451,97 @@ Vector2 get_rendered_text_size(const String text, const Font& font, f32 size)
 
             default:
             {
-                if (i > 0)
+                // Only printable ascii has glyphs
+                if (current_char < ' ' || current_char > '~')
+                    break;
+
+                if (i > 0 && is_kerning_pair(current_char, text[i - 1]))
+                    position.x += size * font.kerning[get_kerning_index(current_char, text[i - 1])];
+
+                const Font::GlyphData& glyph = font.glyphs[current_char - ' '];
+
+                // Spaces and the like don't draw anything
+                if (glyph.plane_bounds.s != glyph.plane_bounds.u)
                 {
-                    s32 kerning_index   = get_kerning_index(current_char, text[i - 1]);
-                    const auto& kerning = find(font.kerning_table, kerning_index);
-                    if (kerning)
-                        position.x += size * kerning.value(); 
+                    const Vector4 position_v4 = Vector4 { position.x, position.y, position.x, position.y };
+                    const Vector4 rect = position_v4 + size_v4 * Vector4 { glyph.plane_bounds.s, -glyph.plane_bounds.v, glyph.plane_bounds.u, -glyph.plane_bounds.t };
+                    const Vector4 clip = clip_unit * rect;
+
+                    // Same as push_ui_quad without the position of the text
+                    RenderInstance quad;
+                    quad.x = clip.x;
+                    quad.y = clip.w;
+                    quad.z = (f32) (i + 1) * z_offset;
+                    quad.width  = render_pack_size(clip.z - clip.x);
+                    quad.height = render_pack_size(clip.y - clip.w);
+                    quad.tex_coords[0] = render_pack_tex_coord(glyph.atlas_bounds.s);
+                    quad.tex_coords[1] = render_pack_tex_coord(glyph.atlas_bounds.t);
+                    quad.tex_coords[2] = render_pack_tex_coord(glyph.atlas_bounds.u);
+                    quad.tex_coords[3] = render_pack_tex_coord(glyph.atlas_bounds.v);
+                    quad.color = 0;
+                    quad.tex_index = 0;
+                    quad.padding[0] = quad.padding[1] = quad.padding[2] = 0;
+
+                    append(run.glyphs, quad);
                 }
 
-                const Font::GlyphData& glyph = font.glyphs[current_char - ' '];
                 position.x += size * glyph.advance;
             } break;
         }
     }
 
     total_size.x = max(total_size.x, position.x);
-    return total_size;
+    run.size = total_size;
+}
+
+// Clip space size of a ui unit, y flipped
+static Vector4 get_clip_unit()
+{
+    gn_assert_with_message(active_app, "Imgui was never initialized!");
+
+    const Vector4 screen_size = Vector4 { (f32) active_app->window.ref_width, (f32) active_app->window.ref_height, (f32) active_app->window.ref_width, (f32) active_app->window.ref_height };
+    return 2.0f * ui_data.scale_v2 / screen_size * Vector4 { 1.0f, -1.0f, 1.0f, -1.0f };
+}
+
+static const TextRun& get_text_run(const String text, const Font& font, f32 size, const Vector4& clip_unit)
+{
+    u64 key = render_hash_bytes(render_hash_seed, text.data, text.size);
+    key = render_hash_bytes(key, &font.id, sizeof(font.id));
+    key = render_hash_bytes(key, &size, sizeof(size));
+    key = render_hash_bytes(key, &clip_unit, sizeof(clip_unit));
+
+    TextRun* set = text_cache.runs + (key % text_cache_set_count) * text_cache_way_count;
+    text_cache.lookup_count++;
+
+    TextRun* oldest = set;
+    for (u32 i = 0; i < text_cache_way_count; i++)
+    {
+        TextRun& run = set[i];
+        if (run.last_used && run.key == key && run.text.size == text.size && platform_compare_memory(run.text.data, text.data, text.size))
+        {
+            run.last_used = text_cache.lookup_count;
+            return run;
+        }
+
+        if (run.last_used < oldest->last_used)
+            oldest = &run;
+    }
+
+    TextRun& run = *oldest;
+    run.key = key;
+    run.last_used = text_cache.lookup_count;
+
+    clear(run.text);
+    append_many(run.text, text.data, text.size);
+
+    layout_text_run(run, text, font, size, clip_unit);
+    return run;
+}
+
+Vector2 get_rendered_text_size(const String text, const Font& font, f32 size)
+{
+    size = (size < 0.0f) ? font.size : size;
+    return get_text_run(text, font, size, get_clip_unit()).size;
 }
 
 Vector2 get_rendered_char_size(const char ch, const Font& font, f32 size)
@@ -475,93 +561,181 @@ Vector2 get_rendered_char_size(const char ch, const Font& font, f32 size)
     return Vector2 { size * glyph.advance, size * font.line_height };
 }
 
-static void push_ui_quad(ImguiBatchData& batch, const Rect& rect, f32 z, const Vector4& tex_coords, const Texture& texture, const Vector4& color)
+static void push_ui_quad(RenderShader shader, const Rect& rect, f32 z, const Vector4& tex_coords, const Texture& texture, const Vector4& color)
 {
     gn_assert_with_message(active_app, "Imgui was never initialized!");
-    gn_assert_with_message(ui_data.batch_begun, "Imgui::begin() was never called!");
+    gn_assert_with_message(ui_data.frame_begun, "Imgui::begin() was never called!");
+
+    const Vector4 screen_size = Vector4 { (f32) active_app->window.ref_width, (f32) active_app->window.ref_height, (f32) active_app->window.ref_width, (f32) active_app->window.ref_height };
+    Vector4 quad_positions = 2.0f * ((ui_data.scale_v2 * rect.v4 + ui_data.offset_v2) / screen_size) - Vector4(1);
+    quad_positions *= Vector4 { 1.0f, -1.0f, 1.0f, -1.0f }; // Flip y axis coordinates
+
+    RenderInstance* quad = render_commands_push_quad(ui_data.commands, render_make_sort_key(z, shader, texture));
+
+    // Origin at the bottom left corner, the corners go counter clockwise from there
+    quad->x = quad_positions.x;
+    quad->y = quad_positions.w;
+    quad->z = z;
+    quad->width  = render_pack_size(quad_positions.z - quad_positions.x);
+    quad->height = render_pack_size(quad_positions.y - quad_positions.w);
+    quad->tex_coords[0] = render_pack_tex_coord(tex_coords.s);
+    quad->tex_coords[1] = render_pack_tex_coord(tex_coords.t);
+    quad->tex_coords[2] = render_pack_tex_coord(tex_coords.u);
+    quad->tex_coords[3] = render_pack_tex_coord(tex_coords.v);
+    quad->color = render_pack_color(color);
+    quad->tex_index = 0;
+    quad->padding[0] = quad->padding[1] = quad->padding[2] = 0;
+
+    ui_data.frame_stats.quad_count++;
+}
 
-    if (batch.elem_count >= max_quad_count)
+void set_offset(f32 x, f32 y)
+{
+    ui_data.offset_v2 = Vector4 { x, y, x, y };
+}
+
+void set_scale(f32 x, f32 y)
+{
+    ui_data.scale_v2 = Vector4 { x, y, x, y };
+}
+
+void register_button_callback(const Callback& callback)
+{
+    append(ui_data.button_callbacks, callback);
+}
+
+static inline bool is_same_id(const ID& a, const ID& b)
+{
+    return a.primary == b.primary && a.secondary == b.secondary;
+}
+
+static void record_widget(ID id, const Rect& adjusted_rect)
+{
+    if (ui_data.recording)
+        append(ui_data.recording->widgets, RetainedSection::Widget { id, adjusted_rect });
+}
+
+// Widgets in use are drawn differently the next frame
+static bool are_widgets_in_use(const RetainedSection& section, const UIStateData& state)
+{
+    for (u64 i = 0; i < section.widgets.size; i++)
     {
-        end();
-        begin();
+        const ID& id = section.widgets[i].id;
+        if (is_same_id(id, state.hot) || is_same_id(id, state.active) || is_same_id(id, state.interacted))
+            return true;
     }
 
-    // Find if texture has already been set to active
-    int texture_slot = batch.next_active_tex_slot;
-    for (int i = 0; i < batch.next_active_tex_slot; i++)
+    return false;
+}
+
+static bool are_widgets_under_mouse(const RetainedSection& section)
+{
+    const Vector2 mpos = Input::mouse_position();
+
+    for (u64 i = 0; i < section.widgets.size; i++)
     {
-        if (batch.textures[i].id == texture.id)
+        const Rect& rect = section.widgets[i].rect;
+        if (mpos.x >= rect.left && mpos.x <= rect.right &&
+            mpos.y >= rect.top  && mpos.y <= rect.bottom)
         {
-            texture_slot = i;
-            break;
+            return true;
         }
     }
 
-    if (texture_slot == batch.next_active_tex_slot)
+    return false;
+}
+
+// Shared by every section so a generation is never seen twice
+static u32 next_retained_generation = 1;
+
+static void push_retained(const RetainedSection& section)
+{
+    if (section.commands.packets.size == 0)
+        return;
+
+    RenderRetained retained = {};
+    retained.sort_key   = section.commands.packets[0].sort_key;
+    retained.commands   = &section.commands;
+    retained.generation = section.generation;
+
+    render_commands_push_retained(ui_data.commands, retained);
+}
+
+bool retained_begin(RetainedSection& section, const void* key, u64 key_size, f32& z)
+{
+    gn_assert_with_message(ui_data.frame_begun, "Imgui::begin() was never called!");
+    gn_assert_with_message(ui_data.recording == nullptr, "Retained sections can't be nested!");
+
+    const Vector4 clip_unit = get_clip_unit();
+
+    const bool replay = section.valid &&
+                        section.key.size == key_size && platform_compare_memory(section.key.data, key, key_size) &&
+                        section.z_begin == z &&
+                        section.offset == ui_data.offset_v2 && section.scale == ui_data.scale_v2 && section.clip_unit == clip_unit &&
+                        !are_widgets_in_use(section, ui_data.state_prev_frame) && !are_widgets_under_mouse(section);
+
+    if (replay)
     {
-        // End the batch if all the texture slots are occupied
-        if (texture_slot >= max_tex_count)
-        {
-            end();
-            begin();
+        push_retained(section);
 
-            texture_slot = 0;
-        }
+        const RenderPacket* packets = section.commands.packets.data;
+        for (u64 i = 0; i < section.commands.packets.size; i++)
+            ui_data.frame_stats.quad_count += packets[i].quad_count;
 
-        batch.textures[texture_slot] = texture;
-        batch.next_active_tex_slot++;
+        z = section.z_end;
+        return false;
     }
 
-    const Vector4 screen_size = Vector4 { (f32) active_app->window.ref_width, (f32) active_app->window.ref_height, (f32) active_app->window.ref_width, (f32) active_app->window.ref_height };
-    Vector4 quad_positions = 2.0f * ((ui_data.scale_v2 * rect.v4 + ui_data.offset_v2) / screen_size) - Vector4(1);
-    quad_positions *= Vector4 { 1.0f, -1.0f, 1.0f, -1.0f }; // Flip y axis coordinates
+    clear(section.key);
+    append_many(section.key, (const u8*) key, key_size);
 
-    batch.elem_vertices_ptr->position = Vector3(quad_positions.x, quad_positions.w, z);
-    batch.elem_vertices_ptr->tex_coord = Vector2(tex_coords.s, tex_coords.v);
-    batch.elem_vertices_ptr->color = color;
-    batch.elem_vertices_ptr->tex_index = (f32) texture_slot;
-    batch.elem_vertices_ptr++;
+    section.z_begin   = z;
+    section.offset    = ui_data.offset_v2;
+    section.scale     = ui_data.scale_v2;
+    section.clip_unit = clip_unit;
 
-    batch.elem_vertices_ptr->position = Vector3(quad_positions.z, quad_positions.w, z);
-    batch.elem_vertices_ptr->tex_coord = Vector2(tex_coords.u, tex_coords.v);
-    batch.elem_vertices_ptr->color = color;
-    batch.elem_vertices_ptr->tex_index = (f32) texture_slot;
-    batch.elem_vertices_ptr++;
+    render_commands_clear(section.commands);
+    clear(section.widgets);
 
-    batch.elem_vertices_ptr->position = Vector3(quad_positions.z, quad_positions.y, z);
-    batch.elem_vertices_ptr->tex_coord = Vector2(tex_coords.u, tex_coords.t);
-    batch.elem_vertices_ptr->color = color;
-    batch.elem_vertices_ptr->tex_index = (f32) texture_slot;
-    batch.elem_vertices_ptr++;
+    section.first_quad = ui_data.commands.pushed_quads.size;
+    ui_data.recording = &section;
 
-    batch.elem_vertices_ptr->position = Vector3(quad_positions.x, quad_positions.y, z);
-    batch.elem_vertices_ptr->tex_coord = Vector2(tex_coords.s, tex_coords.t);
-    batch.elem_vertices_ptr->color = color;
-    batch.elem_vertices_ptr->tex_index = (f32) texture_slot;
-    batch.elem_vertices_ptr++;
-
-    batch.elem_count++;
+    return true;
 }
 
-void set_offset(f32 x, f32 y)
+void retained_end(RetainedSection& section, f32 z)
 {
-    ui_data.offset_v2 = Vector4 { x, y, x, y };
-}
+    gn_assert_with_message(ui_data.recording == &section, "Retained section was never begun!");
+    ui_data.recording = nullptr;
 
-void set_scale(f32 x, f32 y)
-{
-    ui_data.scale_v2 = Vector4 { x, y, x, y };
-}
+    {   // Move the recording out of the frame and sort it on its own
+        RenderCommandBuffer& commands = ui_data.commands;
+        const u64 count = commands.pushed_quads.size - section.first_quad;
 
-void register_button_callback(const Callback& callback)
-{
-    append(ui_data.button_callbacks, callback);
+        u64* sort_keys;
+        RenderInstance* quads = render_commands_push_quads(section.commands, count, sort_keys);
+
+        platform_copy_memory(quads, commands.pushed_quads.data + section.first_quad, count * sizeof(RenderInstance));
+        platform_copy_memory(sort_keys, commands.pushed_keys.data + section.first_quad, count * sizeof(u64));
+
+        commands.pushed_quads.size = section.first_quad;
+        commands.pushed_keys.size  = section.first_quad;
+
+        render_commands_sort(section.commands);
+
+        section.generation = next_retained_generation++;
+        ui_data.frame_stats.upload_bytes += count * sizeof(RenderInstance);
+    }
+
+    push_retained(section);
+
+    section.z_end = z;
+    section.valid = !are_widgets_in_use(section, ui_data.state_prev_frame) && !are_widgets_in_use(section, ui_data.state_current_frame);
 }
 
 void render_rect(const Rect& rect, f32 z, const Vector4& color)
 {
-    Vector4 tex_coords { 0.0f, 0.0f, 1.0f, 1.0f };
-    push_ui_quad(ui_data.quad_batch, rect, z, tex_coords, ui_data.white_texture, color);
+    push_ui_quad(RenderShader::QUAD, rect, z, ui_data.rect_tex_coords, ui_data.rect_texture, color);
 }
 
 void render_overlap_rect(ID id, const Rect& rect, f32 z, const Vector4& color)
@@ -570,6 +744,7 @@ void render_overlap_rect(ID id, const Rect& rect, f32 z, const Vector4& color)
     
     Rect adjusted_rect;
     adjusted_rect.v4 = ui_data.scale_v2 * rect.v4 + ui_data.offset_v2;
+    record_widget(id, adjusted_rect);
 
     if (mpos.x >= adjusted_rect.left && mpos.x <= adjusted_rect.right &&
         mpos.y >= adjusted_rect.top  && mpos.y <= adjusted_rect.bottom)
@@ -577,8 +752,7 @@ void render_overlap_rect(ID id, const Rect& rect, f32 z, const Vector4& color)
         ui_data.state_current_frame.hot = id;
     }
 
-    Vector4 tex_coords { 0.0f, 0.0f, 1.0f, 1.0f };
-    push_ui_quad(ui_data.quad_batch, rect, z, tex_coords, ui_data.white_texture, color);
+    push_ui_quad(RenderShader::QUAD, rect, z, ui_data.rect_tex_coords, ui_data.rect_texture, color);
 }
 
 void render_image(const Image& image, const Vector2& top_left, f32 z, const Vector2& size, const Vector4& tint)
@@ -592,7 +766,7 @@ void render_image(const Image& image, const Vector2& top_left, f32 z, const Vect
     rect.right  = top_left.x + ((size.x >= 0.0f) ? size.x : (f32) texture_get_width(image));
     rect.bottom = top_left.y + ((size.y >= 0.0f) ? size.y : (f32) texture_get_height(image));
 
-    push_ui_quad(ui_data.quad_batch, rect, z, tex_coords, image, tint);
+    push_ui_quad(RenderShader::QUAD, rect, z, tex_coords, image, tint);
 }
 
 void render_sprite(const Sprite& sprite, const Vector2& position, f32 z, const Vector2& scale, const Vector4& tint)
@@ -605,7 +779,33 @@ void render_sprite(const Sprite& sprite, const Vector2& position, f32 z, const V
     sprite_rect.top    = position.y - scale.y * sprite.size.y * (1.0f - sprite.pivot.y);
     sprite_rect.bottom = position.y + scale.y * sprite.size.y * sprite.pivot.y;
 
-    push_ui_quad(ui_data.quad_batch, sprite_rect, z, sprite.tex_coords.v4, sprite.atlas, tint);
+    push_ui_quad(RenderShader::QUAD, sprite_rect, z, sprite.tex_coords.v4, sprite.atlas, tint);
+}
+
+void render_starfield(const Starfield& starfield, const StarfieldView& view)
+{
+    gn_assert_with_message(active_app, "Imgui was never initialized!");
+    gn_assert_with_message(ui_data.frame_begun, "Imgui::begin() was never called!");
+    gn_assert_with_message(ui_data.recording == nullptr, "Starfields can't be drawn in a retained section!");
+
+    if (starfield.stars.size == 0)
+        return;
+
+    RenderStarfield command = {};
+    command.sort_key    = render_make_sort_key(view.z, RenderShader::STARFIELD, starfield.atlas);
+    command.stars       = starfield.stars.data;
+    command.star_count  = (u32) starfield.stars.size;
+    command.generation  = starfield.generation;
+    command.texture     = starfield.atlas;
+    command.playground  = view.playground;
+    command.parallax    = view.parallax;
+    command.transform   = Vector4 { view.scale.x, view.scale.y, view.offset.x, view.offset.y };
+    command.screen_size = view.screen_size;
+    command.z           = view.z;
+
+    render_commands_push_starfield(ui_data.commands, command);
+
+    ui_data.frame_stats.quad_count += command.star_count;
 }
 
 bool render_button(ID id, const Rect& rect, f32 z, const Vector4& default_color, const Vector4& hover_color, const Vector4& pressed_color)
@@ -615,6 +815,7 @@ bool render_button(ID id, const Rect& rect, f32 z, const Vector4& default_color,
     
     Rect adjusted_rect;
     adjusted_rect.v4 = ui_data.scale_v2 * rect.v4 + ui_data.offset_v2;
+    record_widget(id, adjusted_rect);
 
     // Calculations for the current frame
     if (mpos.x >= adjusted_rect.left && mpos.x <= adjusted_rect.right &&
@@ -655,66 +856,37 @@ bool render_button(ID id, const Rect& rect, f32 z, const Vector4& default_color,
 
 void render_text(const String text, const Font& font, const Vector2& top_left, f32 z, f32 size, const Vector4& tint)
 {
-    size = (size < 0.0f) ? font.size : size;
-
-    Vector2 position = top_left;
-    position.y += size * font.ascender * 0.85f;
-
-    u64 line_start = 0;
-
-    ImguiBatchData& batch = (font.type == Font::Type::SDF) ? ui_data.font_batch : ui_data.quad_batch;
-
-    const Vector4 size_v4 = Vector4(size);
-    for (u64 i = 0; i < text.size; i++)
-    {
-        const char current_char = text[i];
-
-        switch (current_char)        
-        {
-            case '\n':
-            {
-                position.y += size * font.line_height;
-                position.x = top_left.x;
-                line_start = i + 1;
-            } break;
+    gn_assert_with_message(ui_data.frame_begun, "Imgui::begin() was never called!");
 
-            case '\r':
-            {
-                position.x = top_left.x;
-            } break;
-
-            case '\t':
-            {
-                f32 x = size * font.glyphs[0].advance;
-                position.x += x * (4 - ((i - line_start) % 4));
-            } break;
-        }
+    size = (size < 0.0f) ? font.size : size;
 
-        const Font::GlyphData& glyph = font.glyphs[current_char - ' '];
-        const Vector4 position_v4 = Vector4 { position.x, position.y, position.x, position.y };
+    const TextRun& run = get_text_run(text, font, size, get_clip_unit());
+    if (run.glyphs.size == 0)
+        return;
 
-        Rect rect;
-        rect.v4 = position_v4 + size_v4 * Vector4 { glyph.plane_bounds.s, -glyph.plane_bounds.v, glyph.plane_bounds.u, -glyph.plane_bounds.t };
+    const RenderShader shader = (font.type == Font::Type::SDF) ? RenderShader::FONT : RenderShader::QUAD;
 
-        z += z_offset;
+    // Clip space position of the top left corner
+    const Vector4 screen_size = Vector4 { (f32) active_app->window.ref_width, (f32) active_app->window.ref_height, (f32) active_app->window.ref_width, (f32) active_app->window.ref_height };
+    const Vector4 origin = 2.0f * ((ui_data.scale_v2 * Vector4 { top_left.x, top_left.y, top_left.x, top_left.y } + ui_data.offset_v2) / screen_size) - Vector4(1);
 
-        if (i > 0)
-        {
-            s32 kerning_index   = get_kerning_index(current_char, text[i - 1]);
-            const auto& kerning = find(font.kerning_table, kerning_index);
-            if (kerning)
-            {
-                const f32 k = kerning.value();
-                rect.left  += size * k;
-                rect.right += size * k;
-                position.x += size * k; 
-            }
-        }
+    u64* sort_keys;
+    RenderInstance* quads = render_commands_push_quads(ui_data.commands, run.glyphs.size, sort_keys);
+    platform_copy_memory(quads, run.glyphs.data, run.glyphs.size * sizeof(RenderInstance));
 
-        push_ui_quad(batch, rect, z, glyph.atlas_bounds, font.atlas, tint);
+    const u32 color = render_pack_color(tint);
+    for (u64 i = 0; i < run.glyphs.size; i++)
+    {
+        RenderInstance& quad = quads[i];
+        quad.x += origin.x;
+        quad.y -= origin.y;
+        quad.z += z;
+        quad.color = color;
 
-        position.x += size * glyph.advance;
+        sort_keys[i] = render_make_sort_key(quad.z, shader, font.atlas);
     }
+
+    ui_data.frame_stats.quad_count += (u32) run.glyphs.size;
 }
 
 void render_char(const char ch, const Font& font, const Vector2& top_left, f32 z, f32 size, const Vector4& tint)
@@ -741,9 +913,9 @@ void render_char(const char ch, const Font& font, const Vector2& top_left, f32 z
     Rect rect;
     rect.v4 = position_v4 + size_v4 * Vector4 { glyph.plane_bounds.s, -glyph.plane_bounds.v, glyph.plane_bounds.u, -glyph.plane_bounds.t };
     
-    ImguiBatchData& batch = (font.type == Font::Type::SDF) ? ui_data.font_batch : ui_data.quad_batch;
+    const RenderShader shader = (font.type == Font::Type::SDF) ? RenderShader::FONT : RenderShader::QUAD;
 
-    push_ui_quad(batch, rect, z, glyph.atlas_bounds, font.atlas, tint);
+    push_ui_quad(shader, rect, z, glyph.atlas_bounds, font.atlas, tint);
 }
 
 bool render_text_button(ID id, const Rect& rect, const String text, const Font& font, const Vector2 padding, f32 z, f32 size)
@@ -763,6 +935,7 @@ f32 render_slider_01(ID id, f32 value, const Rect& area, const Vector2& handle_s
     
     Rect adjusted_rect;
     adjusted_rect.v4 = ui_data.scale_v2 * area.v4 + ui_data.offset_v2;
+    record_widget(id, adjusted_rect);
 
     if (enabled)
     {
@@ -832,7 +1005,27 @@ f32 render_slider(ID id, f32 value, const f32 min, const f32 max, const Rect& ar
 
 } // namespace Imgui
 
+Imgui::RetainedSection make(Type<Imgui::RetainedSection>)
+{
+    Imgui::RetainedSection section = {};
+    section.key       = make<DynamicArray<u8>>(64ull);
+    section.commands  = make<RenderCommandBuffer>();
+    section.widgets   = make<DynamicArray<Imgui::RetainedSection::Widget>>();
+
+    return section;
+}
+
+void free(Imgui::RetainedSection& section)
+{
+    free(section.key);
+    free(section.commands);
+    free(section.widgets);
+
+    section = {};
+}
+
 void free(Imgui::Font& font)
 {
-    free(font.kerning_table);
+    platform_free(font.kerning);
+    font.kerning = nullptr;
 }
\ No newline at end of file
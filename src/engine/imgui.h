@@ -9,13 +9,17 @@
 #include "math/math.h"
 #include "serialization/json/json_document.h"
 #include "rect.h"
+#include "render_backend.h"
 #include "sprite.h"
+#include "sprite_atlas.h"
+#include "starfield.h"
 
 namespace Imgui
 {
 
 // Initialization and Shutdown
-void init(const Application& app);
+// Every frame goes to the backend at end()
+void init(const Application& app, const RenderBackend& backend);
 void shutdown();
 
 // Begin and End UI Pass
@@ -25,6 +29,18 @@ void end();
 // Required for proper functioning UI
 void update();
 
+// Work submitted so far this frame, update() starts the next frame from 0
+struct FrameStats
+{
+    u32 quad_count;
+    u32 draw_call_count;
+    u32 texture_bind_count;     // Every packet binds all of its textures
+    u32 batch_split_count;      // Packets that only started because the one before ran out of texture slots
+    u64 upload_bytes;           // Quad data handed to the backend, retained sections only count when they're recorded
+};
+
+FrameStats get_frame_stats();
+
 struct ID
 {
     s32 primary;
@@ -62,23 +78,64 @@ struct Font
         SDF
     };
 
-    using KerningTable = HashTable<s32, f32>;
+    static constexpr u32 glyph_count = 127 - ' ';  // Printable ascii
 
     Texture atlas;
     Type type;
+    u32 id;     // Tells fonts apart in the text cache
 
     u32 size;
     f32 line_height;
     f32 ascender, descender;
 
-    GlyphData glyphs[127 - ' '];
-    KerningTable kerning_table = {};
+    GlyphData glyphs[glyph_count];
+
+    // Extra advance for every pair of glyphs, glyph_count x glyph_count with unicode1 as the row like the font
+    // files. Text looks pairs up as (current, previous).
+    f32* kerning = nullptr;
+};
+
+// Retained Sections
+// Everything drawn between retained_begin and retained_end is recorded, the next frames replay the recording
+// instead as long as the key (whatever the section shows), z, the offset, the scale and the screen size stay the
+// same and none of its widgets is hot, active or under the mouse. retained_begin returns true when the section
+// has to be drawn, finish it with retained_end. Either way z ends up where drawing would have left it.
+// The recording is sorted once into a command buffer of its own and handed to the backend as a retained range,
+// so a replayed frame neither sorts nor uploads its quads again. Nothing else should be drawn at the z values it used.
+struct RetainedSection
+{
+    struct Widget
+    {
+        ID id;
+        Rect rect;      // On screen, like the mouse position
+    };
+
+    DynamicArray<u8> key;
+    f32 z_begin, z_end;
+    Vector4 offset, scale, clip_unit;
+
+    RenderCommandBuffer commands;   // Sorted
+    u32 generation;                 // New for every recording
+    DynamicArray<Widget> widgets;
+
+    u64 first_quad;     // Of the recording in the frame's pushed quads
+    bool valid;         // Recorded with none of its widgets in use
 };
 
+bool retained_begin(RetainedSection& section, const void* key, u64 key_size, f32& z);
+void retained_end(RetainedSection& section, f32 z);
+
 // Deserialization
 Font font_load_from_json(const Json::Document& document, const String atlas_path);
 Font font_load_from_bytes(const Bytes& bytes);
 
+// Sprite Atlas
+// Adding the white texture rects are drawn with lets them share packets with the sprites and text in the atlas,
+// move them (and the fonts that were added) once the atlas is packed
+void add_to_atlas(SpriteAtlas& atlas);
+void move_to_atlas(const SpriteAtlas& atlas);
+void font_move_to_atlas(Font& font, const SpriteAtlas& atlas);
+
 // Utility Functions
 Vector2 get_rendered_text_size(const String text, const Font& font, f32 size = -1.0f);
 Vector2 get_rendered_char_size(const char ch, const Font& font, f32 size = -1.0f);
@@ -94,6 +151,7 @@ void render_rect(const Rect& rect, f32 z, const Vector4& color);
 void render_overlap_rect(ID id, const Rect& rect, f32 z, const Vector4& color);   // Overlap rect prevents items under it from being interacted with
 void render_image(const Image& image, const Vector2& top_left, f32 z, const Vector2& size = Vector2(-1.0f), const Vector4& tint = Vector4(1.0f));
 void render_sprite(const Sprite& sprite, const Vector2& position, f32 z, const Vector2& scale = Vector2(1.0f), const Vector4& tint = Vector4(1.0f));
+void render_starfield(const Starfield& starfield, const StarfieldView& view);     // All the stars at view.z, in one packet
 bool render_button(ID id, const Rect& rect, f32 z, const Vector4& default_color = Vector4(0.5f, 0.5f, 0.5f, 0.0f), const Vector4& hover_color = Vector4(0.5f, 0.5f, 0.5f, 0.4f), const Vector4& pressed_color = Vector4(0.35f, 0.35f, 0.35f, 0.7f));
 
 void render_text(const String text, const Font& font, const Vector2& top_left, f32 z, f32 size = -1.0f, const Vector4& tint = Vector4(1.0f));
@@ -108,5 +166,8 @@ f32 render_slider(ID id, f32 value, const f32 min, const f32 max, const Rect& ar
 
 void free(Imgui::Font& font);
 
+Imgui::RetainedSection make(Type<Imgui::RetainedSection>);
+void free(Imgui::RetainedSection& section);
+
 #define imgui_gen_id() (Imgui::ID { __LINE__, 0 })
 #define imgui_gen_id_with_secondary(sec) (Imgui::ID { __LINE__, (sec) })
\ No newline at end of file
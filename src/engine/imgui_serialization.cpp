@@ -15,7 +15,7 @@ Bytes font_encode_to_bytes(const Font& font)
 {
     s32 image_size = texture_get_width(font.atlas) * texture_get_height(font.atlas) * 4;
 
-    DynamicArray<u8> bytes = make<DynamicArray<u8>>(sizeof(Font) + image_size);
+    DynamicArray<u8> bytes = make<DynamicArray<u8>>((u64) (sizeof(Font) + image_size));
 
     append(bytes, Binary::OBJECT_START);
     
@@ -59,23 +59,29 @@ Bytes font_encode_to_bytes(const Font& font)
         append_many(bytes, (u8*) font.glyphs, sizeof(font.glyphs));
     }
 
-    {   // Kerning
-        u32 count = font.kerning_table.filled;
+    {   // Kerning (only the pairs that have any, as unicode1 << 8 | unicode2)
+        constexpr u32 pair_count = Font::glyph_count * Font::glyph_count;
+
+        u32 count = 0;
+        for (u32 i = 0; i < pair_count; i++)
+            count += font.kerning[i] != 0.0f;
+
         append(bytes, Binary::ARRAY_2_BYTE);
         Binary::append_integer(bytes, (u16) (count * 2));
 
-        for (u32 i = 0; count > 0 && i < font.kerning_table.capacity; i++)
+        for (u32 i = 0; i < pair_count; i++)
         {
-            if (font.kerning_table.states[i] == Font::KerningTable::State::ALIVE)
-            {
-                append(bytes, Binary::INTEGER_S32);
-                Binary::append_integer(bytes, font.kerning_table.keys[i]);
-                
-                append(bytes, Binary::FLOAT_32);
-                Binary::append_float(bytes, font.kerning_table.values[i]);
-
-                count--;
-            }
+            if (font.kerning[i] == 0.0f)
+                continue;
+
+            const s32 unicode1 = (s32) (i / Font::glyph_count) + ' ';
+            const s32 unicode2 = (s32) (i % Font::glyph_count) + ' ';
+
+            append(bytes, Binary::INTEGER_S32);
+            Binary::append_integer(bytes, (unicode1 << 8) | unicode2);
+
+            append(bytes, Binary::FLOAT_32);
+            Binary::append_float(bytes, font.kerning[i]);
         }
     }
 
@@ -0,0 +1,180 @@
+#include "particles.h"
+
+#include <xmmintrin.h>
+
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "math/constants.h"
+#include "platform/platform.h"
+
+// Smaller updates stay on the calling thread, measured in blocks of 4 particles
+static constexpr u64 update_batch_block_count = 1024;
+
+static constexpr u64 array_count   = 13;
+static constexpr u64 array_padding = 16;   // Floats, one cache line
+
+ParticlePool make(Type<ParticlePool>, u64 capacity)
+{
+    ParticlePool pool = {};
+
+    // Every array starts 16 byte aligned as long as the allocation does
+    pool.capacity = (capacity + 3) & ~3ull;
+
+    // With power of 2 capacities every array would start at the same cache set and the
+    // updates (touching all of them at once) would keep evicting each other's lines
+    const u64 stride = pool.capacity + array_padding;
+
+    f32* memory = (f32*) platform_allocate(array_count * stride * sizeof(f32));
+    gn_assert_with_message(((u64) memory & 15) == 0, "Particle memory isn't 16 byte aligned! (address: %)", (void*) memory);
+
+    // Lanes past the count still get updated, zeroing them keeps those lanes free of nans
+    platform_zero_memory(memory, array_count * stride * sizeof(f32));
+
+    f32** arrays[array_count] = {
+        &pool.position_x, &pool.position_y,
+        &pool.velocity_x, &pool.velocity_y,
+        &pool.life,
+        &pool.color[0], &pool.color[1], &pool.color[2], &pool.color[3],
+        &pool.color_velocity[0], &pool.color_velocity[1], &pool.color_velocity[2], &pool.color_velocity[3]
+    };
+
+    for (u64 i = 0; i < array_count; i++)
+        *arrays[i] = memory + i * stride;
+
+    Math::random_seed(pool.rng, 0x9e3779b97f4a7c15ull);
+
+    return pool;
+}
+
+void free(ParticlePool& pool)
+{
+    // position_x is the start of the allocation
+    platform_free(pool.position_x);
+    pool = {};
+}
+
+void particles_clear(ParticlePool& pool)
+{
+    pool.count = 0;
+}
+
+void particles_emit(ParticlePool& pool, const ParticleEmitter& emitter, Vector2 position)
+{
+    const u64 count = min((u64) emitter.count, pool.capacity - pool.count);
+
+    for (u64 n = 0; n < count; n++)
+    {
+        const u64 i = pool.count + n;
+
+        const f32 angle    = 2.0f * Math::PI * Math::random(pool.rng);
+        const f32 speed    = lerp(emitter.min_speed, emitter.max_speed, Math::random(pool.rng));
+        const f32 lifetime = lerp(emitter.min_lifetime, emitter.max_lifetime, Math::random(pool.rng));
+
+        pool.position_x[i] = position.x;
+        pool.position_y[i] = position.y;
+        pool.velocity_x[i] = speed * Math::cos(angle);
+        pool.velocity_y[i] = speed * Math::sin(angle);
+        pool.life[i] = lifetime;
+
+        for (u64 c = 0; c < 4; c++)
+        {
+            pool.color[c][i] = emitter.start_color.data[c];
+            pool.color_velocity[c][i] = (emitter.end_color.data[c] - emitter.start_color.data[c]) / lifetime;
+        }
+    }
+
+    pool.count += count;
+}
+
+// Updates every particle in [start, end), both multiples of 4
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void particles_integrate(const ParticlePool& pool, u64 start, u64 end, f32 time_step)
+{
+    const __m128 dt      = _mm_set1_ps(time_step);
+    const __m128 damping = _mm_set1_ps(max(1.0f - pool.drag * time_step, 0.0f));
+    const __m128 accel_x = _mm_set1_ps(pool.acceleration.x * time_step);
+    const __m128 accel_y = _mm_set1_ps(pool.acceleration.y * time_step);
+    const __m128 zero    = _mm_setzero_ps();
+    const __m128 one     = _mm_set1_ps(1.0f);
+
+    for (u64 i = start; i < end; i += 4)
+    {
+        const __m128 velocity_x = _mm_mul_ps(_mm_add_ps(_mm_load_ps(pool.velocity_x + i), accel_x), damping);
+        const __m128 velocity_y = _mm_mul_ps(_mm_add_ps(_mm_load_ps(pool.velocity_y + i), accel_y), damping);
+
+        _mm_store_ps(pool.velocity_x + i, velocity_x);
+        _mm_store_ps(pool.velocity_y + i, velocity_y);
+        _mm_store_ps(pool.position_x + i, _mm_add_ps(_mm_load_ps(pool.position_x + i), _mm_mul_ps(velocity_x, dt)));
+        _mm_store_ps(pool.position_y + i, _mm_add_ps(_mm_load_ps(pool.position_y + i), _mm_mul_ps(velocity_y, dt)));
+
+        _mm_store_ps(pool.life + i, _mm_sub_ps(_mm_load_ps(pool.life + i), dt));
+
+        for (u64 c = 0; c < 4; c++)
+        {
+            const __m128 color = _mm_add_ps(_mm_load_ps(pool.color[c] + i), _mm_mul_ps(_mm_load_ps(pool.color_velocity[c] + i), dt));
+            _mm_store_ps(pool.color[c] + i, _mm_min_ps(_mm_max_ps(color, zero), one));
+        }
+    }
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void particles_move(ParticlePool& pool, u64 from, u64 to)
+{
+    pool.position_x[to] = pool.position_x[from];
+    pool.position_y[to] = pool.position_y[from];
+    pool.velocity_x[to] = pool.velocity_x[from];
+    pool.velocity_y[to] = pool.velocity_y[from];
+    pool.life[to] = pool.life[from];
+
+    for (u64 c = 0; c < 4; c++)
+    {
+        pool.color[c][to] = pool.color[c][from];
+        pool.color_velocity[c][to] = pool.color_velocity[c][from];
+    }
+}
+
+// Moves the last particle into the place of every dead one, so apart from finding them
+// (4 at a time) the work only depends on how many particles died
+static void particles_compact(ParticlePool& pool)
+{
+    const __m128 zero = _mm_setzero_ps();
+
+    u64 count = pool.count;
+    for (u64 block = 0; block < count; block += 4)
+    {
+        if (_mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(pool.life + block), zero)) == 0)
+            continue;
+
+        // The particle moved in can be dead as well, so the index only moves on past live ones
+        u64 i = block;
+        while (i < min(block + 4, count))
+        {
+            if (pool.life[i] > 0.0f)
+            {
+                i++;
+                continue;
+            }
+
+            count--;
+            particles_move(pool, count, i);
+        }
+    }
+
+    pool.count = count;
+}
+
+void particles_update(ParticlePool& pool, f32 time_step)
+{
+    pool.last_time_step = time_step;
+
+    const u64 block_count = (pool.count + 3) / 4;
+
+    Jobs::parallel_for(block_count, update_batch_block_count, [&](u64 start, u64 end)
+    {
+        particles_integrate(pool, 4 * start, 4 * end, time_step);
+    });
+
+    particles_compact(pool);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/common.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "math/vecs/vector2.h"
+#include "math/vecs/vector4.h"
+
+// Pooled particles
+// Every particle lives in a fixed capacity structure of arrays, so an update is a few SSE loops
+// over contiguous floats (split across the job system when there are enough of them).
+// Emitting into a full pool drops the new particles, nothing is allocated after make.
+// Dead particles are compacted away at the end of every update so the live ones are always [0, count),
+// their order isn't kept.
+
+struct ParticleEmitter
+{
+    u32 count;
+
+    f32 min_speed;
+    f32 max_speed;
+
+    f32 min_lifetime;
+    f32 max_lifetime;
+
+    // Colours are blended from start to end over the lifetime of each particle
+    Vector4 start_color;
+    Vector4 end_color;
+};
+
+struct ParticlePool
+{
+    u64 capacity;   // Multiple of 4
+    u64 count;
+
+    // All capacity sized arrays inside a single allocation
+    f32* position_x;
+    f32* position_y;
+    f32* velocity_x;
+    f32* velocity_y;
+    f32* life;                  // Seconds left
+    f32* color[4];              // r, g, b, a
+    f32* color_velocity[4];     // Change per second
+
+    Vector2 acceleration;
+    f32 drag;                   // Fraction of the velocity lost per second
+
+    // Rendering goes back along the velocity by this much to blend between ticks
+    f32 last_time_step;
+
+    // Particles are cosmetic, they never touch the gameplay random number generator
+    Math::Random rng;
+};
+
+ParticlePool make(Type<ParticlePool>, u64 capacity);
+void free(ParticlePool& pool);
+
+void particles_clear(ParticlePool& pool);
+void particles_emit(ParticlePool& pool, const ParticleEmitter& emitter, Vector2 position);
+void particles_update(ParticlePool& pool, f32 time_step);
+
+// Position of a particle between the previous tick (alpha = 0) and the current one (alpha = 1)
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+Vector2 particles_get_position(const ParticlePool& pool, u64 index, f32 alpha)
+{
+    const f32 rewind = (1.0f - alpha) * pool.last_time_step;
+    return Vector2 {
+        pool.position_x[index] - rewind * pool.velocity_x[index],
+        pool.position_y[index] - rewind * pool.velocity_y[index]
+    };
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+Vector4 particles_get_color(const ParticlePool& pool, u64 index)
+{
+    return Vector4 { pool.color[0][index], pool.color[1][index], pool.color[2][index], pool.color[3][index] };
+}
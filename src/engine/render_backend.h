@@ -0,0 +1,26 @@
+#pragma once
+
+#include "render_commands.h"
+#include "software_rasterizer.h"
+
+// Consumer of the command buffer
+// A backend gets everything Imgui recorded in a frame in one submit, the buffer is only valid during the call.
+
+struct RenderBackend
+{
+    void (*init)();
+    void (*shutdown)();
+    void (*submit)(const RenderCommandBuffer& commands);
+};
+
+// Draws with the Imgui quad and font shaders, needs a current OpenGL context
+RenderBackend render_backend_opengl();
+
+// Draws nothing, keeps a copy of the last frame it got so it can be inspected, hashed or saved
+RenderBackend render_backend_null();
+const RenderCommandBuffer& render_backend_null_get_last_commands();
+
+// Rasterizes every frame on the CPU, set the target before the backend is initialized
+RenderBackend render_backend_software();
+void render_backend_software_set_target(u32 width, u32 height, const Vector4& clear_color);
+const SoftwareRasterizer& render_backend_software_get_rasterizer();
@@ -0,0 +1,35 @@
+#include "render_backend.h"
+
+#include "core/types.h"
+
+static RenderCommandBuffer last_commands = {};
+
+static void null_init()
+{
+    last_commands = make<RenderCommandBuffer>();
+}
+
+static void null_shutdown()
+{
+    free(last_commands);
+}
+
+static void null_submit(const RenderCommandBuffer& commands)
+{
+    render_commands_copy(commands, last_commands);
+}
+
+RenderBackend render_backend_null()
+{
+    RenderBackend backend = {};
+    backend.init     = null_init;
+    backend.shutdown = null_shutdown;
+    backend.submit   = null_submit;
+
+    return backend;
+}
+
+const RenderCommandBuffer& render_backend_null_get_last_commands()
+{
+    return last_commands;
+}
@@ -0,0 +1,430 @@
+#include "render_backend.h"
+
+#include "core/logger.h"
+#include "core/types.h"
+#include "graphics/shader.h"
+#include "graphics/texture.h"
+#include "math/vecs/vector2.h"
+#include "math/vecs/vector3.h"
+#include "platform/platform.h"
+#include "shader_paths.h"
+
+#include <cstddef>
+#include <glad/glad.h>
+
+static s32 active_tex_slots[render_max_texture_count] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+// Quads are streamed through a ring of regions, one frame per region. The gpu can still be reading the
+// last frames while the next one is written, a fence per region says when it's free again. Nothing is
+// uploaded or flushed in the middle of a frame.
+static constexpr u32 stream_region_count     = 3;
+static constexpr u32 stream_start_quad_count = 16384;   // Per region, grows when a frame doesn't fit
+
+// Retained ranges stay in buffers of their own, a range only goes up again when its generation changes
+// or it was pushed out by others. The one drawn longest ago makes room.
+static constexpr u32 retained_buffer_count = 4;
+
+// Stars stay in a buffer of their own and only go up again when a starfield of another generation shows up
+struct StarVertex
+{
+    Vector3 star;
+    Vector2 corner;
+    Vector2 tex_coord;
+};
+
+static struct
+{
+    u32 vao, vbo;
+    Shader shaders[(u32) RenderShader::NUM_SHADERS];
+
+    // Quad stream
+    bool persistent;            // Mapped once for good with buffer storage (GL 4.4), otherwise mapped unsynchronized every frame
+    RenderInstance* mapped;
+    u64 region_quad_count;
+    u32 region;
+    GLsync fences[stream_region_count];
+
+    // Star geometry
+    u32 star_vao, star_vbo, star_ibo;
+    u32 star_generation;
+
+    // Retained ranges, the streams go one after another like in a region
+    u32 retained_vbos[retained_buffer_count];
+    u32 retained_generations[retained_buffer_count];
+    u64 retained_last_frames[retained_buffer_count];
+    u64 frame;
+} gl_data;
+
+static void compile_shader(Shader& shader, char* vert_path, char* frag_path)
+{
+    gn_assert_with_message(
+        shader_compile_from_file(shader, ref(vert_path), Shader::Type::VERTEX),
+        "Failed to compile Vertex Shader! (shader path: %)", vert_path
+    );
+
+    gn_assert_with_message(
+        shader_compile_from_file(shader, ref(frag_path), Shader::Type::FRAGMENT),
+        "Failed to compile Fragment Shader! (shader path: %)", frag_path
+    );
+
+    gn_assert_with_message(
+        shader_link(shader),
+        "Failed to link Shader! (vertex shader path: %, fragment shader path: %)", vert_path, frag_path
+    );
+}
+
+static void wait_for_region(u32 region)
+{
+    GLsync& fence = gl_data.fences[region];
+    if (!fence)
+        return;
+
+    // Only waits if the gpu is a whole ring behind
+    GLbitfield flags = 0;
+    while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+static void create_quad_stream(u64 region_quad_count)
+{
+    const GLsizeiptr size = (GLsizeiptr) (stream_region_count * region_quad_count * sizeof(RenderInstance));
+
+    glGenBuffers(1, &gl_data.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.vbo);
+
+    gl_data.persistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+    if (gl_data.persistent)
+    {
+        // Coherent, so the writes don't need an explicit flush before the draws
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        gl_data.mapped = (RenderInstance*) glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    }
+    else
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+    gl_data.region_quad_count = region_quad_count;
+    gl_data.region = 0;
+}
+
+// The attributes advance once per instance, they're pointed at the first quad of every packet
+static void set_quad_attributes(u64 first_quad)
+{
+    const u64 offset = first_quad * sizeof(RenderInstance);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(RenderInstance), (const void*) (offset + offsetof(RenderInstance, x)));
+    glVertexAttribPointer(1, 2, GL_SHORT, false, sizeof(RenderInstance), (const void*) (offset + offsetof(RenderInstance, width)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_SHORT, true, sizeof(RenderInstance), (const void*) (offset + offsetof(RenderInstance, tex_coords)));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, true, sizeof(RenderInstance), (const void*) (offset + offsetof(RenderInstance, color)));
+    glVertexAttribPointer(4, 1, GL_UNSIGNED_BYTE, false, sizeof(RenderInstance), (const void*) (offset + offsetof(RenderInstance, tex_index)));
+}
+
+static void destroy_quad_stream()
+{
+    for (u32 i = 0; i < stream_region_count; i++)
+        wait_for_region(i);
+
+    if (gl_data.persistent)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, gl_data.vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    glDeleteBuffers(1, &gl_data.vbo);
+
+    gl_data.vbo = 0;
+    gl_data.mapped = nullptr;
+}
+
+static void create_star_buffers()
+{
+    glGenVertexArrays(1, &gl_data.star_vao);
+    glBindVertexArray(gl_data.star_vao);
+
+    glGenBuffers(1, &gl_data.star_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.star_vbo);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(StarVertex), (const void*) offsetof(StarVertex, star));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(StarVertex), (const void*) offsetof(StarVertex, corner));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(StarVertex), (const void*) offsetof(StarVertex, tex_coord));
+
+    // Element buffer binding is part of the vao
+    glGenBuffers(1, &gl_data.star_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_data.star_ibo);
+
+    glBindVertexArray(0);
+}
+
+static void upload_stars(const RenderStarfield& starfield)
+{
+    const u64 count = starfield.star_count;
+
+    StarVertex* vertices = (StarVertex*) platform_allocate(4 * count * sizeof(StarVertex));
+    u32* indices = (u32*) platform_allocate(6 * count * sizeof(u32));
+
+    for (u64 i = 0; i < count; i++)
+    {
+        const RenderStar& star = starfield.stars[i];
+        const Vector3 position = Vector3 { star.x, star.y, star.depth };
+
+        StarVertex* quad = vertices + 4 * i;
+        quad[0] = StarVertex { position, Vector2 { star.left,  star.bottom }, Vector2 { star.tex_coords[0], star.tex_coords[3] } };
+        quad[1] = StarVertex { position, Vector2 { star.right, star.bottom }, Vector2 { star.tex_coords[2], star.tex_coords[3] } };
+        quad[2] = StarVertex { position, Vector2 { star.right, star.top    }, Vector2 { star.tex_coords[2], star.tex_coords[1] } };
+        quad[3] = StarVertex { position, Vector2 { star.left,  star.top    }, Vector2 { star.tex_coords[0], star.tex_coords[1] } };
+
+        const u32 offset = (u32) (4 * i);
+        u32* quad_indices = indices + 6 * i;
+        quad_indices[0] = offset + 0;
+        quad_indices[1] = offset + 1;
+        quad_indices[2] = offset + 2;
+        quad_indices[3] = offset + 2;
+        quad_indices[4] = offset + 3;
+        quad_indices[5] = offset + 0;
+    }
+
+    glBindVertexArray(gl_data.star_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.star_vbo);
+    glBufferData(GL_ARRAY_BUFFER, 4 * count * sizeof(StarVertex), vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * count * sizeof(u32), indices, GL_STATIC_DRAW);
+
+    platform_free(vertices);
+    platform_free(indices);
+
+    gl_data.star_generation = starfield.generation;
+}
+
+static void draw_starfield(const RenderStarfield& starfield)
+{
+    Shader& shader = gl_data.shaders[(u32) RenderShader::STARFIELD];
+
+    if (starfield.generation != gl_data.star_generation)
+        upload_stars(starfield);
+
+    shader_bind(shader);
+    texture_bind(starfield.texture, 0);
+
+    shader_set_uniform_1i(shader, ref("u_texture"), 0);
+    shader_set_uniform_2f(shader, ref("u_playground"), starfield.playground.x, starfield.playground.y);
+    shader_set_uniform_2f(shader, ref("u_parallax"), starfield.parallax.x, starfield.parallax.y);
+    shader_set_uniform_4f(shader, ref("u_transform"), starfield.transform.x, starfield.transform.y, starfield.transform.z, starfield.transform.w);
+    shader_set_uniform_2f(shader, ref("u_screenSize"), starfield.screen_size.x, starfield.screen_size.y);
+    shader_set_uniform_1f(shader, ref("u_z"), starfield.z);
+
+    glBindVertexArray(gl_data.star_vao);
+    glDrawElements(GL_TRIANGLES, 6 * starfield.star_count, GL_UNSIGNED_INT, nullptr);
+
+    // The quad packets after it point their attributes into the stream again
+    glBindVertexArray(gl_data.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.vbo);
+}
+
+// Points the attributes into the stream and draws, the array buffer has to be bound already
+static void draw_quad_packet(const RenderPacket& packet, u64 first_quad)
+{
+    Shader& shader = gl_data.shaders[(u32) packet.shader];
+    shader_bind(shader);
+
+    // Set all textures for the packet
+    for (u32 t = 0; t < packet.texture_count; t++)
+        texture_bind(packet.textures[t], t);
+
+    shader_set_uniform_1iv(shader, ref("u_textures"), packet.texture_count, active_tex_slots);
+
+    // Draw Instances
+    set_quad_attributes(first_quad);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, packet.quad_count);
+}
+
+// Returns the buffer the range is in, uploading it if it isn't there
+static u32 find_retained_buffer(const RenderRetained& retained)
+{
+    u32 buffer = 0;
+    for (u32 i = 0; i < retained_buffer_count; i++)
+    {
+        if (gl_data.retained_generations[i] == retained.generation)
+            return i;
+
+        if (gl_data.retained_last_frames[i] < gl_data.retained_last_frames[buffer])
+            buffer = i;
+    }
+
+    const RenderCommandBuffer& commands = *retained.commands;
+
+    u64 quad_count = 0;
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        quad_count += commands.quads[i].size;
+
+    // Orphaning the old storage, frames still in flight keep drawing from it
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.retained_vbos[buffer]);
+    glBufferData(GL_ARRAY_BUFFER, quad_count * sizeof(RenderInstance), nullptr, GL_STATIC_DRAW);
+
+    u64 offset = 0;
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(RenderInstance), commands.quads[i].size * sizeof(RenderInstance), commands.quads[i].data);
+        offset += commands.quads[i].size;
+    }
+
+    gl_data.retained_generations[buffer] = retained.generation;
+    return buffer;
+}
+
+static void draw_retained(const RenderRetained& retained)
+{
+    const u32 buffer = find_retained_buffer(retained);
+    gl_data.retained_last_frames[buffer] = gl_data.frame;
+
+    const RenderCommandBuffer& commands = *retained.commands;
+
+    u64 stream_offsets[(u32) RenderShader::NUM_SHADERS];
+    stream_offsets[0] = 0;
+    for (u32 i = 1; i < (u32) RenderShader::NUM_SHADERS; i++)
+        stream_offsets[i] = stream_offsets[i - 1] + commands.quads[i - 1].size;
+
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.retained_vbos[buffer]);
+
+    for (u64 i = 0; i < commands.packets.size; i++)
+    {
+        const RenderPacket& packet = commands.packets[i];
+        draw_quad_packet(packet, stream_offsets[(u32) packet.shader] + packet.first_quad);
+    }
+
+    // The packets after it point their attributes into the stream again
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.vbo);
+}
+
+static void opengl_init()
+{
+    glGenVertexArrays(1, &gl_data.vao);
+    glBindVertexArray(gl_data.vao);
+
+    for (u32 i = 0; i < 5; i++)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
+    create_quad_stream(stream_start_quad_count);
+    create_star_buffers();
+    glGenBuffers(retained_buffer_count, gl_data.retained_vbos);
+    gl_data.frame = 1;  // Unused buffers are the ones drawn longest ago
+
+    compile_shader(gl_data.shaders[(u32) RenderShader::QUAD], ui_quad_vert_shader_path, ui_quad_frag_shader_path);
+    compile_shader(gl_data.shaders[(u32) RenderShader::FONT], ui_font_vert_shader_path, ui_font_frag_shader_path);
+    compile_shader(gl_data.shaders[(u32) RenderShader::STARFIELD], starfield_vert_shader_path, starfield_frag_shader_path);
+}
+
+static void opengl_shutdown()
+{
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+    {
+        glDeleteProgram(gl_data.shaders[i].program);
+        free(gl_data.shaders[i].uniforms);
+    }
+
+    destroy_quad_stream();
+    glDeleteVertexArrays(1, &gl_data.vao);
+
+    glDeleteBuffers(1, &gl_data.star_vbo);
+    glDeleteBuffers(1, &gl_data.star_ibo);
+    glDeleteVertexArrays(1, &gl_data.star_vao);
+
+    glDeleteBuffers(retained_buffer_count, gl_data.retained_vbos);
+
+    gl_data = {};
+}
+
+static void opengl_submit(const RenderCommandBuffer& commands)
+{
+    if (commands.packets.size == 0)
+        return;
+
+    u64 quad_count = 0;
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        quad_count += commands.quads[i].size;
+
+    // Only the first frames that draw more than ever before pay for this
+    if (quad_count > gl_data.region_quad_count)
+    {
+        u64 region_quad_count = gl_data.region_quad_count;
+        while (region_quad_count < quad_count)
+            region_quad_count *= 2;
+
+        destroy_quad_stream();
+        create_quad_stream(region_quad_count);
+    }
+
+    gl_data.region = (gl_data.region + 1) % stream_region_count;
+    wait_for_region(gl_data.region);
+
+    const u64 region_offset = gl_data.region * gl_data.region_quad_count;
+
+    glBindVertexArray(gl_data.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, gl_data.vbo);
+
+    {   // Write the frame's quads into its region, the streams go one after another
+        RenderInstance* destination = nullptr;
+        if (gl_data.persistent)
+            destination = gl_data.mapped + region_offset;
+        else
+        {
+            // The fence already says the gpu is done with the region, so there's nothing to synchronize
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+            destination = (RenderInstance*) glMapBufferRange(GL_ARRAY_BUFFER, region_offset * sizeof(RenderInstance), quad_count * sizeof(RenderInstance), flags);
+        }
+
+        for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        {
+            platform_copy_memory(destination, commands.quads[i].data, commands.quads[i].size * sizeof(RenderInstance));
+            destination += commands.quads[i].size;
+        }
+
+        if (!gl_data.persistent)
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    u64 stream_offsets[(u32) RenderShader::NUM_SHADERS];
+    stream_offsets[0] = region_offset;
+    for (u32 i = 1; i < (u32) RenderShader::NUM_SHADERS; i++)
+        stream_offsets[i] = stream_offsets[i - 1] + commands.quads[i - 1].size;
+
+    for (u64 i = 0; i < commands.packets.size; i++)
+    {
+        const RenderPacket& packet = commands.packets[i];
+        if (packet.shader == RenderShader::STARFIELD)
+        {
+            draw_starfield(render_commands_get_starfield(commands, packet));
+            continue;
+        }
+
+        if (packet.shader == RenderShader::RETAINED)
+        {
+            draw_retained(render_commands_get_retained(commands, packet));
+            continue;
+        }
+
+        draw_quad_packet(packet, stream_offsets[(u32) packet.shader] + packet.first_quad);
+    }
+
+    gl_data.frame++;
+
+    gl_data.fences[gl_data.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+RenderBackend render_backend_opengl()
+{
+    RenderBackend backend = {};
+    backend.init     = opengl_init;
+    backend.shutdown = opengl_shutdown;
+    backend.submit   = opengl_submit;
+
+    return backend;
+}
@@ -0,0 +1,53 @@
+#include "render_backend.h"
+
+#include "core/logger.h"
+#include "core/types.h"
+#include "software_rasterizer.h"
+
+static struct
+{
+    u32 width, height;
+    Vector4 clear_color;
+
+    SoftwareRasterizer rasterizer;
+} software_data;
+
+static void software_init()
+{
+    gn_assert_with_message(software_data.width > 0 && software_data.height > 0, "render_backend_software_set_target() was never called!");
+    software_data.rasterizer = make<SoftwareRasterizer>(software_data.width, software_data.height);
+}
+
+static void software_shutdown()
+{
+    free(software_data.rasterizer);
+}
+
+static void software_submit(const RenderCommandBuffer& commands)
+{
+    // Imgui submits once per frame
+    raster_clear(software_data.rasterizer, software_data.clear_color);
+    raster_draw(software_data.rasterizer, commands);
+}
+
+RenderBackend render_backend_software()
+{
+    RenderBackend backend = {};
+    backend.init     = software_init;
+    backend.shutdown = software_shutdown;
+    backend.submit   = software_submit;
+
+    return backend;
+}
+
+void render_backend_software_set_target(u32 width, u32 height, const Vector4& clear_color)
+{
+    software_data.width       = width;
+    software_data.height      = height;
+    software_data.clear_color = clear_color;
+}
+
+const SoftwareRasterizer& render_backend_software_get_rasterizer()
+{
+    return software_data.rasterizer;
+}
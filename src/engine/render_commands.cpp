@@ -0,0 +1,536 @@
+#include "render_commands.h"
+
+#include <cstdio>
+
+#include "core/logger.h"
+#include "core/types.h"
+
+u64 render_hash_bytes(u64 hash, const void* data, u64 size)
+{
+    // FNV-1a
+    const u8* bytes = (const u8*) data;
+    for (u64 i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+RenderCommandBuffer make(Type<RenderCommandBuffer>)
+{
+    RenderCommandBuffer commands = {};
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        commands.quads[i] = make<DynamicArray<RenderInstance>>();
+
+    commands.starfields = make<DynamicArray<RenderStarfield>>();
+    commands.retained   = make<DynamicArray<RenderRetained>>();
+    commands.packets    = make<DynamicArray<RenderPacket>>();
+
+    commands.pushed_quads = make<DynamicArray<RenderInstance>>();
+    commands.pushed_keys  = make<DynamicArray<u64>>();
+
+    for (u32 i = 0; i < 2; i++)
+    {
+        commands.sort_keys[i]    = make<DynamicArray<u64>>();
+        commands.sort_indices[i] = make<DynamicArray<u32>>();
+    }
+
+    return commands;
+}
+
+void free(RenderCommandBuffer& commands)
+{
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        free(commands.quads[i]);
+
+    free(commands.starfields);
+    free(commands.retained);
+    free(commands.packets);
+
+    free(commands.pushed_quads);
+    free(commands.pushed_keys);
+
+    for (u32 i = 0; i < 2; i++)
+    {
+        free(commands.sort_keys[i]);
+        free(commands.sort_indices[i]);
+    }
+
+    commands = {};
+}
+
+void render_commands_clear(RenderCommandBuffer& commands)
+{
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        clear(commands.quads[i]);
+
+    clear(commands.starfields);
+    clear(commands.retained);
+    clear(commands.packets);
+
+    clear(commands.pushed_quads);
+    clear(commands.pushed_keys);
+}
+
+RenderInstance* render_commands_push_quad(RenderCommandBuffer& commands, u64 sort_key)
+{
+    DynamicArray<RenderInstance>& quads = commands.pushed_quads;
+    if (quads.size >= quads.capacity)
+        reserve(quads, max(2 * quads.capacity, 16ull));
+
+    append(commands.pushed_keys, sort_key);
+    return quads.data + quads.size++;
+}
+
+RenderInstance* render_commands_push_quads(RenderCommandBuffer& commands, u64 count, u64*& out_sort_keys)
+{
+    DynamicArray<RenderInstance>& quads = commands.pushed_quads;
+    DynamicArray<u64>& keys = commands.pushed_keys;
+
+    if (quads.size + count > quads.capacity)
+        reserve(quads, max(2 * quads.capacity, quads.size + count));
+
+    if (keys.size + count > keys.capacity)
+        reserve(keys, max(2 * keys.capacity, keys.size + count));
+
+    RenderInstance* first = quads.data + quads.size;
+    out_sort_keys = keys.data + keys.size;
+
+    quads.size += count;
+    keys.size  += count;
+
+    return first;
+}
+
+// Hardly ever more than a few, so they're kept in order as they come
+template <typename T>
+static void insert_by_sort_key(DynamicArray<T>& array, const T& elem)
+{
+    u64 slot = array.size;
+    while (slot > 0 && array[slot - 1].sort_key > elem.sort_key)
+        slot--;
+
+    if (slot == array.size)
+        append(array, elem);
+    else
+        insert(array, slot, elem);
+}
+
+void render_commands_push_starfield(RenderCommandBuffer& commands, const RenderStarfield& starfield)
+{
+    insert_by_sort_key(commands.starfields, starfield);
+}
+
+void render_commands_push_retained(RenderCommandBuffer& commands, const RenderRetained& retained)
+{
+    gn_assert_with_message(retained.commands->starfields.size == 0 && retained.commands->retained.size == 0,
+                           "Retained ranges can only have quads!");
+    gn_assert_with_message(retained.commands->pushed_quads.size == 0, "Retained range was never sorted!");
+
+    insert_by_sort_key(commands.retained, retained);
+}
+
+// Stable merge of neighbouring sorted runs until there's one left
+static void merge_runs(u64*& keys, u32*& indices, u64*& keys_to, u32*& indices_to, u64* run_starts, u32 run_count, u64 count)
+{
+    while (run_count > 1)
+    {
+        u32 merged_count = 0;
+        for (u32 r = 0; r < run_count; r += 2)
+        {
+            const u64 start = run_starts[r];
+            const u64 middle = (r + 1 < run_count) ? run_starts[r + 1] : count;
+            const u64 end = (r + 2 < run_count) ? run_starts[r + 2] : count;
+
+            u64 a = start, b = middle, to = start;
+            while (a < middle && b < end)
+            {
+                // Ties go to the left run so pushed order is kept
+                const bool take_b = keys[b] < keys[a];
+                const u64 from = take_b ? b++ : a++;
+
+                keys_to[to]    = keys[from];
+                indices_to[to] = indices[from];
+                to++;
+            }
+
+            for (; a < middle; a++, to++)
+            {
+                keys_to[to]    = keys[a];
+                indices_to[to] = indices[a];
+            }
+
+            for (; b < end; b++, to++)
+            {
+                keys_to[to]    = keys[b];
+                indices_to[to] = indices[b];
+            }
+
+            run_starts[merged_count++] = start;
+        }
+
+        run_count = merged_count;
+
+        swap(keys, keys_to);
+        swap(indices, indices_to);
+    }
+}
+
+// Imgui code mostly draws back to front, so a frame is usually a few sorted runs (one per block of code that
+// starts over at a bigger z) and merging those is cheaper than a full sort. Anything else goes through a stable
+// LSD radix sort on bytes, where a byte that's the same in every key is skipped (most of the shader and texture ones are).
+static constexpr u32 max_merged_run_count = 16;
+
+static void sort_pushed_quads(RenderCommandBuffer& commands, u64 count, u64*& sorted_keys, u32*& sorted_indices)
+{
+    for (u32 i = 0; i < 2; i++)
+    {
+        reserve(commands.sort_keys[i], count);
+        reserve(commands.sort_indices[i], count);
+    }
+
+    u64* keys       = commands.sort_keys[0].data;
+    u32* indices    = commands.sort_indices[0].data;
+    u64* keys_to    = commands.sort_keys[1].data;
+    u32* indices_to = commands.sort_indices[1].data;
+
+    u64 run_starts[max_merged_run_count];
+    u32 run_count = 1;
+    run_starts[0] = 0;
+
+    for (u64 i = 0; i < count; i++)
+    {
+        keys[i]    = commands.pushed_keys.data[i];
+        indices[i] = (u32) i;
+
+        if (i > 0 && keys[i] < keys[i - 1])
+        {
+            if (run_count < max_merged_run_count)
+                run_starts[run_count] = i;
+
+            run_count++;
+        }
+    }
+
+    if (run_count <= max_merged_run_count)
+    {
+        merge_runs(keys, indices, keys_to, indices_to, run_starts, run_count, count);
+
+        sorted_keys    = keys;
+        sorted_indices = indices;
+        return;
+    }
+
+    // All 8 histograms in one go
+    u32 counts[8][256] = {};
+    for (u64 i = 0; i < count; i++)
+    {
+        for (u32 b = 0; b < 8; b++)
+            counts[b][(keys[i] >> (8 * b)) & 0xFF]++;
+    }
+
+    for (u32 b = 0; b < 8; b++)
+    {
+        if (counts[b][(keys[0] >> (8 * b)) & 0xFF] == count)
+            continue;
+
+        u32 offsets[256];
+        u32 offset = 0;
+        for (u32 d = 0; d < 256; d++)
+        {
+            offsets[d] = offset;
+            offset += counts[b][d];
+        }
+
+        for (u64 i = 0; i < count; i++)
+        {
+            const u32 to = offsets[(keys[i] >> (8 * b)) & 0xFF]++;
+            keys_to[to]    = keys[i];
+            indices_to[to] = indices[i];
+        }
+
+        swap(keys, keys_to);
+        swap(indices, indices_to);
+    }
+
+    sorted_keys    = keys;
+    sorted_indices = indices;
+}
+
+static void append_starfield_packet(RenderCommandBuffer& commands, u64 index)
+{
+    const RenderStarfield& starfield = commands.starfields[index];
+
+    RenderPacket packet = {};
+    packet.sort_key      = starfield.sort_key;
+    packet.shader        = RenderShader::STARFIELD;
+    packet.textures[0]   = starfield.texture;
+    packet.texture_count = 1;
+    packet.first_quad    = (u32) index;
+    packet.quad_count    = starfield.star_count;
+
+    append(commands.packets, packet);
+}
+
+static void append_retained_packet(RenderCommandBuffer& commands, u64 index)
+{
+    const RenderRetained& retained = commands.retained[index];
+
+    RenderPacket packet = {};
+    packet.sort_key   = retained.sort_key;
+    packet.shader     = RenderShader::RETAINED;
+    packet.first_quad = (u32) index;
+
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        packet.quad_count += (u32) retained.commands->quads[i].size;
+
+    append(commands.packets, packet);
+}
+
+// Starfields and retained ranges up to the key, starfields first when the keys are the same
+// Returns true if anything was appended, the quads after it have to start a new packet
+static bool append_blocks_up_to(RenderCommandBuffer& commands, u64 sort_key, u64& next_starfield, u64& next_retained)
+{
+    bool appended = false;
+
+    while (true)
+    {
+        const bool starfield = next_starfield < commands.starfields.size && commands.starfields[next_starfield].sort_key <= sort_key;
+        const bool retained  = next_retained  < commands.retained.size   && commands.retained[next_retained].sort_key   <= sort_key;
+        if (!starfield && !retained)
+            break;
+
+        if (starfield && (!retained || commands.starfields[next_starfield].sort_key <= commands.retained[next_retained].sort_key))
+            append_starfield_packet(commands, next_starfield++);
+        else
+            append_retained_packet(commands, next_retained++);
+
+        appended = true;
+    }
+
+    return appended;
+}
+
+void render_commands_sort(RenderCommandBuffer& commands)
+{
+    const u64 count = commands.pushed_keys.size;
+    if (count == 0 && commands.starfields.size == 0 && commands.retained.size == 0)
+        return;
+
+    u64* keys;
+    u32* indices;
+    sort_pushed_quads(commands, count, keys, indices);
+
+    // Every quad could go to any stream, so nothing has to grow inside the loop
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        reserve(commands.quads[i], commands.quads[i].size + count);
+
+    RenderPacket* packet = nullptr;
+    u32 last_texture_id = 0;
+    u8 last_texture_slot = 0;
+
+    u64 next_starfield = 0;
+    u64 next_retained  = 0;
+
+    for (u64 i = 0; i < count; i++)
+    {
+        if (append_blocks_up_to(commands, keys[i], next_starfield, next_retained))
+            packet = nullptr;
+
+        const RenderShader shader = (RenderShader) ((keys[i] >> 24) & 0xFF);
+        const u32 texture_id = (u32) (keys[i] & 0x00FFFFFFu);
+
+        const bool same_texture = packet && packet->shader == shader && texture_id == last_texture_id;
+        if (!same_texture)
+        {
+            // Texture search only when the texture changes, which is once per run of quads after sorting
+            u32 slot = packet ? packet->texture_count : 0;
+            if (packet && packet->shader == shader)
+            {
+                for (u32 t = 0; t < packet->texture_count; t++)
+                {
+                    if (packet->textures[t].id == texture_id)
+                    {
+                        slot = t;
+                        break;
+                    }
+                }
+            }
+
+            if (!packet || packet->shader != shader || slot >= render_max_texture_count)
+            {
+                RenderPacket new_packet = {};
+                new_packet.sort_key   = keys[i];
+                new_packet.shader     = shader;
+                new_packet.first_quad = (u32) commands.quads[(u32) shader].size;
+
+                append(commands.packets, new_packet);
+                packet = &commands.packets[commands.packets.size - 1];
+                slot = 0;
+            }
+
+            if (slot == packet->texture_count)
+                packet->textures[packet->texture_count++] = Texture { texture_id };
+
+            last_texture_id   = texture_id;
+            last_texture_slot = (u8) slot;
+        }
+
+        DynamicArray<RenderInstance>& quads = commands.quads[(u32) shader];
+        RenderInstance& quad = quads.data[quads.size++];
+
+        quad = commands.pushed_quads.data[indices[i]];
+        quad.tex_index = last_texture_slot;
+
+        packet->quad_count++;
+    }
+
+    append_blocks_up_to(commands, ~0ull, next_starfield, next_retained);
+
+    clear(commands.pushed_quads);
+    clear(commands.pushed_keys);
+}
+
+const RenderInstance* render_commands_get_quads(const RenderCommandBuffer& commands, const RenderPacket& packet)
+{
+    gn_assert_with_message(packet.shader != RenderShader::STARFIELD && packet.shader != RenderShader::RETAINED,
+                           "Packet has no quads of its own! (shader: %)", (u32) packet.shader);
+    return commands.quads[(u32) packet.shader].data + packet.first_quad;
+}
+
+const RenderStarfield& render_commands_get_starfield(const RenderCommandBuffer& commands, const RenderPacket& packet)
+{
+    gn_assert_with_message(packet.shader == RenderShader::STARFIELD, "Packet isn't a starfield! (shader: %)", (u32) packet.shader);
+    return commands.starfields[packet.first_quad];
+}
+
+const RenderRetained& render_commands_get_retained(const RenderCommandBuffer& commands, const RenderPacket& packet)
+{
+    gn_assert_with_message(packet.shader == RenderShader::RETAINED, "Packet isn't a retained range! (shader: %)", (u32) packet.shader);
+    return commands.retained[packet.first_quad];
+}
+
+void render_commands_copy(const RenderCommandBuffer& from, RenderCommandBuffer& to)
+{
+    render_commands_clear(to);
+    for (u32 i = 0; i < (u32) RenderShader::NUM_SHADERS; i++)
+        append_many(to.quads[i], from.quads[i].data, from.quads[i].size);
+
+    append_many(to.starfields, from.starfields.data, from.starfields.size);
+    append_many(to.retained, from.retained.data, from.retained.size);
+    append_many(to.packets, from.packets.data, from.packets.size);
+}
+
+static u64 hash_packets(u64 hash, const RenderCommandBuffer& commands)
+{
+    for (u64 i = 0; i < commands.packets.size; i++)
+    {
+        const RenderPacket& packet = commands.packets[i];
+
+        hash = render_hash_bytes(hash, &packet.shader, sizeof(packet.shader));
+        hash = render_hash_bytes(hash, &packet.quad_count, sizeof(packet.quad_count));
+
+        for (u32 t = 0; t < packet.texture_count; t++)
+        {
+            const String name = texture_get_name(packet.textures[t]);
+            hash = render_hash_bytes(hash, name.data, name.size);
+        }
+
+        if (packet.shader == RenderShader::STARFIELD)
+        {
+            // Everything that decides where the stars end up, the pointer and the generation don't
+            const RenderStarfield& starfield = render_commands_get_starfield(commands, packet);
+            hash = render_hash_bytes(hash, starfield.stars, (u64) starfield.star_count * sizeof(RenderStar));
+            hash = render_hash_bytes(hash, &starfield.playground, sizeof(starfield.playground));
+            hash = render_hash_bytes(hash, &starfield.parallax, sizeof(starfield.parallax));
+            hash = render_hash_bytes(hash, &starfield.transform, sizeof(starfield.transform));
+            hash = render_hash_bytes(hash, &starfield.screen_size, sizeof(starfield.screen_size));
+            hash = render_hash_bytes(hash, &starfield.z, sizeof(starfield.z));
+            continue;
+        }
+
+        if (packet.shader == RenderShader::RETAINED)
+        {
+            hash = hash_packets(hash, *render_commands_get_retained(commands, packet).commands);
+            continue;
+        }
+
+        // Imgui zeroes the padding, so the instances can go in as they are
+        hash = render_hash_bytes(hash, render_commands_get_quads(commands, packet), (u64) packet.quad_count * sizeof(RenderInstance));
+    }
+
+    return hash;
+}
+
+u64 render_commands_hash(const RenderCommandBuffer& commands)
+{
+    return hash_packets(render_hash_seed, commands);
+}
+
+// Packets of a retained range go one level further in
+static void save_packets(FILE* file, const RenderCommandBuffer& commands, const char* indent)
+{
+    static const char* shader_names[(u32) RenderShader::NUM_SHADERS] = { "quad", "font", "starfield", "retained" };
+
+    for (u64 i = 0; i < commands.packets.size; i++)
+    {
+        const RenderPacket& packet = commands.packets[i];
+
+        fprintf(file, "%spacket %llu: key %016llx, shader %s, quads %u\n", indent, i, packet.sort_key, shader_names[(u32) packet.shader], packet.quad_count);
+        for (u32 t = 0; t < packet.texture_count; t++)
+        {
+            const String name = texture_get_name(packet.textures[t]);
+            fprintf(file, "%s    texture %u: %.*s\n", indent, t, (int) name.size, name.data);
+        }
+
+        if (packet.shader == RenderShader::STARFIELD)
+        {
+            const RenderStarfield& starfield = render_commands_get_starfield(commands, packet);
+            fprintf(file, "%s    playground %g %g | parallax %g %g | transform %g %g %g %g | screen %g %g | z %g\n", indent,
+                    starfield.playground.x, starfield.playground.y, starfield.parallax.x, starfield.parallax.y,
+                    starfield.transform.x, starfield.transform.y, starfield.transform.z, starfield.transform.w,
+                    starfield.screen_size.x, starfield.screen_size.y, starfield.z);
+
+            for (u32 q = 0; q < starfield.star_count; q++)
+            {
+                const RenderStar& star = starfield.stars[q];
+                fprintf(file, "%s    %g %g %g | %g %g %g %g | %g %g %g %g\n", indent, star.x, star.y, star.depth, star.left, star.top, star.right, star.bottom,
+                        star.tex_coords[0], star.tex_coords[1], star.tex_coords[2], star.tex_coords[3]);
+            }
+
+            continue;
+        }
+
+        if (packet.shader == RenderShader::RETAINED)
+        {
+            save_packets(file, *render_commands_get_retained(commands, packet).commands, "    ");
+            continue;
+        }
+
+        const RenderInstance* quads = render_commands_get_quads(commands, packet);
+        for (u32 q = 0; q < packet.quad_count; q++)
+        {
+            const RenderInstance& quad = quads[q];
+            fprintf(file, "%s    %g %g %g | %d %d | %u %u %u %u | %08x | %u\n", indent,
+                    quad.x, quad.y, quad.z, quad.width, quad.height,
+                    quad.tex_coords[0], quad.tex_coords[1], quad.tex_coords[2], quad.tex_coords[3], quad.color, quad.tex_index);
+        }
+    }
+}
+
+bool render_commands_save(const RenderCommandBuffer& commands, const String filepath)
+{
+    FILE* file = fopen(filepath.data, "w");
+    if (!file)
+    {
+        gn_warn("Couldn't open render commands file! (filepath: %)", filepath);
+        return false;
+    }
+
+    save_packets(file, commands, "");
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <emmintrin.h>
+
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/common.h"
+#include "core/compiler_utils.h"
+#include "core/types.h"
+#include "graphics/texture.h"
+#include "math/common.h"
+#include "math/vecs/vector2.h"
+#include "math/vecs/vector4.h"
+
+// Render command buffer
+// Imgui doesn't draw anything itself, it records a frame as packets (shader, textures and a range of quads)
+// and hands the whole buffer to a RenderBackend at Imgui::end. Everything before that is plain CPU work,
+// so it runs and can be measured without a GPU, and two builds can be compared by the commands they recorded.
+// Quads are pushed in any order with a sort key and render_commands_sort turns them into packets. Every shader has
+// its own stream of sorted quads and a packet is a range of it, so packets have no size limit. A new packet only
+// starts when the shader changes or a quad needs an 11th texture.
+// Star backgrounds are pushed whole with a sort key of their own and end up as a packet of their own in between.
+// So are retained ranges, quads that were sorted into a command buffer of their own once and are drawn again as they are.
+
+static constexpr u32 render_max_texture_count = 10;
+
+// Sizes are stored in 1/8192 of clip space, so up to 4 times the screen either way
+static constexpr f32 render_size_scale = 8192.0f;
+
+// One per quad, the vertex shader makes the corners.
+// The corner at the origin has tex coords (s, v), the one at origin + size has (u, t).
+struct RenderInstance
+{
+    f32 x, y, z;        // Clip space
+    s16 width, height;  // Clip space times render_size_scale, negative both ways for a quad turned around
+    u16 tex_coords[4];  // s, t, u, v in 0 to 65535
+    u32 color;          // RGBA8, red in the lowest byte
+    u8 tex_index;       // Into the textures of the packet
+    u8 padding[3];
+};
+
+static_assert(sizeof(RenderInstance) == 32, "RenderInstance should stay 32 bytes!");
+
+enum struct RenderShader : u8
+{
+    QUAD,
+    FONT,
+    STARFIELD,
+    RETAINED,       // Not a shader, the packets of a retained range use the ones above
+
+    NUM_SHADERS
+};
+
+// One star of a background, in the playground (0 to 1) with y down and the depth in z (0 is the nearest)
+// Plain floats, so there's no padding in the way of hashing them.
+struct RenderStar
+{
+    f32 x, y, depth;
+    f32 left, top, right, bottom;       // Corners relative to the star in playground units
+    f32 tex_coords[4];                  // Left, top, right, bottom
+};
+
+// Stars stay where they are in the playground, the shader moves every one of them by (1 - depth^2) times the
+// parallax and takes it to the screen the way Imgui would.
+struct RenderStarfield
+{
+    u64 sort_key;
+
+    const RenderStar* stars;    // Owned by whoever pushed them, they have to outlive the frame
+    u32 star_count;
+    u32 generation;             // Changes whenever the stars do, backends keeping a copy only update it then
+    Texture texture;
+
+    Vector2 playground;
+    Vector2 parallax;
+    Vector4 transform;          // Scale (xy) and offset (zw) from playground to screen units
+    Vector2 screen_size;
+    f32 z;
+};
+
+struct RenderCommandBuffer;
+
+// Quads that were pushed and sorted into a buffer of their own, the backend draws its packets as one block
+// Nothing else should be drawn at the keys between its first and last one, they'd end up before or after the block.
+struct RenderRetained
+{
+    u64 sort_key;                           // Of its first packet
+
+    const RenderCommandBuffer* commands;    // Owned by whoever pushed it, it has to outlive the frame
+    u32 generation;                         // Changes whenever the quads do, backends keeping a copy only update it then
+};
+
+// Smaller keys are drawn first, quads with the same key in the order they were pushed.
+// Depth (back to front) is the top half, since the depth test is on and transparent texels still write depth
+// a quad drawn in front of another one too early would cut holes into it. Below that are the shader and the
+// texture, so quads at the same depth end up together.
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+u64 render_make_sort_key(f32 z, RenderShader shader, const Texture& texture)
+{
+    // Float bits made to sort like the floats do, then flipped so the biggest z comes first
+    u32 depth = (u32) _mm_cvtsi128_si32(_mm_castps_si128(_mm_set_ss(z)));
+    depth = (depth & 0x80000000u) ? ~depth : (depth | 0x80000000u);
+    depth = ~depth;
+
+    return ((u64) depth << 32) | ((u64) shader << 24) | (texture.id & 0x00FFFFFFu);
+}
+
+struct RenderPacket
+{
+    u64 sort_key;   // Of the first quad, backends draw packets in the order they're in
+    RenderShader shader;
+
+    Texture textures[render_max_texture_count];
+    u32 texture_count;
+
+    // Instances in the stream of the shader, for STARFIELD the index of the starfield and its star count,
+    // for RETAINED the index of the range and its quad count
+    u32 first_quad;
+    u32 quad_count;
+};
+
+struct RenderCommandBuffer
+{
+    DynamicArray<RenderInstance> quads[(u32) RenderShader::NUM_SHADERS];   // The STARFIELD and RETAINED ones stay empty
+    DynamicArray<RenderStarfield> starfields;   // By sort key
+    DynamicArray<RenderRetained> retained;      // By sort key
+    DynamicArray<RenderPacket> packets;
+
+    // Pushed this frame, not sorted yet
+    DynamicArray<RenderInstance> pushed_quads;
+    DynamicArray<u64> pushed_keys;
+
+    // Sort scratch, kept so a frame doesn't allocate
+    DynamicArray<u64> sort_keys[2];
+    DynamicArray<u32> sort_indices[2];
+};
+
+RenderCommandBuffer make(Type<RenderCommandBuffer>);
+void free(RenderCommandBuffer& commands);
+
+void render_commands_clear(RenderCommandBuffer& commands);
+
+// Room for one quad, valid until the next push. The texture index is filled in by render_commands_sort.
+RenderInstance* render_commands_push_quad(RenderCommandBuffer& commands, u64 sort_key);
+
+// Room for count quads in a row, their sort keys go in out_sort_keys. Both are valid until the next push.
+RenderInstance* render_commands_push_quads(RenderCommandBuffer& commands, u64 count, u64*& out_sort_keys);
+
+// Drawn before the quads with the same sort key
+void render_commands_push_starfield(RenderCommandBuffer& commands, const RenderStarfield& starfield);
+
+// Same for a sorted buffer, it can't have starfields or retained ranges of its own
+void render_commands_push_retained(RenderCommandBuffer& commands, const RenderRetained& retained);
+
+// Sorts the pushed quads into packets, the pushed ones are gone afterwards
+void render_commands_sort(RenderCommandBuffer& commands);
+
+const RenderInstance* render_commands_get_quads(const RenderCommandBuffer& commands, const RenderPacket& packet);
+const RenderStarfield& render_commands_get_starfield(const RenderCommandBuffer& commands, const RenderPacket& packet);
+const RenderRetained& render_commands_get_retained(const RenderCommandBuffer& commands, const RenderPacket& packet);
+
+void render_commands_copy(const RenderCommandBuffer& from, RenderCommandBuffer& to);
+
+// Textures go in by name so the hash doesn't depend on the order they were loaded in
+u64 render_commands_hash(const RenderCommandBuffer& commands);
+
+// Same hash for anything else a frame produces, start from the seed and keep feeding the result back in
+static constexpr u64 render_hash_seed = 0xcbf29ce484222325ull;
+u64 render_hash_bytes(u64 hash, const void* data, u64 size);
+
+// Readable dump to diff between builds, returns false if the file couldn't be opened
+bool render_commands_save(const RenderCommandBuffer& commands, const String filepath);
+
+// Packing for RenderInstance, everything is clamped to what fits
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+u32 render_pack_color(const Vector4& color)
+{
+    const __m128i channels = _mm_cvtps_epi32(_mm_mul_ps(color._sse, _mm_set1_ps(255.0f)));
+    const __m128i words    = _mm_packs_epi32(channels, channels);
+    return (u32) _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+Vector4 render_unpack_color(u32 color)
+{
+    const __m128i channels = _mm_cvtepu8_epi32(_mm_cvtsi32_si128((s32) color));
+    return Vector4 { _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(1.0f / 255.0f)) };
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+s16 render_pack_size(f32 size)
+{
+    return (s16) clamp(Math::floor(size * render_size_scale + 0.5f), -32767.0f, 32767.0f);
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+u16 render_pack_tex_coord(f32 tex_coord)
+{
+    return (u16) clamp(Math::floor(tex_coord * 65535.0f + 0.5f), 0.0f, 65535.0f);
+}
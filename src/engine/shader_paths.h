@@ -19,4 +19,7 @@ constexpr char* voxel_vert_shader_path = "assets/shaders/voxel.vert.glsl";
 constexpr char* voxel_frag_shader_path = "assets/shaders/voxel.frag.glsl";
 
 constexpr char* skybox_vert_shader_path = "assets/shaders/skybox.vert.glsl";
-constexpr char* skybox_frag_shader_path = "assets/shaders/skybox.frag.glsl";
\ No newline at end of file
+constexpr char* skybox_frag_shader_path = "assets/shaders/skybox.frag.glsl";
+
+constexpr char* starfield_vert_shader_path = "assets/shaders/starfield.vert.glsl";
+constexpr char* starfield_frag_shader_path = "assets/shaders/starfield.frag.glsl";
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include "software_rasterizer.h"
+
+#include <smmintrin.h>
+#include <xmmintrin.h>
+
+#include "containers/bytes.h"
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "fileio/fileio.h"
+#include "graphics/texture.h"
+#include "math/common.h"
+#include "math/constants.h"
+#include "platform/platform.h"
+#include "miniz.h"
+
+#if defined(GN_COMPILER_MSVC)
+    #include <intrin.h>
+#endif
+
+// Textures without a CPU copy (GPU builds) are sampled as white
+static const u32 white_texel = 0xFFFFFFFF;
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static u32 lowest_set_bit(u32 bits)
+{
+#if defined(GN_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (u32) index;
+#else
+    return (u32) __builtin_ctz(bits);
+#endif
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static __m128 unpack_rgba8(u32 pixel)
+{
+    return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128((s32) pixel)));
+}
+
+// Rounds to the nearest value like OpenGL does when writing to a unorm buffer, clamping to [0, 255]
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static u32 pack_rgba8(__m128 rgba)
+{
+    const __m128i channels = _mm_cvtps_epi32(rgba);
+    const __m128i words    = _mm_packus_epi32(channels, channels);
+    return (u32) _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static s32 wrap(s32 value, s32 size)
+{
+    // Repeat wrapping, like the default TextureSettings
+    const s32 result = value % size;
+    return (result < 0) ? result + size : result;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static u32 sample_nearest(const RasterTexture& texture, f32 u, f32 v)
+{
+    const s32 x = wrap((s32) Math::floor(u * texture.width),  texture.width);
+    const s32 y = wrap((s32) Math::floor(v * texture.height), texture.height);
+
+    return texture.texels[(s64) y * texture.width + x];
+}
+
+// Median of the channels of a multi channel distance field, 0 to 1
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static f32 sample_distance(const RasterTexture& texture, f32 u, f32 v)
+{
+    const u32 texel = sample_nearest(texture, u, v);
+
+    const f32 r = (f32) ((texel >>  0) & 0xFF);
+    const f32 g = (f32) ((texel >>  8) & 0xFF);
+    const f32 b = (f32) ((texel >> 16) & 0xFF);
+
+    return max(min(r, g), min(max(r, g), b)) * (1.0f / 255.0f);
+}
+
+static const RasterTexture& get_texture(SoftwareRasterizer& rasterizer, const Texture& texture)
+{
+    while (rasterizer.textures.size <= texture.id)
+        append(rasterizer.textures, RasterTexture {});
+
+    RasterTexture& result = rasterizer.textures[texture.id];
+
+    const u8* pixels = texture_get_pixels(texture);
+    if (!pixels)
+    {
+        result.texels = &white_texel;
+        result.width = result.height = 1;
+        return result;
+    }
+
+    const s32 width    = texture_get_width(texture);
+    const s32 height   = texture_get_height(texture);
+    const s32 bytes_pp = texture_get_bytes_pp(texture);
+
+    result.width  = width;
+    result.height = height;
+
+    if (bytes_pp == 4)
+    {
+        result.texels = (const u32*) pixels;
+        return result;
+    }
+
+    if (result.source != pixels)
+    {
+        const u64 texel_count = (u64) width * height;
+        result.converted = (u32*) platform_reallocate(result.converted, texel_count * sizeof(u32));
+        result.source    = pixels;
+
+        // Same expansion as OpenGL, missing color channels are 0 and a missing alpha is 1
+        for (u64 i = 0; i < texel_count; i++)
+        {
+            const u8* texel = pixels + i * bytes_pp;
+
+            switch (bytes_pp)
+            {
+                case 1:  result.converted[i] = texel[0] | 0xFF000000; break;
+                case 3:  result.converted[i] = texel[0] | (texel[1] << 8) | (texel[2] << 16) | 0xFF000000; break;
+                default: gn_assert_with_message(false, "Bytes per pixel value is not currently supported! (bytes per pixel: %)", bytes_pp); break;
+            }
+        }
+    }
+
+    result.texels = result.converted;
+    return result;
+}
+
+// Returns false for quads OpenGL wouldn't draw (back facing, outside the depth range or off screen)
+// Corners are in clip space, the origin (x0, y0) is at (s, v) of the texture and the opposite corner (x1, y1) at (u, t)
+static bool setup_rect(const SoftwareRasterizer& rasterizer, f32 x0, f32 y0, f32 x1, f32 y1, f32 z,
+                       f32 tex_s, f32 tex_t, f32 tex_u, f32 tex_v, RasterQuad& quad)
+{
+    // Back facing ones are flipped one way only
+    if ((x1 - x0) * (y1 - y0) <= 0.0f)
+        return false;
+
+    quad.z = z;
+    if (quad.z < -1.0f || quad.z >= 1.0f)
+        return false;
+
+    // Flipped quads (both ways) still face the front, the texture is mirrored in both directions
+    const bool flip = x1 < x0;
+
+    const f32 clip_left   = flip ? x1 : x0;
+    const f32 clip_right  = flip ? x0 : x1;
+    const f32 clip_top    = flip ? y0 : y1;
+    const f32 clip_bottom = flip ? y1 : y0;
+
+    const f32 u_left   = flip ? tex_u : tex_s;
+    const f32 u_right  = flip ? tex_s : tex_u;
+    const f32 v_top    = flip ? tex_v : tex_t;
+    const f32 v_bottom = flip ? tex_t : tex_v;
+
+    const f32 left   = (clip_left  + 1.0f) * 0.5f * rasterizer.width;
+    const f32 right  = (clip_right + 1.0f) * 0.5f * rasterizer.width;
+    const f32 top    = (1.0f - clip_top)    * 0.5f * rasterizer.height;
+    const f32 bottom = (1.0f - clip_bottom) * 0.5f * rasterizer.height;
+
+    // Pixels whose centers are inside
+    quad.min_x = max((s32) Math::ceil(left   - 0.5f), 0);
+    quad.max_x = min((s32) Math::ceil(right  - 0.5f), (s32) rasterizer.width);
+    quad.min_y = max((s32) Math::ceil(top    - 0.5f), 0);
+    quad.max_y = min((s32) Math::ceil(bottom - 0.5f), (s32) rasterizer.height);
+
+    if (quad.min_x >= quad.max_x || quad.min_y >= quad.max_y)
+        return false;
+
+    quad.u_step   = (u_right - u_left) / (right - left);
+    quad.u_origin = u_left - left * quad.u_step;
+    quad.v_step   = (v_bottom - v_top) / (bottom - top);
+    quad.v_origin = v_top - top * quad.v_step;
+
+    return true;
+}
+
+static bool setup_quad(const SoftwareRasterizer& rasterizer, const RenderInstance& instance, RasterQuad& quad)
+{
+    // Same corners as the quad vertex shader
+    const f32 x0 = instance.x;
+    const f32 y0 = instance.y;
+    const f32 x1 = instance.x + instance.width  / render_size_scale;
+    const f32 y1 = instance.y + instance.height / render_size_scale;
+
+    if (!setup_rect(rasterizer, x0, y0, x1, y1, instance.z, instance.tex_coords[0] / 65535.0f, instance.tex_coords[1] / 65535.0f,
+                    instance.tex_coords[2] / 65535.0f, instance.tex_coords[3] / 65535.0f, quad))
+        return false;
+
+    quad.color = render_unpack_color(instance.color);
+    return true;
+}
+
+static bool setup_star(const SoftwareRasterizer& rasterizer, const RenderStarfield& starfield, const RenderStar& star, RasterQuad& quad)
+{
+    // Same as the starfield vertex shader, from the playground to screen units and then to clip space (y up)
+    const f32 parallax = 1.0f - star.depth * star.depth;
+    const f32 x = starfield.playground.x * star.x + parallax * starfield.parallax.x;
+    const f32 y = starfield.playground.y * star.y + parallax * starfield.parallax.y;
+
+    const f32 left   = starfield.transform.x * (x + star.left)   + starfield.transform.z;
+    const f32 right  = starfield.transform.x * (x + star.right)  + starfield.transform.z;
+    const f32 top    = starfield.transform.y * (y + star.top)    + starfield.transform.w;
+    const f32 bottom = starfield.transform.y * (y + star.bottom) + starfield.transform.w;
+
+    const f32 clip_left   = 2.0f * (left   / starfield.screen_size.x) - 1.0f;
+    const f32 clip_right  = 2.0f * (right  / starfield.screen_size.x) - 1.0f;
+    const f32 clip_top    = 1.0f - 2.0f * (top    / starfield.screen_size.y);
+    const f32 clip_bottom = 1.0f - 2.0f * (bottom / starfield.screen_size.y);
+
+    // The first vertex is the bottom left corner (playground units are y down)
+    if (!setup_rect(rasterizer, clip_left, clip_bottom, clip_right, clip_top, starfield.z,
+                    star.tex_coords[0], star.tex_coords[1], star.tex_coords[2], star.tex_coords[3], quad))
+        return false;
+
+    // The starfield shader doesn't tint
+    quad.color = Vector4 { 1.0f, 1.0f, 1.0f, 1.0f };
+    return true;
+}
+
+static void bin_quad(SoftwareRasterizer& rasterizer, const RasterQuad& quad)
+{
+    const u32 quad_index = (u32) rasterizer.quads.size;
+    append(rasterizer.quads, quad);
+
+    const u32 first_tile_x = quad.min_x / raster_tile_size;
+    const u32 last_tile_x  = (quad.max_x - 1) / raster_tile_size;
+    const u32 first_tile_y = quad.min_y / raster_tile_size;
+    const u32 last_tile_y  = (quad.max_y - 1) / raster_tile_size;
+
+    for (u32 tile_y = first_tile_y; tile_y <= last_tile_y; tile_y++)
+    {
+        for (u32 tile_x = first_tile_x; tile_x <= last_tile_x; tile_x++)
+            append(rasterizer.tile_quads[tile_y * rasterizer.tile_count_x + tile_x], quad_index);
+    }
+}
+
+// Retained ranges are binned where they are, in the order of their own packets
+static void bin_packets(SoftwareRasterizer& rasterizer, const RenderCommandBuffer& commands)
+{
+    for (u64 p = 0; p < commands.packets.size; p++)
+    {
+        const RenderPacket& packet = commands.packets[p];
+        if (packet.shader == RenderShader::RETAINED)
+        {
+            bin_packets(rasterizer, *render_commands_get_retained(commands, packet).commands);
+            continue;
+        }
+
+        // Done once per packet, the spans only read them
+        for (u32 t = 0; t < packet.texture_count; t++)
+            get_texture(rasterizer, packet.textures[t]);
+
+        if (packet.shader == RenderShader::STARFIELD)
+        {
+            const RenderStarfield& starfield = render_commands_get_starfield(commands, packet);
+            for (u32 s = 0; s < starfield.star_count; s++)
+            {
+                RasterQuad quad;
+                if (!setup_star(rasterizer, starfield, starfield.stars[s], quad))
+                    continue;
+
+                quad.shader = packet.shader;
+                quad.texture_id = starfield.texture.id;
+
+                bin_quad(rasterizer, quad);
+            }
+
+            continue;
+        }
+
+        const RenderInstance* instances = render_commands_get_quads(commands, packet);
+        for (u32 q = 0; q < packet.quad_count; q++)
+        {
+            const RenderInstance& instance = instances[q];
+
+            RasterQuad quad;
+            if (!setup_quad(rasterizer, instance, quad))
+                continue;
+
+            quad.shader = packet.shader;
+            quad.texture_id = packet.textures[instance.tex_index].id;
+
+            bin_quad(rasterizer, quad);
+        }
+    }
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void blend_pixel(u32& pixel, __m128 source)
+{
+    // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) on every channel, the source is clamped first
+    source = _mm_min_ps(_mm_max_ps(source, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+
+    const __m128 alpha     = _mm_mul_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(1.0f / 255.0f));
+    const __m128 inv_alpha = _mm_sub_ps(_mm_set1_ps(1.0f), alpha);
+
+    const __m128 destination = unpack_rgba8(pixel);
+    pixel = pack_rgba8(_mm_add_ps(_mm_mul_ps(source, alpha), _mm_mul_ps(destination, inv_alpha)));
+}
+
+// One row of a quad inside a tile, 4 pixels at a time
+static void fill_span(SoftwareRasterizer& rasterizer, const RasterQuad& quad, const RasterTexture& texture, s32 y, s32 start_x, s32 end_x)
+{
+    u32* color_row = rasterizer.color + (u64) y * rasterizer.width;
+    f32* depth_row = rasterizer.depth + (u64) y * rasterizer.width;
+
+    const f32 v = quad.v_origin + (y + 0.5f) * quad.v_step;
+
+    const __m128 lane_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 u_origin = _mm_set1_ps(quad.u_origin);
+    const __m128 u_step   = _mm_set1_ps(quad.u_step);
+    const __m128 z        = _mm_set1_ps(quad.z);
+
+    // Blending works in 0 to 255, texels already are
+    const __m128 color = _mm_mul_ps(quad.color._sse, _mm_set1_ps(255.0f));
+
+    for (s32 x = start_x; x < end_x; x += 4)
+    {
+        const s32 count = min(end_x - x, 4);
+
+        // Lanes past the end never pass the depth test (pixels there might belong to another tile)
+        __m128 depth;
+        if (count == 4)
+            depth = _mm_loadu_ps(depth_row + x);
+        else
+        {
+            alignas(16) f32 partial[4] = { -Math::infinity, -Math::infinity, -Math::infinity, -Math::infinity };
+            for (s32 i = 0; i < count; i++)
+                partial[i] = depth_row[x + i];
+
+            depth = _mm_load_ps(partial);
+        }
+
+        u32 mask = (u32) _mm_movemask_ps(_mm_cmplt_ps(z, depth));
+        if (mask == 0)
+            continue;
+
+        alignas(16) f32 u[4];
+        _mm_store_ps(u, _mm_add_ps(u_origin, _mm_mul_ps(_mm_add_ps(_mm_set1_ps((f32) x), lane_offsets), u_step)));
+
+        while (mask)
+        {
+            const u32 lane = lowest_set_bit(mask);
+            mask &= mask - 1;
+
+            u32& pixel = color_row[x + lane];
+            depth_row[x + lane] = quad.z;
+
+            if (quad.shader == RenderShader::FONT)
+            {
+                // fwidth from the neighbouring pixels, like the font shader's derivatives
+                const f32 distance   = sample_distance(texture, u[lane], v);
+                const f32 distance_x = sample_distance(texture, u[lane] + quad.u_step, v);
+                const f32 distance_y = sample_distance(texture, u[lane], v + quad.v_step);
+                const f32 width = Math::abs(distance_x - distance) + Math::abs(distance_y - distance);
+
+                f32 alpha = (distance >= 0.5f) ? 1.0f : 0.0f;
+                if (width > 0.0f)
+                {
+                    const f32 t = clamp((distance - 0.5f + width) / (2.0f * width), 0.0f, 1.0f);
+                    alpha = t * t * (3.0f - 2.0f * t);
+                }
+
+                const __m128 source = _mm_mul_ps(color, _mm_setr_ps(1.0f, 1.0f, 1.0f, alpha));
+                blend_pixel(pixel, source);
+            }
+            else
+            {
+                // Sprites are mostly transparent texels, blending those leaves the pixel as it was
+                const u32 texel = sample_nearest(texture, u[lane], v);
+                if ((texel >> 24) == 0)
+                    continue;
+
+                blend_pixel(pixel, _mm_mul_ps(unpack_rgba8(texel), quad.color._sse));
+            }
+        }
+    }
+}
+
+static void fill_tile(SoftwareRasterizer& rasterizer, u64 tile)
+{
+    const s32 tile_x = (s32) (tile % rasterizer.tile_count_x) * raster_tile_size;
+    const s32 tile_y = (s32) (tile / rasterizer.tile_count_x) * raster_tile_size;
+
+    const DynamicArray<u32>& quad_indices = rasterizer.tile_quads[tile];
+    for (u64 i = 0; i < quad_indices.size; i++)
+    {
+        const RasterQuad& quad = rasterizer.quads[quad_indices[i]];
+        const RasterTexture& texture = rasterizer.textures[quad.texture_id];
+
+        const s32 start_x = max(quad.min_x, tile_x);
+        const s32 end_x   = min(quad.max_x, tile_x + (s32) raster_tile_size);
+        const s32 start_y = max(quad.min_y, tile_y);
+        const s32 end_y   = min(quad.max_y, tile_y + (s32) raster_tile_size);
+
+        for (s32 y = start_y; y < end_y; y++)
+            fill_span(rasterizer, quad, texture, y, start_x, end_x);
+    }
+}
+
+SoftwareRasterizer make(Type<SoftwareRasterizer>, u32 width, u32 height)
+{
+    gn_assert_with_message(width > 0 && height > 0, "Rasterizer needs at least one pixel! (width: %, height: %)", width, height);
+
+    SoftwareRasterizer rasterizer = {};
+    rasterizer.width  = width;
+    rasterizer.height = height;
+    rasterizer.color  = (u32*) platform_allocate((u64) width * height * sizeof(u32));
+    rasterizer.depth  = (f32*) platform_allocate((u64) width * height * sizeof(f32));
+
+    rasterizer.tile_count_x = (width  + raster_tile_size - 1) / raster_tile_size;
+    rasterizer.tile_count_y = (height + raster_tile_size - 1) / raster_tile_size;
+
+    const u64 tile_count = (u64) rasterizer.tile_count_x * rasterizer.tile_count_y;
+    rasterizer.tile_quads = (DynamicArray<u32>*) platform_allocate(tile_count * sizeof(DynamicArray<u32>));
+    for (u64 i = 0; i < tile_count; i++)
+        rasterizer.tile_quads[i] = make<DynamicArray<u32>>();
+
+    rasterizer.quads    = make<DynamicArray<RasterQuad>>();
+    rasterizer.textures = make<DynamicArray<RasterTexture>>();
+
+    raster_clear(rasterizer, Vector4 { 0.0f, 0.0f, 0.0f, 0.0f });
+
+    return rasterizer;
+}
+
+void free(SoftwareRasterizer& rasterizer)
+{
+    const u64 tile_count = (u64) rasterizer.tile_count_x * rasterizer.tile_count_y;
+    for (u64 i = 0; i < tile_count; i++)
+        free(rasterizer.tile_quads[i]);
+
+    for (u64 i = 0; i < rasterizer.textures.size; i++)
+        platform_free(rasterizer.textures[i].converted);
+
+    platform_free(rasterizer.tile_quads);
+    platform_free(rasterizer.color);
+    platform_free(rasterizer.depth);
+    free(rasterizer.quads);
+    free(rasterizer.textures);
+
+    rasterizer = {};
+}
+
+void raster_clear(SoftwareRasterizer& rasterizer, const Vector4& color)
+{
+    const u32 clear_color = pack_rgba8(_mm_mul_ps(color._sse, _mm_set1_ps(255.0f)));
+
+    const u64 pixel_count = (u64) rasterizer.width * rasterizer.height;
+    for (u64 i = 0; i < pixel_count; i++)
+    {
+        rasterizer.color[i] = clear_color;
+        rasterizer.depth[i] = 1.0f;
+    }
+}
+
+void raster_draw(SoftwareRasterizer& rasterizer, const RenderCommandBuffer& commands)
+{
+    const u64 tile_count = (u64) rasterizer.tile_count_x * rasterizer.tile_count_y;
+    for (u64 i = 0; i < tile_count; i++)
+        clear(rasterizer.tile_quads[i]);
+
+    clear(rasterizer.quads);
+
+    // Setup and Binning
+    bin_packets(rasterizer, commands);
+
+    // Tiles never share pixels
+    Jobs::parallel_for(tile_count, 1, [&](u64 start, u64 end)
+    {
+        for (u64 tile = start; tile < end; tile++)
+            fill_tile(rasterizer, tile);
+    });
+}
+
+u64 raster_hash(const SoftwareRasterizer& rasterizer)
+{
+    return render_hash_bytes(render_hash_seed, rasterizer.color, (u64) rasterizer.width * rasterizer.height * sizeof(u32));
+}
+
+bool raster_save_png(const SoftwareRasterizer& rasterizer, const String filepath)
+{
+    // Alpha is dropped like it is for the window, a cleared pixel is usually transparent
+    const u64 pixel_count = (u64) rasterizer.width * rasterizer.height;
+    u8* rgb = (u8*) platform_allocate(3 * pixel_count);
+    for (u64 i = 0; i < pixel_count; i++)
+    {
+        const u32 pixel = rasterizer.color[i];
+        rgb[3 * i + 0] = (u8) pixel;
+        rgb[3 * i + 1] = (u8) (pixel >> 8);
+        rgb[3 * i + 2] = (u8) (pixel >> 16);
+    }
+
+    size_t size = 0;
+    void* png = tdefl_write_image_to_png_file_in_memory(rgb, (int) rasterizer.width, (int) rasterizer.height, 3, &size);
+    platform_free(rgb);
+
+    if (!png)
+    {
+        gn_warn("Couldn't encode the rasterized image! (filepath: %)", filepath);
+        return false;
+    }
+
+    // The bundled miniz writes the low byte of the height over the high one, put the IHDR height back and redo its crc
+    u8* header = (u8*) png;
+    header[20] = (u8) (rasterizer.height >> 24);
+    header[21] = (u8) (rasterizer.height >> 16);
+    header[22] = (u8) (rasterizer.height >> 8);
+    header[23] = (u8) rasterizer.height;
+
+    u32 crc = (u32) mz_crc32(MZ_CRC32_INIT, header + 12, 17);
+    for (u32 i = 0; i < 4; i++)
+        header[29 + i] = (u8) (crc >> (24 - 8 * i));
+
+    file_write_bytes(filepath, Bytes { (u8*) png, (u64) size });
+    mz_free(png);
+
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/common.h"
+#include "core/types.h"
+#include "math/vecs/vector4.h"
+#include "render_commands.h"
+
+// CPU rasterizer for the render command buffer
+// Draws the quads and starfields the OpenGL backend would (textured, tinted, alpha blended and depth tested, distance field
+// alpha for the font shader) into an RGBA8 image, so frames can be looked at and compared without a GPU.
+// The image is split into tiles and every quad is binned into the tiles it touches, tiles are then filled
+// in parallel with each one going through its quads in submission order, so the result doesn't depend on the thread count.
+// Imgui only makes axis aligned quads, anything else isn't supported. Textures are always sampled as nearest.
+
+static constexpr u32 raster_tile_size = 64;
+
+// Setup of a quad in pixels, top row first
+struct RasterQuad
+{
+    s32 min_x, min_y, max_x, max_y;     // Covered pixels, max is exclusive
+
+    // At pixel coordinate 0 (the pixel edge, not the center) and per pixel
+    f32 u_origin, u_step;
+    f32 v_origin, v_step;
+
+    f32 z;
+    Vector4 color;
+
+    u32 texture_id;
+    RenderShader shader;
+};
+
+// RGBA8 texels of a texture, bottom row first
+struct RasterTexture
+{
+    const u32* texels;
+    s32 width, height;
+
+    // Converted copy for textures that aren't RGBA8, made again if the texture's pixels change
+    u32* converted;
+    const u8* source;
+};
+
+struct SoftwareRasterizer
+{
+    u32 width, height;
+    u32* color;     // RGBA8, top row first
+    f32* depth;
+
+    u32 tile_count_x, tile_count_y;
+    DynamicArray<u32>* tile_quads;      // Indices into quads, in submission order
+
+    DynamicArray<RasterQuad> quads;
+    DynamicArray<RasterTexture> textures;   // By texture id
+};
+
+SoftwareRasterizer make(Type<SoftwareRasterizer>, u32 width, u32 height);
+void free(SoftwareRasterizer& rasterizer);
+
+// Also resets the depth, like glClear with both buffers
+void raster_clear(SoftwareRasterizer& rasterizer, const Vector4& color);
+
+// Draws on top of what's there already
+void raster_draw(SoftwareRasterizer& rasterizer, const RenderCommandBuffer& commands);
+
+u64 raster_hash(const SoftwareRasterizer& rasterizer);
+
+// Returns false if the image couldn't be encoded
+bool raster_save_png(const SoftwareRasterizer& rasterizer, const String filepath);
@@ -1,5 +1,7 @@
 #include "sprite.h"
 
+#include <smmintrin.h>
+
 #include "containers/darray.h"
 #include "containers/string.h"
 #include "graphics/texture.h"
@@ -46,9 +48,163 @@ void animation_step_instance(const Animation2D& animation, Animation2D::Instance
     }
 }
 
+void animation_build_frame_tables(const DynamicArray<Animation2D>& anims, AnimationFrameTables& tables)
+{
+    clear(tables.frame_rates);
+    clear(tables.cycle_lengths);
+    clear(tables.cycle_offsets);
+    clear(tables.last_frames);
+    clear(tables.stops);
+    clear(tables.frames);
+
+    for (u64 i = 0; i < anims.size; i++)
+    {
+        const Animation2D& animation = anims[i];
+        const u32 frame_count = (u32) animation.sprites.size;
+
+        append(tables.frame_rates, animation.frame_rate);
+        append(tables.cycle_offsets, (u32) tables.frames.size);
+        append(tables.last_frames, frame_count - 1);
+        append(tables.stops, (u8) (animation.loop_type == Animation2D::LoopType::NONE));
+
+        for (u32 frame = 0; frame < frame_count; frame++)
+            append(tables.frames, frame);
+
+        if (animation.loop_type == Animation2D::LoopType::PING_PONG)
+        {
+            for (u32 frame = frame_count; frame > 0; frame--)
+                append(tables.frames, frame - 1);
+        }
+
+        append(tables.cycle_lengths, (f32) (tables.frames.size - tables.cycle_offsets[i]));
+    }
+}
+
+// Same steps as a lane of animation_step_run, for runs too short to fill one
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void animation_step_single(const AnimationFrameTables& tables, u64 animation, Animation2D::Instance& instance, f32 time)
+{
+    const f32 cycle_length  = tables.cycle_lengths.data[animation];
+    const f32 frames_passed = Math::floor((time - instance.start_time) / tables.frame_rates.data[animation]);
+    const f32 loops = Math::floor(frames_passed / cycle_length);
+    const s32 loop_count = (s32) loops;
+    const s32 cycle_step = (s32) (frames_passed - loops * cycle_length);
+
+    const u32* frames = tables.frames.data + tables.cycle_offsets.data[animation];
+
+    if (tables.stops.data[animation])
+    {
+        const bool stopped = loop_count > 0;
+        instance.current_frame_index = stopped ? tables.last_frames.data[animation] : frames[cycle_step];
+        instance.loop_count = (u32) stopped;
+    }
+    else
+    {
+        instance.current_frame_index = frames[cycle_step];
+        instance.loop_count = (u32) loop_count;
+    }
+}
+
+// Steps a run of instances that all use the same animation
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void animation_step_run(const AnimationFrameTables& tables, u64 animation, u8* instance_bytes, u64 stride, u64 count, f32 time)
+{
+    const __m128 times         = _mm_set1_ps(time);
+    const __m128 frame_rates   = _mm_set1_ps(tables.frame_rates.data[animation]);
+    const __m128 cycle_lengths = _mm_set1_ps(tables.cycle_lengths.data[animation]);
+
+    const u32* frames = tables.frames.data + tables.cycle_offsets.data[animation];
+    const u32 last_frame = tables.last_frames.data[animation];
+    const bool stops = tables.stops.data[animation];
+
+    for (u64 i = 0; i < count; i += 4)
+    {
+        // The last lanes repeat the last item when the run isn't a multiple of 4, stepping it twice gives the same result
+        u8* lane_bytes[4];
+        lane_bytes[0] = instance_bytes + i * stride;
+        lane_bytes[1] = i + 1 < count ? lane_bytes[0] + stride : lane_bytes[0];
+        lane_bytes[2] = i + 2 < count ? lane_bytes[1] + stride : lane_bytes[1];
+        lane_bytes[3] = i + 3 < count ? lane_bytes[2] + stride : lane_bytes[2];
+
+        Animation2D::Instance* lane_instances[4] = {
+            (Animation2D::Instance*) lane_bytes[0], (Animation2D::Instance*) lane_bytes[1],
+            (Animation2D::Instance*) lane_bytes[2], (Animation2D::Instance*) lane_bytes[3]
+        };
+
+        const __m128 start_times = _mm_setr_ps(lane_instances[0]->start_time, lane_instances[1]->start_time,
+                                               lane_instances[2]->start_time, lane_instances[3]->start_time);
+
+        // A division (like animation_step_instance) instead of a multiply by the reciprocal, so frames change on exactly the same ticks
+        // The frame counts are small integers so dividing them by the cycle length in floats is exact
+        const __m128 frames_passed = _mm_floor_ps(_mm_div_ps(_mm_sub_ps(times, start_times), frame_rates));
+        const __m128 loops = _mm_floor_ps(_mm_div_ps(frames_passed, cycle_lengths));
+        const __m128 steps = _mm_sub_ps(frames_passed, _mm_mul_ps(loops, cycle_lengths));
+
+        alignas(16) s32 loop_counts[4];
+        alignas(16) s32 cycle_steps[4];
+        _mm_store_si128((__m128i*) loop_counts, _mm_cvttps_epi32(loops));
+        _mm_store_si128((__m128i*) cycle_steps, _mm_cvttps_epi32(steps));
+
+        if (stops)
+        {
+            for (u64 lane = 0; lane < 4; lane++)
+            {
+                const bool stopped = loop_counts[lane] > 0;
+                lane_instances[lane]->current_frame_index = stopped ? last_frame : frames[cycle_steps[lane]];
+                lane_instances[lane]->loop_count = (u32) stopped;
+            }
+        }
+        else
+        {
+            for (u64 lane = 0; lane < 4; lane++)
+            {
+                lane_instances[lane]->current_frame_index = frames[cycle_steps[lane]];
+                lane_instances[lane]->loop_count = (u32) loop_counts[lane];
+            }
+        }
+    }
+}
+
+void animation_step_batch(const AnimationFrameTables& tables, const u64* animation_indices, Animation2D::Instance* instances,
+                          u64 stride, u64 count, f32 time)
+{
+    const u8* index_bytes = (const u8*) animation_indices;
+    u8* instance_bytes = (u8*) instances;
+
+    // Entities of the same kind are usually next to each other, so the instances are stepped in runs of the same animation
+    u64 run_start = 0;
+    while (run_start < count)
+    {
+        const u64 animation = *(const u64*) (index_bytes + run_start * stride);
+
+        u64 run_end = run_start + 1;
+        while (run_end < count && *(const u64*) (index_bytes + run_end * stride) == animation)
+            run_end++;
+
+        if (run_end - run_start < 4)
+        {
+            for (u64 i = run_start; i < run_end; i++)
+                animation_step_single(tables, animation, *(Animation2D::Instance*) (instance_bytes + i * stride), time);
+        }
+        else
+            animation_step_run(tables, animation, instance_bytes + run_start * stride, stride, run_end - run_start, time);
+        run_start = run_end;
+    }
+}
+
 void free(Animation2D& animation)
 {
     // Atlas has to be freed separately
     free(animation.sprites);
     free(animation.name);
+}
+
+void free(AnimationFrameTables& tables)
+{
+    free(tables.frame_rates);
+    free(tables.cycle_lengths);
+    free(tables.cycle_offsets);
+    free(tables.last_frames);
+    free(tables.stops);
+    free(tables.frames);
 }
\ No newline at end of file
@@ -41,4 +41,27 @@ struct Animation2D
 void animation_start_instance(Animation2D::Instance& instance, f32 time);
 void animation_step_instance(const Animation2D& animation, Animation2D::Instance& instance, f32 time);
 
-void free(Animation2D& animation);
\ No newline at end of file
+// Every animation flattened into arrays so many instances can be stepped at once
+// A cycle is the run of frames until an animation repeats (there and back for ping pong)
+// and frames holds the frame index of every step of every cycle.
+struct AnimationFrameTables
+{
+    DynamicArray<f32> frame_rates;      // Seconds per frame
+    DynamicArray<f32> cycle_lengths;
+    DynamicArray<u32> cycle_offsets;    // Start of each animation's cycle in frames
+    DynamicArray<u32> last_frames;
+    DynamicArray<u8>  stops;            // Stays on the last frame after one cycle (LoopType::NONE)
+    DynamicArray<u32> frames;
+};
+
+// Rebuild whenever the animations change
+void animation_build_frame_tables(const DynamicArray<Animation2D>& anims, AnimationFrameTables& tables);
+
+// Same results as calling animation_step_instance on each instance, four at a time
+// Instances can be interleaved with other data, stride is the distance in bytes from one item to the next
+// for both the animation indices and the instances.
+void animation_step_batch(const AnimationFrameTables& tables, const u64* animation_indices, Animation2D::Instance* instances,
+                          u64 stride, u64 count, f32 time);
+
+void free(Animation2D& animation);
+void free(AnimationFrameTables& tables);
\ No newline at end of file
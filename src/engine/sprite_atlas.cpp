@@ -0,0 +1,397 @@
+#include "sprite_atlas.h"
+
+#include <cstdio>
+
+#include "core/logger.h"
+#include "math/common.h"
+#include "platform/platform.h"
+#include "render_commands.h"
+
+// A run of the packed outline at the same height, the runs cover the whole page width from left to right
+struct SkylineNode
+{
+    s32 x, y, width;
+};
+
+SpriteAtlas make(Type<SpriteAtlas>)
+{
+    SpriteAtlas atlas = {};
+    atlas.images = make<DynamicArray<SpriteAtlas::Image>>();
+    atlas.pages  = make<DynamicArray<Texture>>(4ull);
+
+    return atlas;
+}
+
+void free(SpriteAtlas& atlas)
+{
+    for (u64 i = 0; i < atlas.images.size; i++)
+        platform_free(atlas.images[i].pixels);
+
+    for (u64 i = 0; i < atlas.pages.size; i++)
+        free(atlas.pages[i]);
+
+    free(atlas.images);
+    free(atlas.pages);
+}
+
+u32 sprite_atlas_add_texture(SpriteAtlas& atlas, const Texture& texture)
+{
+    gn_assert_with_message(atlas.pages.size == 0, "Textures can't be added to an atlas that was already packed!");
+
+    for (u64 i = 0; i < atlas.images.size; i++)
+    {
+        if (atlas.images[i].source.id == texture.id)
+            return (u32) i;
+    }
+
+    SpriteAtlas::Image image = {};
+    image.source = texture;
+    image.width  = texture_get_width(texture);
+    image.height = texture_get_height(texture);
+
+    gn_assert_with_message(image.width + 2 * sprite_atlas_padding <= sprite_atlas_page_size && image.height + 2 * sprite_atlas_padding <= sprite_atlas_page_size,
+                           "Texture doesn't fit in an atlas page! (texture: %, width: %, height: %)", texture_get_name(texture), image.width, image.height);
+
+    {   // Copy the pixels as RGBA8, the same values the shaders would sample
+        const s32 bytes_pp    = texture_get_bytes_pp(texture);
+        const u64 pixel_count = (u64) image.width * image.height;
+
+        u8* source = (u8*) platform_allocate(pixel_count * bytes_pp);
+        texture_read_pixels(texture, source);
+
+        image.pixels = (u8*) platform_allocate(pixel_count * 4);
+        for (u64 p = 0; p < pixel_count; p++)
+        {
+            const u8* texel = source + p * bytes_pp;
+            u8* pixel = image.pixels + p * 4;
+
+            pixel[0] = texel[0];
+            pixel[1] = (bytes_pp >= 3) ? texel[1] : 0;
+            pixel[2] = (bytes_pp >= 3) ? texel[2] : 0;
+            pixel[3] = (bytes_pp == 4) ? texel[3] : 0xFF;
+        }
+
+        platform_free(source);
+    }
+
+    image.hash = render_hash_seed;
+    image.hash = render_hash_bytes(image.hash, &image.width, sizeof(image.width));
+    image.hash = render_hash_bytes(image.hash, &image.height, sizeof(image.height));
+    image.hash = render_hash_bytes(image.hash, image.pixels, (u64) image.width * image.height * 4);
+
+    append(atlas.images, image);
+    return (u32) (atlas.images.size - 1);
+}
+
+void sprite_atlas_add_animations(SpriteAtlas& atlas, const DynamicArray<Animation2D>& anims)
+{
+    for (u64 i = 0; i < anims.size; i++)
+    {
+        for (u64 s = 0; s < anims[i].sprites.size; s++)
+            sprite_atlas_add_texture(atlas, anims[i].sprites[s].atlas);
+    }
+}
+
+// Lowest spot the rect fits in, ties go to the leftmost one
+static bool skyline_find(const DynamicArray<SkylineNode>& skyline, s32 width, s32 height, u64& out_node, s32& out_x, s32& out_y)
+{
+    bool found = false;
+    s32 best_top = sprite_atlas_page_size + 1;
+
+    for (u64 i = 0; i < skyline.size; i++)
+    {
+        const s32 x = skyline[i].x;
+        if (x + width > sprite_atlas_page_size)
+            break;
+
+        // Rests on the highest run under it
+        s32 y = 0;
+        s32 remaining = width;
+        for (u64 r = i; remaining > 0; r++)
+        {
+            y = max(y, skyline[r].y);
+            remaining -= skyline[r].width;
+        }
+
+        if (y + height <= sprite_atlas_page_size && y + height < best_top)
+        {
+            found    = true;
+            best_top = y + height;
+            out_node = i;
+            out_x    = x;
+            out_y    = y;
+        }
+    }
+
+    return found;
+}
+
+static void skyline_insert(DynamicArray<SkylineNode>& skyline, u64 node, s32 x, s32 y, s32 width, s32 height)
+{
+    insert(skyline, node, SkylineNode { x, y + height, width });
+
+    {   // Cut the runs the rect covers
+        const s32 right = x + width;
+
+        u64 i = node + 1;
+        while (i < skyline.size && skyline[i].x < right)
+        {
+            const s32 run_right = skyline[i].x + skyline[i].width;
+            if (run_right <= right)
+            {
+                remove(skyline, i);
+                continue;
+            }
+
+            skyline[i].x     = right;
+            skyline[i].width = run_right - right;
+            break;
+        }
+    }
+
+    {   // Merge neighbouring runs at the same height
+        u64 i = 0;
+        while (i + 1 < skyline.size)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                remove(skyline, i + 1);
+            }
+            else
+                i++;
+        }
+    }
+}
+
+// Returns the page count
+static u32 pack_images(SpriteAtlas& atlas)
+{
+    DynamicArray<u32> order = make<DynamicArray<u32>>(atlas.images.size + 1);
+    DynamicArray<DynamicArray<SkylineNode>> skylines = make<DynamicArray<DynamicArray<SkylineNode>>>(4ull);
+
+    {   // Tallest first, the layout has to come out the same for the same images
+        for (u32 i = 0; i < atlas.images.size; i++)
+        {
+            u64 slot = order.size;
+            while (slot > 0)
+            {
+                const SpriteAtlas::Image& image = atlas.images[i];
+                const SpriteAtlas::Image& other = atlas.images[order[slot - 1]];
+                if (other.height > image.height || (other.height == image.height && other.width >= image.width))
+                    break;
+
+                slot--;
+            }
+
+            // Inserting at the end isn't allowed
+            if (slot == order.size)
+                append(order, i);
+            else
+                insert(order, slot, i);
+        }
+    }
+
+    for (u64 i = 0; i < order.size; i++)
+    {
+        SpriteAtlas::Image& image = atlas.images[order[i]];
+
+        const s32 width  = image.width  + 2 * sprite_atlas_padding;
+        const s32 height = image.height + 2 * sprite_atlas_padding;
+
+        u64 node = 0;
+        s32 x = 0, y = 0;
+
+        u32 page = 0;
+        while (page < skylines.size && !skyline_find(skylines[page], width, height, node, x, y))
+            page++;
+
+        if (page == skylines.size)
+        {
+            DynamicArray<SkylineNode> skyline = make<DynamicArray<SkylineNode>>();
+            append(skyline, SkylineNode { 0, 0, sprite_atlas_page_size });
+            append(skylines, skyline);
+
+            skyline_find(skylines[page], width, height, node, x, y);
+        }
+
+        skyline_insert(skylines[page], node, x, y, width, height);
+
+        image.page = page;
+        image.x    = x + sprite_atlas_padding;
+        image.y    = y + sprite_atlas_padding;
+    }
+
+    const u32 page_count = (u32) skylines.size;
+
+    free_all(skylines);
+    free(order);
+
+    return page_count;
+}
+
+// Every image has to be there in the same order with the same hash, anything else means packing again
+static bool load_layout(SpriteAtlas& atlas, const String cache_path, u32& out_page_count)
+{
+    FILE* file = fopen(cache_path.data, "r");
+    if (!file)
+        return false;
+
+    s32 page_size, padding;
+    u64 image_count;
+    bool valid = fscanf(file, "sprite_atlas %d %d %llu %u\n", &page_size, &padding, (unsigned long long*) &image_count, &out_page_count) == 4 &&
+                 page_size == sprite_atlas_page_size && padding == sprite_atlas_padding && image_count == atlas.images.size;
+
+    for (u64 i = 0; valid && i < atlas.images.size; i++)
+    {
+        SpriteAtlas::Image& image = atlas.images[i];
+
+        u64 hash;
+        s32 width, height;
+        valid = fscanf(file, "%llx %d %d %u %d %d\n", (unsigned long long*) &hash, &width, &height, &image.page, &image.x, &image.y) == 6 &&
+                hash == image.hash && width == image.width && height == image.height &&
+                image.page < out_page_count && image.x >= 0 && image.y >= 0 &&
+                image.x + image.width <= sprite_atlas_page_size && image.y + image.height <= sprite_atlas_page_size;
+    }
+
+    fclose(file);
+    return valid;
+}
+
+static void save_layout(const SpriteAtlas& atlas, const String cache_path, u32 page_count)
+{
+    {   // Make the directory the cache goes in
+        char directory[256];
+        u64 length = 0;
+        for (u64 i = 0; i < cache_path.size && i < sizeof(directory); i++)
+        {
+            if (cache_path.data[i] == '/' || cache_path.data[i] == '\\')
+                length = i;
+        }
+
+        if (length > 0)
+        {
+            platform_copy_memory(directory, cache_path.data, length);
+            directory[length] = '\0';
+
+            platform_create_directory(directory);
+        }
+    }
+
+    FILE* file = fopen(cache_path.data, "w");
+    if (!file)
+    {
+        gn_warn("Couldn't open sprite atlas cache file! (filepath: %)", cache_path);
+        return;
+    }
+
+    fprintf(file, "sprite_atlas %d %d %llu %u\n", sprite_atlas_page_size, sprite_atlas_padding, (unsigned long long) atlas.images.size, page_count);
+
+    for (u64 i = 0; i < atlas.images.size; i++)
+    {
+        const SpriteAtlas::Image& image = atlas.images[i];
+        fprintf(file, "%016llx %d %d %u %d %d\n", (unsigned long long) image.hash, image.width, image.height, image.page, image.x, image.y);
+    }
+
+    fclose(file);
+}
+
+bool sprite_atlas_pack(SpriteAtlas& atlas, const String cache_path)
+{
+    gn_assert_with_message(atlas.pages.size == 0, "Sprite atlas was already packed!");
+
+    u32 page_count = 0;
+    const bool cached = load_layout(atlas, cache_path, page_count);
+    if (!cached)
+    {
+        page_count = pack_images(atlas);
+        save_layout(atlas, cache_path, page_count);
+    }
+
+    const u64 page_bytes = (u64) sprite_atlas_page_size * sprite_atlas_page_size * 4;
+    u8* pixels = (u8*) platform_allocate(page_bytes);
+
+    for (u32 page = 0; page < page_count; page++)
+    {
+        platform_set_memory(pixels, 0, page_bytes);
+
+        for (u64 i = 0; i < atlas.images.size; i++)
+        {
+            const SpriteAtlas::Image& image = atlas.images[i];
+            if (image.page != page)
+                continue;
+
+            // Padding included, the rows and columns past the edges repeat the edge texels
+            for (s32 y = -sprite_atlas_padding; y < image.height + sprite_atlas_padding; y++)
+            {
+                const s32 source_y = clamp(y, 0, image.height - 1);
+                const u32* source  = (const u32*) image.pixels + (u64) source_y * image.width;
+                u32* destination   = (u32*) pixels + (u64) (image.y + y) * sprite_atlas_page_size + image.x;
+
+                for (s32 x = -sprite_atlas_padding; x < image.width + sprite_atlas_padding; x++)
+                    destination[x] = source[clamp(x, 0, image.width - 1)];
+            }
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "Sprite Atlas Page %u", page);
+
+        append(atlas.pages, texture_load_pixels(ref(name), pixels, sprite_atlas_page_size, sprite_atlas_page_size, 4, TextureSettings::defaults()));
+    }
+
+    platform_free(pixels);
+
+    for (u64 i = 0; i < atlas.images.size; i++)
+    {
+        platform_free(atlas.images[i].pixels);
+        atlas.images[i].pixels = nullptr;
+    }
+
+    return cached;
+}
+
+bool sprite_atlas_remap(const SpriteAtlas& atlas, Texture& texture, Vector4& tex_coords)
+{
+    gn_assert_with_message(atlas.pages.size > 0, "Sprite atlas has to be packed before anything is remapped to it!");
+
+    for (u64 i = 0; i < atlas.images.size; i++)
+    {
+        const SpriteAtlas::Image& image = atlas.images[i];
+        if (image.source.id != texture.id)
+            continue;
+
+        const f32 scale = 1.0f / (f32) sprite_atlas_page_size;
+        const Vector4 origin = Vector4 { (f32) image.x, (f32) image.y, (f32) image.x, (f32) image.y } * scale;
+        const Vector4 size   = Vector4 { (f32) image.width, (f32) image.height, (f32) image.width, (f32) image.height } * scale;
+
+        texture    = atlas.pages[image.page];
+        tex_coords = origin + tex_coords * size;
+
+        return true;
+    }
+
+    return false;
+}
+
+void sprite_atlas_remap_animations(const SpriteAtlas& atlas, DynamicArray<Animation2D>& anims)
+{
+    for (u64 i = 0; i < anims.size; i++)
+    {
+        for (u64 s = 0; s < anims[i].sprites.size; s++)
+        {
+            Sprite& sprite = anims[i].sprites[s];
+            sprite_atlas_remap(atlas, sprite.atlas, sprite.tex_coords.v4);
+        }
+    }
+}
+
+void sprite_atlas_free_source(SpriteAtlas& atlas, Texture& texture)
+{
+    for (u64 i = 0; i < atlas.images.size; i++)
+    {
+        if (atlas.images[i].source.id == texture.id)
+            atlas.images[i].source = {};
+    }
+
+    free(texture);
+}
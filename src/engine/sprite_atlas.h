@@ -0,0 +1,57 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/types.h"
+#include "graphics/texture.h"
+#include "math/vecs/vector4.h"
+#include "sprite.h"
+
+// Shared pages for sprite sheets, font atlases and anything else drawn through Imgui
+// Textures are added first and packed all at once with a skyline packer, after that anything pointing into one
+// of them can be remapped to its page. Sprites and text from the same page can go into the same packet, so a
+// whole frame only needs a packet per shader.
+// The layout is cached in a file keyed by a hash of every texture, a later start with the same textures reads
+// it back instead of packing again. The cache lives outside the assets so the game never writes into them.
+
+static constexpr s32 sprite_atlas_page_size = 1024;
+static constexpr s32 sprite_atlas_padding   = 1;    // Edge texels are repeated around every image so neighbours never bleed in
+
+static constexpr char sprite_atlas_cache_path[] = "cache/sprite_atlas.layout";
+
+struct SpriteAtlas
+{
+    struct Image
+    {
+        Texture source;
+        u64 hash;           // Of the size and pixels
+        s32 width, height;
+        u8* pixels;         // RGBA8 copy, bottom row first, released once the pages are made
+
+        u32 page;
+        s32 x, y;           // Bottom left corner in the page
+    };
+
+    DynamicArray<Image>   images;
+    DynamicArray<Texture> pages;
+};
+
+SpriteAtlas make(Type<SpriteAtlas>);
+void free(SpriteAtlas& atlas);
+
+// Adding a texture twice adds it once, returns the index of its image
+u32 sprite_atlas_add_texture(SpriteAtlas& atlas, const Texture& texture);
+void sprite_atlas_add_animations(SpriteAtlas& atlas, const DynamicArray<Animation2D>& anims);
+
+// Makes the pages, returns true if the layout came from the cache
+// The directory the cache is in is made if it isn't there.
+bool sprite_atlas_pack(SpriteAtlas& atlas, const String cache_path);
+
+// Points texture and tex_coords (left, top, right, bottom) into the page of the texture's image
+// Returns false and leaves them alone if the texture isn't in the atlas, so remapping twice is harmless.
+bool sprite_atlas_remap(const SpriteAtlas& atlas, Texture& texture, Vector4& tex_coords);
+void sprite_atlas_remap_animations(const SpriteAtlas& atlas, DynamicArray<Animation2D>& anims);
+
+// Frees a texture that was packed, once everything drawing from it was remapped to its page
+// Its image forgets it too, so a texture that gets the same id later isn't remapped by mistake.
+void sprite_atlas_free_source(SpriteAtlas& atlas, Texture& texture);
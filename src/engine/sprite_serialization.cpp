@@ -24,26 +24,38 @@ static Animation2D::LoopType get_loop_type_from_string(const String type_string)
     return type;
 }
 
-bool animation_load_from_json(const Json::Document& document, DynamicArray<Animation2D>& anims)
+String animation_get_atlas_path(const Json::Document& document)
 {
     const auto& j_data = document.start();
 
-    String filename;
+    StringBuilder builder = make<StringBuilder>(3ull);
 
-    {   // Get filename
-        StringBuilder builder = make<StringBuilder>(3Ui64);
+    append(builder, j_data[ref("directory")].string());
+    append(builder, ref("/", 1));
+    append(builder, j_data[ref("file")].string());
+    append(builder, ref("", 1));    // null terminator
 
-        append(builder, j_data[ref("directory")].string());
-        append(builder, ref("\\", 1));
-        append(builder, j_data[ref("file")].string());
-        append(builder, ref("", 1));    // null terminator
+    String filename = build_string(builder);
 
-        filename = build_string(builder);
+    free(builder);
 
-        free(builder);
+    // The exporter writes windows paths, forward slashes work everywhere
+    for (u64 i = 0; i < filename.size; i++)
+    {
+        if (filename[i] == '\\')
+            filename[i] = '/';
     }
 
-    Texture atlas = texture_load_file(filename, TextureSettings::default());
+    return filename;
+}
+
+bool animation_load_from_json(const Json::Document& document, DynamicArray<Animation2D>& anims)
+{
+    const auto& j_data = document.start();
+
+    String filename = animation_get_atlas_path(document);
+
+    Texture atlas = texture_load_file(filename, TextureSettings::defaults());
 
     // Load Animations
     const Json::Array& j_animations = j_data[ref("animations")].array();
@@ -4,4 +4,6 @@
 #include "serialization/json.h"
 #include "sprite.h"
 
+// Path of the sprite sheet texture, free it when done
+String animation_get_atlas_path(const Json::Document& document);
 bool animation_load_from_json(const Json::Document& document, DynamicArray<Animation2D>& anims);
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "starfield.h"
+
+#include "core/logger.h"
+#include "core/types.h"
+
+// Shared by every starfield so a generation is never seen twice, even across starfields
+static u32 next_generation = 1;
+
+Starfield make(Type<Starfield>)
+{
+    Starfield starfield = {};
+    starfield.stars = make<DynamicArray<RenderStar>>();
+
+    return starfield;
+}
+
+void free(Starfield& starfield)
+{
+    free(starfield.stars);
+    starfield = {};
+}
+
+void starfield_upload(Starfield& starfield, const Vector3* positions, const u64* sprite_indices, u64 count, const Animation2D& sprites)
+{
+    gn_assert_with_message(count * 4 <= 0xFFFFFFFFull, "Too many stars for 32 bit indices! (star count: %)", count);
+    gn_assert_with_message(sprites.sprites.size > 0, "Stars need at least one sprite!");
+
+    clear(starfield.stars);
+    reserve(starfield.stars, count);
+
+    for (u64 i = 0; i < count; i++)
+    {
+        const Sprite& sprite = sprites.sprites[sprite_indices[i]];
+        const Vector4 tex_coords = sprite.tex_coords.v4;
+
+        // Same corners as Imgui::render_sprite, relative to the star
+        RenderStar star;
+        star.x      = positions[i].x;
+        star.y      = positions[i].y;
+        star.depth  = positions[i].z;
+        star.left   = -sprite.size.x * sprite.pivot.x;
+        star.right  =  sprite.size.x * (1.0f - sprite.pivot.x);
+        star.top    = -sprite.size.y * (1.0f - sprite.pivot.y);
+        star.bottom =  sprite.size.y * sprite.pivot.y;
+
+        star.tex_coords[0] = tex_coords.x;
+        star.tex_coords[1] = tex_coords.y;
+        star.tex_coords[2] = tex_coords.z;
+        star.tex_coords[3] = tex_coords.w;
+
+        append(starfield.stars, star);
+    }
+
+    starfield.atlas = sprites.sprites[0].atlas;
+    starfield.generation = next_generation++;
+}
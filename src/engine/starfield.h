@@ -0,0 +1,43 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "core/common.h"
+#include "core/types.h"
+#include "graphics/texture.h"
+#include "math/vecs/vector2.h"
+#include "math/vecs/vector3.h"
+#include "render_commands.h"
+#include "sprite.h"
+
+// Parallax star background drawn with a single call
+// The stars are kept as they are and Imgui::render_starfield records all of them as one command, the backend moves
+// every star by the parallax of the frame, so a frame only records a few numbers no matter how many stars there are.
+// Backends that draw on the GPU only upload the stars again when the generation changes.
+// Stars are positioned like Imgui sprites (playground units, y down).
+
+struct Starfield
+{
+    DynamicArray<RenderStar> stars;
+    Texture atlas;
+    u32 generation;     // New for every upload
+};
+
+struct StarfieldView
+{
+    Vector2 playground;
+    Vector2 parallax;       // Offset of the nearest stars, a star at depth z moves (1 - z^2) of it
+
+    // From playground to screen units, same as Imgui::set_scale and Imgui::set_offset
+    Vector2 scale;
+    Vector2 offset;
+    Vector2 screen_size;
+
+    f32 z;
+};
+
+Starfield make(Type<Starfield>);
+void free(Starfield& starfield);
+
+// Positions are in the playground (0 to 1) with the depth in z, every star uses one sprite of the animation
+// Call again whenever the stars or the sprites change
+void starfield_upload(Starfield& starfield, const Vector3* positions, const u64* sprite_indices, u64 count, const Animation2D& sprites);
@@ -0,0 +1,151 @@
+#include "steering.h"
+
+#include <xmmintrin.h>
+
+#include "core/types.h"
+#include "math/common.h"
+#include "math/vecs/vector2.h"
+
+// Agents are stored as (x, y) pairs, these turn 4 of them into an x and a y register and back
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void steering_load(const Vector2* vectors, __m128& x, __m128& y)
+{
+    const __m128 first  = _mm_loadu_ps(&vectors[0].x);
+    const __m128 second = _mm_loadu_ps(&vectors[2].x);
+
+    x = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+    y = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void steering_store(Vector2* vectors, const __m128 x, const __m128 y)
+{
+    _mm_storeu_ps(&vectors[0].x, _mm_unpacklo_ps(x, y));
+    _mm_storeu_ps(&vectors[2].x, _mm_unpacklo_ps(_mm_movehl_ps(x, x), _mm_movehl_ps(y, y)));
+}
+
+// The exact square root and division keep every machine on the same result, which replays depend on.
+// (_mm_rsqrt_ps is faster but its precision is implementation defined)
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static __m128 steering_length(const __m128 x, const __m128 y)
+{
+    return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static Vector2 steering_update_single(Vector2& position, Vector2 target, const SteeringSettings& settings, f32 delta_time)
+{
+    if (settings.behaviour == SteeringBehaviour::PURSUE)
+        target = Vector2 { target.x + settings.lookahead * settings.target_velocity.x, target.y + settings.lookahead * settings.target_velocity.y };
+
+    Vector2 direction = Vector2 { target.x - position.x, target.y - position.y };
+    if (settings.behaviour == SteeringBehaviour::FLEE)
+        direction = Vector2 { 0.0f - direction.x, 0.0f - direction.y };
+
+    const f32 len = Math::sqrt(direction.x * direction.x + direction.y * direction.y);
+    if (len == 0.0f)
+        return Vector2 { 0.0f, 0.0f };
+
+    f32 speed_factor = 1.0f;
+    if (settings.behaviour != SteeringBehaviour::FLEE && settings.arrive_distance > 0.0f)
+        speed_factor = min(max(len / settings.arrive_distance, 0.0f), 1.0f);
+
+    const Vector2 velocity = Vector2 {
+        (settings.max_speed.x * speed_factor) * (direction.x / len),
+        (settings.max_speed.y * speed_factor) * (direction.y / len)
+    };
+
+    position = Vector2 { position.x + delta_time * velocity.x, position.y + delta_time * velocity.y };
+    return velocity;
+}
+
+void steering_update(Vector2* positions, const Vector2* targets, Vector2* velocities, u64 count, const SteeringSettings& settings, f32 delta_time)
+{
+    const bool pursue = settings.behaviour == SteeringBehaviour::PURSUE;
+    const bool flee   = settings.behaviour == SteeringBehaviour::FLEE;
+    const bool arrive = !flee && settings.arrive_distance > 0.0f;
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 dt   = _mm_set1_ps(delta_time);
+
+    const __m128 max_speed_x     = _mm_set1_ps(settings.max_speed.x);
+    const __m128 max_speed_y     = _mm_set1_ps(settings.max_speed.y);
+    const __m128 arrive_distance = _mm_set1_ps(settings.arrive_distance);
+    const __m128 lead_x          = _mm_set1_ps(settings.lookahead * settings.target_velocity.x);
+    const __m128 lead_y          = _mm_set1_ps(settings.lookahead * settings.target_velocity.y);
+
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 position_x, position_y, target_x, target_y;
+        steering_load(positions + i, position_x, position_y);
+        steering_load(targets + i, target_x, target_y);
+
+        if (pursue)
+        {
+            target_x = _mm_add_ps(target_x, lead_x);
+            target_y = _mm_add_ps(target_y, lead_y);
+        }
+
+        __m128 direction_x = _mm_sub_ps(target_x, position_x);
+        __m128 direction_y = _mm_sub_ps(target_y, position_y);
+        if (flee)
+        {
+            direction_x = _mm_sub_ps(zero, direction_x);
+            direction_y = _mm_sub_ps(zero, direction_y);
+        }
+
+        const __m128 len = steering_length(direction_x, direction_y);
+
+        __m128 speed_factor = one;
+        if (arrive)
+            speed_factor = _mm_min_ps(_mm_max_ps(_mm_div_ps(len, arrive_distance), zero), one);
+
+        // Agents on top of their target don't move (and would divide by 0)
+        const __m128 moving = _mm_cmpneq_ps(len, zero);
+
+        const __m128 velocity_x = _mm_and_ps(moving, _mm_mul_ps(_mm_mul_ps(max_speed_x, speed_factor), _mm_div_ps(direction_x, len)));
+        const __m128 velocity_y = _mm_and_ps(moving, _mm_mul_ps(_mm_mul_ps(max_speed_y, speed_factor), _mm_div_ps(direction_y, len)));
+
+        steering_store(velocities + i, velocity_x, velocity_y);
+        steering_store(positions + i, _mm_add_ps(position_x, _mm_mul_ps(dt, velocity_x)), _mm_add_ps(position_y, _mm_mul_ps(dt, velocity_y)));
+    }
+
+    for (; i < count; i++)
+        velocities[i] = steering_update_single(positions[i], targets[i], settings, delta_time);
+}
+
+void steering_extend_targets(const Vector2* positions, Vector2* targets, u64 count, f32 distance)
+{
+    const __m128 zero   = _mm_setzero_ps();
+    const __m128 extend = _mm_set1_ps(distance);
+
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 position_x, position_y, target_x, target_y;
+        steering_load(positions + i, position_x, position_y);
+        steering_load(targets + i, target_x, target_y);
+
+        const __m128 direction_x = _mm_sub_ps(target_x, position_x);
+        const __m128 direction_y = _mm_sub_ps(target_y, position_y);
+        const __m128 len = steering_length(direction_x, direction_y);
+
+        // Same as normalize, a zero direction stays zero
+        const __m128 moving = _mm_cmpneq_ps(len, zero);
+        const __m128 offset_x = _mm_and_ps(moving, _mm_mul_ps(extend, _mm_div_ps(direction_x, len)));
+        const __m128 offset_y = _mm_and_ps(moving, _mm_mul_ps(extend, _mm_div_ps(direction_y, len)));
+
+        steering_store(targets + i, _mm_add_ps(offset_x, position_x), _mm_add_ps(offset_y, position_y));
+    }
+
+    for (; i < count; i++)
+    {
+        const Vector2 direction = Vector2 { targets[i].x - positions[i].x, targets[i].y - positions[i].y };
+        const f32 len = Math::sqrt(direction.x * direction.x + direction.y * direction.y);
+
+        const Vector2 offset = (len != 0.0f) ? Vector2 { distance * (direction.x / len), distance * (direction.y / len) } : Vector2 { 0.0f, 0.0f };
+        targets[i] = Vector2 { offset.x + positions[i].x, offset.y + positions[i].y };
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+
+// Batched steering
+// Every agent has a position, a target and a velocity, each in its own column (the caller owns them,
+// usually next to the rest of the entity data so adding and removing keeps them in lockstep).
+// All agents of a call use the same behaviour, they're updated 4 at a time with SSE and the
+// remainder goes through the same float operations one by one, so the results don't depend on the count.
+
+enum struct SteeringBehaviour : u8
+{
+    SEEK,       // Towards the target, slowing down closer than the arrive distance
+    FLEE,       // Away from the target at full speed
+    PURSUE      // Seek, aiming where the target will be after the lookahead
+};
+
+struct SteeringSettings
+{
+    SteeringBehaviour behaviour;
+    Vector2 max_speed;          // Per axis
+    f32 arrive_distance;        // 0 never slows down
+
+    // Pursue only, every agent chases targets moving with this velocity
+    Vector2 target_velocity;
+    f32 lookahead;              // Seconds
+};
+
+// Moves every agent and writes the velocity it moved with
+void steering_update(Vector2* positions, const Vector2* targets, Vector2* velocities, u64 count, const SteeringSettings& settings, f32 delta_time);
+
+// Puts every target distance away from its agent, keeping its direction (agents on top of their target keep it)
+void steering_extend_targets(const Vector2* positions, Vector2* targets, u64 count, f32 distance);
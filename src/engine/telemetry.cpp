@@ -0,0 +1,162 @@
+#include "telemetry.h"
+
+#include <cstdio>
+
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "math/vecs/vector4.h"
+#include "platform/platform.h"
+#include "imgui.h"
+
+// Bars go in front of the background
+static constexpr f32 graph_z_offset = -0.0000001f;
+
+Telemetry make(Type<Telemetry>, u64 capacity)
+{
+    gn_assert_with_message(capacity > 0, "Telemetry needs room for at least one sample!");
+
+    Telemetry telemetry = {};
+    telemetry.capacity = capacity;
+    telemetry.samples  = (TelemetrySample*) platform_allocate(capacity * sizeof(TelemetrySample));
+
+    return telemetry;
+}
+
+void free(Telemetry& telemetry)
+{
+    platform_free(telemetry.samples);
+    telemetry = {};
+}
+
+void telemetry_set_entity_categories(Telemetry& telemetry, const char* const* names, u32 count)
+{
+    gn_assert_with_message(count <= telemetry_max_entity_categories, "Too many telemetry entity categories! (count: %, max: %)", count, telemetry_max_entity_categories);
+
+    for (u32 i = 0; i < count; i++)
+        telemetry.entity_names[i] = names[i];
+
+    telemetry.entity_category_count = count;
+}
+
+void telemetry_record(Telemetry& telemetry, const TelemetrySample& sample)
+{
+    telemetry.samples[telemetry.recorded % telemetry.capacity] = sample;
+    telemetry.recorded++;
+}
+
+u64 telemetry_get_sample_count(const Telemetry& telemetry)
+{
+    return min(telemetry.recorded, telemetry.capacity);
+}
+
+const TelemetrySample& telemetry_get_sample(const Telemetry& telemetry, u64 index)
+{
+    const u64 oldest = telemetry.recorded - telemetry_get_sample_count(telemetry);
+    return telemetry.samples[(oldest + index) % telemetry.capacity];
+}
+
+void telemetry_render_graph(const Telemetry& telemetry, const Rect& area, f32 z, f32 target_frame_time)
+{
+    const f32 width  = area.right - area.left;
+    const f32 height = area.bottom - area.top;
+
+    Imgui::render_rect(area, z, Vector4 { 0.0f, 0.0f, 0.0f, 0.5f });
+    z += graph_z_offset;
+
+    {   // Target Frame Time
+        const f32 y = area.bottom - 0.5f * height;
+        Imgui::render_rect(Rect { area.left, y - 0.5f, area.right, y + 0.5f }, z, Vector4 { 1.0f, 1.0f, 1.0f, 0.5f });
+        z += graph_z_offset;
+    }
+
+    // Newest sample on the right, the bars only fill the whole width once the buffer is full
+    const u64 count = telemetry_get_sample_count(telemetry);
+    const f32 bar_width = width / telemetry.capacity;
+    const f32 start_x = area.right - count * bar_width;
+
+    for (u64 i = 0; i < count; i++)
+    {
+        const TelemetrySample& sample = telemetry_get_sample(telemetry, i);
+        const f32 frame_time = sample.update_time + sample.render_time;
+
+        // Twice the target (or more) reaches the top
+        const f32 fill = min(frame_time / (2.0f * target_frame_time), 1.0f);
+
+        Vector4 color = Vector4 { 0.2f, 0.9f, 0.2f, 0.8f };
+        if (frame_time > 1.5f * target_frame_time)
+            color = Vector4 { 0.9f, 0.2f, 0.2f, 0.8f };
+        else if (frame_time > target_frame_time)
+            color = Vector4 { 0.9f, 0.8f, 0.2f, 0.8f };
+
+        const f32 left = start_x + i * bar_width;
+        Imgui::render_rect(Rect { left, area.bottom - fill * height, left + bar_width, area.bottom }, z, color);
+    }
+}
+
+bool telemetry_save_csv(const Telemetry& telemetry, const String filepath)
+{
+    FILE* file = fopen(filepath.data, "w");
+    if (!file)
+    {
+        gn_warn("Couldn't open telemetry file! (filepath: %)", filepath);
+        return false;
+    }
+
+    fprintf(file, "frame,update_time_ms,render_time_ms,quad_count,draw_call_count,texture_bind_count,batch_split_count,upload_bytes,audio_source_count,allocation_count");
+    for (u32 c = 0; c < telemetry.entity_category_count; c++)
+        fprintf(file, ",%s", telemetry.entity_names[c]);
+    fprintf(file, "\n");
+
+    const u64 count = telemetry_get_sample_count(telemetry);
+    const u64 first_frame = telemetry.recorded - count;
+
+    for (u64 i = 0; i < count; i++)
+    {
+        const TelemetrySample& sample = telemetry_get_sample(telemetry, i);
+
+        fprintf(file, "%llu,%f,%f,%u,%u,%u,%u,%u,%u,%u", first_frame + i, sample.update_time * 1e3f, sample.render_time * 1e3f,
+                sample.quad_count, sample.draw_call_count, sample.texture_bind_count, sample.batch_split_count, sample.upload_bytes,
+                sample.audio_source_count, sample.allocation_count);
+        for (u32 c = 0; c < telemetry.entity_category_count; c++)
+            fprintf(file, ",%u", sample.entity_counts[c]);
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool telemetry_save_json(const Telemetry& telemetry, const String filepath)
+{
+    FILE* file = fopen(filepath.data, "w");
+    if (!file)
+    {
+        gn_warn("Couldn't open telemetry file! (filepath: %)", filepath);
+        return false;
+    }
+
+    const u64 count = telemetry_get_sample_count(telemetry);
+    const u64 first_frame = telemetry.recorded - count;
+
+    fprintf(file, "{\n    \"first_frame\": %llu,\n    \"samples\": [\n", first_frame);
+
+    for (u64 i = 0; i < count; i++)
+    {
+        const TelemetrySample& sample = telemetry_get_sample(telemetry, i);
+
+        fprintf(file, "        { \"update_time_ms\": %f, \"render_time_ms\": %f, \"quad_count\": %u, \"draw_call_count\": %u, \"texture_bind_count\": %u, \"batch_split_count\": %u, \"upload_bytes\": %u, \"audio_source_count\": %u, \"allocation_count\": %u",
+                sample.update_time * 1e3f, sample.render_time * 1e3f, sample.quad_count, sample.draw_call_count, sample.texture_bind_count, sample.batch_split_count,
+                sample.upload_bytes, sample.audio_source_count, sample.allocation_count);
+
+        fprintf(file, ", \"entities\": {");
+        for (u32 c = 0; c < telemetry.entity_category_count; c++)
+            fprintf(file, "%s \"%s\": %u", (c > 0) ? "," : "", telemetry.entity_names[c], sample.entity_counts[c]);
+        fprintf(file, " } }%s\n", (i + 1 < count) ? "," : "");
+    }
+
+    fprintf(file, "    ]\n}\n");
+
+    fclose(file);
+    return true;
+}
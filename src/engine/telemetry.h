@@ -0,0 +1,56 @@
+#pragma once
+
+#include "containers/string.h"
+#include "core/common.h"
+#include "core/types.h"
+#include "rect.h"
+
+// Per frame telemetry
+// Samples go into a fixed size ring buffer, once it's full every new frame overwrites the oldest one,
+// so the last few seconds are always there to look at (graph) or to save (csv, json) when a spike shows up.
+// Entity counts are named by whoever records them, the telemetry only keeps the numbers.
+
+static constexpr u32 telemetry_max_entity_categories = 12;
+
+struct TelemetrySample
+{
+    f32 update_time;    // Seconds
+    f32 render_time;    // Seconds, cpu side only
+    u32 quad_count;
+    u32 draw_call_count;
+    u32 texture_bind_count;
+    u32 batch_split_count;
+    u32 upload_bytes;
+    u32 audio_source_count;
+    u32 allocation_count;   // During the frame
+    u32 entity_counts[telemetry_max_entity_categories];
+};
+
+struct Telemetry
+{
+    TelemetrySample* samples;
+    u64 capacity;
+    u64 recorded;   // Since make, the newest sample is at (recorded - 1) % capacity
+
+    const char* entity_names[telemetry_max_entity_categories];
+    u32 entity_category_count;
+};
+
+Telemetry make(Type<Telemetry>, u64 capacity);
+void free(Telemetry& telemetry);
+
+// names has to stay alive as long as the telemetry does
+void telemetry_set_entity_categories(Telemetry& telemetry, const char* const* names, u32 count);
+
+void telemetry_record(Telemetry& telemetry, const TelemetrySample& sample);
+
+// Number of samples in the buffer, index 0 is the oldest
+u64 telemetry_get_sample_count(const Telemetry& telemetry);
+const TelemetrySample& telemetry_get_sample(const Telemetry& telemetry, u64 index);
+
+// One bar per sample (update + render time) against the target frame time, which sits at half the height
+void telemetry_render_graph(const Telemetry& telemetry, const Rect& area, f32 z, f32 target_frame_time);
+
+// Oldest sample first, returns false if the file couldn't be opened
+bool telemetry_save_csv(const Telemetry& telemetry, const String filepath);
+bool telemetry_save_json(const Telemetry& telemetry, const String filepath);
@@ -0,0 +1,170 @@
+#include "bullet_patterns.h"
+
+#include "containers/darray.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "math/constants.h"
+#include "math/vecs/vector2.h"
+#include "serialization/json.h"
+
+// Same order as EnemyType
+static const char* enemy_type_names[] = { "flying", "dropper", "kamikaze" };
+static constexpr u32 enemy_type_count = sizeof(enemy_type_names) / sizeof(enemy_type_names[0]);
+
+static BulletPatternType get_pattern_type(const String type_string)
+{
+    if (type_string == ref("spiral"))
+        return BulletPatternType::SPIRAL;
+
+    if (type_string == ref("aimed_fan"))
+        return BulletPatternType::AIMED_FAN;
+
+    gn_assert_with_message(type_string == ref("radial"), "Bullet pattern type not supported! (type: %)", type_string);
+    return BulletPatternType::RADIAL;
+}
+
+static u32 get_enemy_type(const String name)
+{
+    for (u32 i = 0; i < enemy_type_count; i++)
+    {
+        if (name == ref((char*) enemy_type_names[i]))
+            return i;
+    }
+
+    gn_assert_with_message(false, "Unknown enemy type in bullet wave script! (enemy: %)", name);
+    return 0;
+}
+
+static u32 find_pattern(const Json::Array& j_patterns, const String name)
+{
+    for (u32 i = 0; i < j_patterns.size(); i++)
+    {
+        if (j_patterns[i][ref("name")].string() == name)
+            return i;
+    }
+
+    gn_assert_with_message(false, "Bullet wave script uses a pattern that doesn't exist! (pattern: %)", name);
+    return 0;
+}
+
+void bullet_patterns_load_from_json(const Json::Document& document, BulletPatterns& patterns)
+{
+    const auto& j_data = document.start();
+
+    free(patterns);
+
+    patterns.start_stage = j_data[ref("start_stage")].int64();
+
+    const auto& j_patterns = j_data[ref("patterns")].array();
+    for (u64 i = 0; i < j_patterns.size(); i++)
+    {
+        const auto& j_pattern = j_patterns[i];
+
+        BulletPattern pattern = {};
+        pattern.type  = get_pattern_type(j_pattern[ref("type")].string());
+        pattern.speed = j_pattern[ref("speed")].float64();
+
+        const u32 bullet_count = j_pattern[ref("count")].int64();
+        gn_assert_with_message(bullet_count > 0, "Bullet pattern doesn't fire any bullets! (pattern index: %)", i);
+
+        // Full circles leave a gap after the last bullet, arcs end on it
+        f32 first_angle = 0.0f;
+        f32 angle_step  = 2.0f * Math::PI / bullet_count;
+
+        if (pattern.type == BulletPatternType::AIMED_FAN)
+        {
+            const f32 spread = Math::PI / 180.0f * (f32) j_pattern[ref("spread")].float64();
+
+            first_angle = -0.5f * spread;
+            angle_step  = (bullet_count > 1) ? spread / (bullet_count - 1) : 0.0f;
+        }
+
+        if (pattern.type == BulletPatternType::SPIRAL)
+            pattern.rotation = Math::PI / 180.0f * (f32) j_pattern[ref("rotation")].float64();
+
+        // Straight down turned by the angle
+        pattern.directions = make<DynamicArray<Vector2>>((u64) bullet_count);
+        for (u32 b = 0; b < bullet_count; b++)
+        {
+            const f32 angle = first_angle + b * angle_step;
+            append(pattern.directions, Vector2 { -Math::sin(angle), Math::cos(angle) });
+        }
+
+        append(patterns.patterns, pattern);
+    }
+
+    const auto& j_script = j_data[ref("script")].array();
+    for (u64 i = 0; i < j_script.size(); i++)
+    {
+        const auto& j_step = j_script[i];
+
+        BulletWaveStep step = {};
+        step.pattern_index = find_pattern(j_patterns, j_step[ref("pattern")].string());
+        step.enemy_type    = get_enemy_type(j_step[ref("enemy")].string());
+        step.source        = (j_step[ref("source")].string() == ref("every")) ? BulletWaveSource::EVERY_ENEMY : BulletWaveSource::RANDOM_ENEMY;
+        step.delay         = j_step[ref("delay")].float64();
+
+        gn_assert_with_message(step.delay > 0.0f, "Bullet wave steps need a delay! (step index: %)", i);
+
+        append(patterns.script, step);
+    }
+}
+
+void bullet_pattern_fire(const BulletPattern& pattern, BulletPool& pool, const Vector2* origins, u64 origin_count, Vector2 target, u32 fire_count)
+{
+    const u64 bullet_count = pattern.directions.size;
+    const u64 total_count  = bullet_pool_reserve(pool, origin_count * bullet_count);
+
+    // Rotation from straight down as (cos, sin), the same for every origin unless the pattern aims
+    Vector2 rotation = Vector2 { 1.0f, 0.0f };
+    if (pattern.type == BulletPatternType::SPIRAL)
+    {
+        const f32 angle = pattern.rotation * fire_count;
+        rotation = Vector2 { Math::cos(angle), Math::sin(angle) };
+    }
+
+    u64 written = 0;
+    for (u64 o = 0; o < origin_count && written < total_count; o++)
+    {
+        const Vector2 origin = origins[o];
+
+        if (pattern.type == BulletPatternType::AIMED_FAN)
+        {
+            // Turning straight down to the aim, an enemy on top of the target fires down
+            const f32 distance = length(target - origin);
+            const Vector2 aim = (distance > 0.0f) ? (target - origin) / distance : Vector2 { 0.0f, 1.0f };
+            rotation = Vector2 { aim.y, -aim.x };
+        }
+
+        const Vector2 velocity_x = pattern.speed * Vector2 { rotation.x, -rotation.y };
+        const Vector2 velocity_y = pattern.speed * Vector2 { rotation.y,  rotation.x };
+
+        const u64 count = min(bullet_count, total_count - written);
+        const u64 start = pool.count + written;
+
+        for (u64 b = 0; b < count; b++)
+        {
+            const Vector2 direction = pattern.directions[b];
+
+            pool.position_x[start + b] = origin.x;
+            pool.position_y[start + b] = origin.y;
+            pool.velocity_x[start + b] = velocity_x.x * direction.x + velocity_x.y * direction.y;
+            pool.velocity_y[start + b] = velocity_y.x * direction.x + velocity_y.y * direction.y;
+        }
+
+        written += count;
+    }
+
+    bullet_pool_commit(pool, written);
+}
+
+void free(BulletPatterns& patterns)
+{
+    for (u64 i = 0; i < patterns.patterns.size; i++)
+        free(patterns.patterns[i].directions);
+
+    free(patterns.patterns);
+    free(patterns.script);
+    patterns.start_stage = 0;
+}
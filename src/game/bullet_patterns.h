@@ -0,0 +1,56 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+#include "serialization/json.h"
+#include "bullet_pool.h"
+
+// Enemy fire patterns and the wave script that fires them
+// Every pattern keeps the directions of its bullets relative to straight down, firing one rotates them
+// as a whole (by the spiral angle or towards the target) and writes the bullets into the pool in one go.
+
+enum struct BulletPatternType : u8
+{
+    RADIAL,     // Evenly spread around the full circle
+    SPIRAL,     // Radial, turning a bit more every time the script fires
+    AIMED_FAN   // Spread over an arc centered on the player
+};
+
+struct BulletPattern
+{
+    BulletPatternType type;
+    f32 speed;
+    f32 rotation;   // Spirals, radians added every time the script fires
+
+    DynamicArray<Vector2> directions;
+};
+
+enum struct BulletWaveSource : u8
+{
+    RANDOM_ENEMY,
+    EVERY_ENEMY
+};
+
+struct BulletWaveStep
+{
+    u32 pattern_index;
+    u32 enemy_type;     // EnemyType the bullets come from
+    BulletWaveSource source;
+    f32 delay;          // Seconds since the previous step
+};
+
+// The script loops from the start stage on, a start stage of 0 (or an empty script) turns it off
+struct BulletPatterns
+{
+    DynamicArray<BulletPattern> patterns;
+    DynamicArray<BulletWaveStep> script;
+    u32 start_stage;
+};
+
+void bullet_patterns_load_from_json(const Json::Document& document, BulletPatterns& patterns);
+
+// fire_count is how many steps the script fired before this one, the spiral angle comes from it
+void bullet_pattern_fire(const BulletPattern& pattern, BulletPool& pool, const Vector2* origins, u64 origin_count, Vector2 target, u32 fire_count);
+
+void free(BulletPatterns& patterns);
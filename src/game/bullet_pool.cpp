@@ -0,0 +1,182 @@
+#include "bullet_pool.h"
+
+#include <xmmintrin.h>
+
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "platform/platform.h"
+
+// Smaller updates stay on the calling thread, measured in blocks of 4 bullets
+static constexpr u64 update_batch_block_count = 1024;
+
+static constexpr u64 array_count   = 4;
+static constexpr u64 array_padding = 16;   // Floats, one cache line
+
+BulletPool make(Type<BulletPool>, u64 capacity)
+{
+    BulletPool pool = {};
+
+    // Every array starts 16 byte aligned as long as the allocation does
+    pool.capacity = (capacity + 3) & ~3ull;
+
+    // Padded for the same reason as the particles, power of 2 capacities would put every array in the same cache set
+    const u64 stride = pool.capacity + array_padding;
+
+    f32* memory = (f32*) platform_allocate(array_count * stride * sizeof(f32));
+    gn_assert_with_message(((u64) memory & 15) == 0, "Bullet memory isn't 16 byte aligned! (address: %)", (void*) memory);
+
+    // Lanes past the count still get updated, zeroing them keeps those lanes free of nans
+    platform_zero_memory(memory, array_count * stride * sizeof(f32));
+
+    pool.position_x = memory + 0 * stride;
+    pool.position_y = memory + 1 * stride;
+    pool.velocity_x = memory + 2 * stride;
+    pool.velocity_y = memory + 3 * stride;
+
+    return pool;
+}
+
+void free(BulletPool& pool)
+{
+    // position_x is the start of the allocation
+    platform_free(pool.position_x);
+    pool = {};
+}
+
+void bullet_pool_clear(BulletPool& pool)
+{
+    pool.count = 0;
+}
+
+u64 bullet_pool_reserve(const BulletPool& pool, u64 count)
+{
+    return min(count, pool.capacity - pool.count);
+}
+
+void bullet_pool_commit(BulletPool& pool, u64 count)
+{
+    gn_assert_with_message(pool.count + count <= pool.capacity, "Committed more bullets than reserved! (count: %, committed: %, capacity: %)", pool.count, count, pool.capacity);
+    pool.count += count;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void bullet_pool_move(BulletPool& pool, u64 from, u64 to)
+{
+    pool.position_x[to] = pool.position_x[from];
+    pool.position_y[to] = pool.position_y[from];
+    pool.velocity_x[to] = pool.velocity_x[from];
+    pool.velocity_y[to] = pool.velocity_y[from];
+}
+
+// Moves the last bullet into the place of every removed one, same as the particle compaction
+// remove_block gives the mask of the bullets to remove out of 4 (from _mm_movemask_ps), remove_one tests a single bullet
+template <typename RemoveBlock, typename RemoveOne>
+static u64 bullet_pool_compact(BulletPool& pool, RemoveBlock remove_block, RemoveOne remove_one)
+{
+    const u64 start_count = pool.count;
+
+    u64 count = pool.count;
+    for (u64 block = 0; block < count; block += 4)
+    {
+        if (remove_block(block) == 0)
+            continue;
+
+        // The bullet moved in can be removed as well, so the index only moves on past kept ones
+        u64 i = block;
+        while (i < min(block + 4, count))
+        {
+            if (!remove_one(i))
+            {
+                i++;
+                continue;
+            }
+
+            count--;
+            bullet_pool_move(pool, count, i);
+        }
+    }
+
+    pool.count = count;
+    return start_count - count;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void bullet_pool_integrate(const BulletPool& pool, u64 start, u64 end, f32 time_step)
+{
+    const __m128 dt = _mm_set1_ps(time_step);
+
+    for (u64 i = start; i < end; i += 4)
+    {
+        _mm_store_ps(pool.position_x + i, _mm_add_ps(_mm_load_ps(pool.position_x + i), _mm_mul_ps(_mm_load_ps(pool.velocity_x + i), dt)));
+        _mm_store_ps(pool.position_y + i, _mm_add_ps(_mm_load_ps(pool.position_y + i), _mm_mul_ps(_mm_load_ps(pool.velocity_y + i), dt)));
+    }
+}
+
+void bullet_pool_update(BulletPool& pool, f32 time_step, const Vector4& bounds)
+{
+    pool.last_time_step = time_step;
+
+    const u64 block_count = (pool.count + 3) / 4;
+
+    Jobs::parallel_for(block_count, update_batch_block_count, [&](u64 start, u64 end)
+    {
+        bullet_pool_integrate(pool, 4 * start, 4 * end, time_step);
+    });
+
+    const __m128 left   = _mm_set1_ps(bounds.x);
+    const __m128 top    = _mm_set1_ps(bounds.y);
+    const __m128 right  = _mm_set1_ps(bounds.z);
+    const __m128 bottom = _mm_set1_ps(bounds.w);
+
+    bullet_pool_compact(pool,
+        [&](u64 block)
+        {
+            const __m128 x = _mm_load_ps(pool.position_x + block);
+            const __m128 y = _mm_load_ps(pool.position_y + block);
+
+            const __m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, left), _mm_cmpgt_ps(x, right)),
+                                             _mm_or_ps(_mm_cmplt_ps(y, top),  _mm_cmpge_ps(y, bottom)));
+            return _mm_movemask_ps(outside);
+        },
+        [&](u64 i)
+        {
+            const f32 x = pool.position_x[i];
+            const f32 y = pool.position_y[i];
+            return x < bounds.x || x > bounds.z || y < bounds.y || y >= bounds.w;
+        });
+}
+
+u64 bullet_pool_remove_overlapping(BulletPool& pool, const Vector4& bullet_aabb_coord, const Vector4& aabb)
+{
+    // Both tests do the same float operations, so the blocks never skip a bullet the single test would remove
+    const __m128 coord_left   = _mm_set1_ps(bullet_aabb_coord.x);
+    const __m128 coord_top    = _mm_set1_ps(bullet_aabb_coord.y);
+    const __m128 coord_right  = _mm_set1_ps(bullet_aabb_coord.z);
+    const __m128 coord_bottom = _mm_set1_ps(bullet_aabb_coord.w);
+
+    const __m128 left   = _mm_set1_ps(aabb.x);
+    const __m128 top    = _mm_set1_ps(aabb.y);
+    const __m128 right  = _mm_set1_ps(aabb.z);
+    const __m128 bottom = _mm_set1_ps(aabb.w);
+
+    return bullet_pool_compact(pool,
+        [&](u64 block)
+        {
+            const __m128 x = _mm_load_ps(pool.position_x + block);
+            const __m128 y = _mm_load_ps(pool.position_y + block);
+
+            const __m128 overlap_x = _mm_and_ps(_mm_cmplt_ps(_mm_add_ps(x, coord_left), right), _mm_cmpgt_ps(_mm_add_ps(x, coord_right), left));
+            const __m128 overlap_y = _mm_and_ps(_mm_cmplt_ps(_mm_add_ps(y, coord_top), bottom), _mm_cmpgt_ps(_mm_add_ps(y, coord_bottom), top));
+            return _mm_movemask_ps(_mm_and_ps(overlap_x, overlap_y));
+        },
+        [&](u64 i)
+        {
+            const f32 x = pool.position_x[i];
+            const f32 y = pool.position_y[i];
+
+            return x + bullet_aabb_coord.x < aabb.z && x + bullet_aabb_coord.z > aabb.x &&
+                   y + bullet_aabb_coord.y < aabb.w && y + bullet_aabb_coord.w > aabb.y;
+        });
+}
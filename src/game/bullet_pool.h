@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/common.h"
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+#include "math/vecs/vector4.h"
+
+// Fixed capacity bullets for the enemy fire patterns
+// Same layout as the particles (structure of arrays, one allocation, swap removal), every bullet keeps
+// its own velocity so a pattern can send them in any direction. Adding to a full pool drops the new bullets.
+// Unlike particles these are gameplay state, everything here is deterministic and part of snapshots.
+
+struct BulletPool
+{
+    u64 capacity;   // Multiple of 4
+    u64 count;
+
+    // All capacity sized arrays inside a single allocation
+    f32* position_x;
+    f32* position_y;
+    f32* velocity_x;
+    f32* velocity_y;
+
+    // Rendering goes back along the velocity by this much to blend between ticks
+    f32 last_time_step;
+};
+
+BulletPool make(Type<BulletPool>, u64 capacity);
+void free(BulletPool& pool);
+
+void bullet_pool_clear(BulletPool& pool);
+
+// Returns how many bullets fit, the caller writes them to [count, count + returned) and then calls bullet_pool_commit
+u64  bullet_pool_reserve(const BulletPool& pool, u64 count);
+void bullet_pool_commit(BulletPool& pool, u64 count);
+
+// Moves every bullet and removes the ones outside of bounds (left, top, right, bottom)
+void bullet_pool_update(BulletPool& pool, f32 time_step, const Vector4& bounds);
+
+// Removes every bullet whose collider (bullet_aabb_coord around its position) overlaps aabb, returns how many were removed
+u64 bullet_pool_remove_overlapping(BulletPool& pool, const Vector4& bullet_aabb_coord, const Vector4& aabb);
+
+// Position of a bullet between the previous tick (alpha = 0) and the current one (alpha = 1)
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+Vector2 bullet_pool_get_position(const BulletPool& pool, u64 index, f32 alpha)
+{
+    const f32 rewind = (1.0f - alpha) * pool.last_time_step;
+    return Vector2 {
+        pool.position_x[index] - rewind * pool.velocity_x[index],
+        pool.position_y[index] - rewind * pool.velocity_y[index]
+    };
+}
@@ -0,0 +1,122 @@
+#include "formation.h"
+
+#include "containers/darray.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+
+#if defined(GN_COMPILER_MSVC)
+    #include <intrin.h>
+#endif
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static u32 lowest_set_bit(u64 word)
+{
+#if defined(GN_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (u32) index;
+#else
+    return (u32) __builtin_ctzll(word);
+#endif
+}
+
+static bool layout_equals(const FormationLayout& a, const FormationLayout& b)
+{
+    return a.column_count == b.column_count && a.row_count == b.row_count &&
+           a.origin.x == b.origin.x && a.origin.y == b.origin.y &&
+           a.spacing.x == b.spacing.x && a.spacing.y == b.spacing.y;
+}
+
+Formation make(Type<Formation>)
+{
+    Formation formation = {};
+    formation.slot_positions = make<DynamicArray<Vector2>>();
+    formation.free_bits      = make<DynamicArray<u64>>();
+
+    return formation;
+}
+
+void free(Formation& formation)
+{
+    free(formation.slot_positions);
+    free(formation.free_bits);
+    formation = {};
+}
+
+void formation_set_layout(Formation& formation, const FormationLayout& layout)
+{
+    const u64 slot_count = (u64) layout.column_count * layout.row_count;
+    gn_assert_with_message(slot_count <= 0xFFFFFFFFull, "Too many formation slots for 32 bit slot indices! (slot count: %)", slot_count);
+
+    if (!layout_equals(formation.layout, layout) || formation.slot_positions.size != slot_count)
+    {
+        formation.layout = layout;
+
+        clear(formation.slot_positions);
+        reserve(formation.slot_positions, slot_count);
+
+        Vector2 position = layout.origin;
+        for (u32 y = 0; y < layout.row_count; y++)
+        {
+            for (u32 x = 0; x < layout.column_count; x++)
+            {
+                append(formation.slot_positions, position);
+                position.x += layout.spacing.x;
+            }
+
+            position.y += layout.spacing.y;
+            position.x = layout.origin.x;
+        }
+    }
+
+    const u64 word_count = (slot_count + 63) / 64;
+
+    clear(formation.free_bits);
+    reserve(formation.free_bits, word_count);
+
+    for (u64 i = 0; i < word_count; i++)
+        append(formation.free_bits, 0ull);
+
+    formation.free_count = 0;
+    formation.first_free_word = word_count;
+}
+
+bool formation_claim(Formation& formation, u32& out_slot)
+{
+    if (formation.free_count == 0)
+        return false;
+
+    for (u64 word = formation.first_free_word; word < formation.free_bits.size; word++)
+    {
+        u64& bits = formation.free_bits[word];
+        if (bits == 0)
+            continue;
+
+        const u32 bit = lowest_set_bit(bits);
+        bits &= bits - 1;
+
+        formation.free_count--;
+        formation.first_free_word = (bits == 0) ? word + 1 : word;
+
+        out_slot = (u32) (64 * word + bit);
+        return true;
+    }
+
+    gn_assert_with_message(false, "Formation free count doesn't match its free slots! (free count: %)", formation.free_count);
+    return false;
+}
+
+void formation_release(Formation& formation, u32 slot)
+{
+    gn_assert_with_message(slot < formation.slot_positions.size, "Released a slot outside of the formation! (slot: %, slot count: %)", slot, formation.slot_positions.size);
+
+    const u64 word = slot / 64;
+    const u64 bit  = 1ull << (slot % 64);
+
+    gn_assert_with_message((formation.free_bits[word] & bit) == 0, "Released a formation slot that was already free! (slot: %)", slot);
+
+    formation.free_bits[word] |= bit;
+    formation.free_count++;
+    formation.first_free_word = min(formation.first_free_word, word);
+}
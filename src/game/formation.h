@@ -0,0 +1,45 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "core/common.h"
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+
+// Enemy formation slots
+// A formation is a grid of slots. The slot positions of a layout are only computed when the layout
+// changes, waves with the same layout reuse them. Free slots are kept in a bitset (one bit per slot,
+// set while free), so claiming and releasing a slot never moves the others around.
+
+struct FormationLayout
+{
+    u32 column_count;
+    u32 row_count;
+    Vector2 origin;     // First slot
+    Vector2 spacing;
+};
+
+struct Formation
+{
+    FormationLayout layout;
+    DynamicArray<Vector2> slot_positions;   // Row major
+
+    DynamicArray<u64> free_bits;
+    u64 free_count;
+    u64 first_free_word;    // Every word before this one is full
+};
+
+Formation make(Type<Formation>);
+void free(Formation& formation);
+
+// Every slot starts out taken
+void formation_set_layout(Formation& formation, const FormationLayout& layout);
+
+// Claims the lowest free slot, returns false if there isn't one
+bool formation_claim(Formation& formation, u32& out_slot);
+void formation_release(Formation& formation, u32 slot);
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+u64 formation_slot_count(const Formation& formation)
+{
+    return formation.slot_positions.size;
+}
@@ -0,0 +1,227 @@
+#include "game_bot.h"
+
+#include "core/types.h"
+#include "math/common.h"
+#include "math/constants.h"
+#include "math/vecs/vector2.h"
+#include "game_settings.h"
+
+static constexpr u32 max_lane_count = 64;
+
+// Broadphase of the bot, the playground is split into lanes one player wide and every threat that
+// reaches the player within the lookahead marks the lanes it would hit with the time it hits them
+struct BotLanes
+{
+    u32 count;
+    f32 width;
+    f32 hit_time[max_lane_count];   // Soonest hit, infinity for safe lanes
+};
+
+struct BotThreatArea
+{
+    f32 player_top;
+    f32 player_bottom;
+    f32 player_half_width;
+    f32 lookahead;
+};
+
+static void lanes_mark(BotLanes& lanes, f32 left, f32 right, f32 time)
+{
+    const s64 first = max((s64) Math::floor(left / lanes.width), 0ll);
+    const s64 last  = min((s64) Math::floor(right / lanes.width), (s64) lanes.count - 1);
+
+    for (s64 lane = first; lane <= last; lane++)
+        lanes.hit_time[lane] = min(lanes.hit_time[lane], time);
+}
+
+static void lanes_add_threat(BotLanes& lanes, const BotThreatArea& area, Vector2 center, Vector2 half_size, Vector2 velocity)
+{
+    f32 time = 0.0f;
+
+    // Still above the player it only hits if it comes down in time, level with the player it already does
+    if (center.y + half_size.y < area.player_top)
+    {
+        if (velocity.y <= 0.0f)
+            return;
+
+        time = (area.player_top - (center.y + half_size.y)) / velocity.y;
+        if (time > area.lookahead)
+            return;
+    }
+    else if (center.y - half_size.y > area.player_bottom)
+        return;
+
+    // Every player position (lane center) that would overlap it at that time
+    const f32 x = center.x + velocity.x * time;
+    const f32 reach = half_size.x + area.player_half_width;
+    lanes_mark(lanes, x - reach, x + reach, time);
+}
+
+static f32 get_lane_center(const BotLanes& lanes, u32 lane)
+{
+    return (lane + 0.5f) * lanes.width;
+}
+
+// The lane an enemy is in that's the closest to the player horizontally
+static bool find_target_x(const GameState& state, f32& out_x)
+{
+    f32 best_distance = Math::infinity;
+
+    for (u64 enemy_type = 0; enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
+    {
+        const EntityData& enemies = state.enemies[enemy_type];
+
+        for (u64 i = 0; i < enemies.positions.size; i++)
+        {
+            const f32 distance = Math::abs(enemies.positions[i].x - state.player_position.x);
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                out_x = enemies.positions[i].x;
+            }
+        }
+    }
+
+    return best_distance != Math::infinity;
+}
+
+static void build_lanes(BotLanes& lanes, const GameState& state, const BotThreatArea& area)
+{
+    const f32 player_width = 2.0f * area.player_half_width;
+
+    lanes.count = min((u32) Math::ceil(state.game_playground.x / player_width), max_lane_count);
+    lanes.count = max(lanes.count, 1u);
+    lanes.width = state.game_playground.x / lanes.count;
+
+    for (u32 lane = 0; lane < lanes.count; lane++)
+        lanes.hit_time[lane] = Math::infinity;
+
+    {   // Enemy Bullets (positioned at their bottom, going straight down)
+        const Vector2 half_size = 0.5f * GameSettings::render_scale * GameSettings::enemy_bullet_collider_size;
+        const Vector2 velocity  = Vector2 { 0.0f, GameSettings::enemy_bullet_speed };
+
+        for (u64 i = 0; i < state.enemy_bullets.positions.size; i++)
+        {
+            const Vector2 position = state.enemy_bullets.positions[i];
+            lanes_add_threat(lanes, area, Vector2 { position.x, position.y - half_size.y }, half_size, velocity);
+        }
+    }
+
+    {   // Pattern Bullets
+        const Vector2 half_size = 0.5f * GameSettings::render_scale * GameSettings::enemy_bullet_collider_size;
+        const BulletPool& pool = state.pattern_bullets;
+
+        for (u64 i = 0; i < pool.count; i++)
+        {
+            const Vector2 position = Vector2 { pool.position_x[i], pool.position_y[i] };
+            const Vector2 velocity = Vector2 { pool.velocity_x[i], pool.velocity_y[i] };
+            lanes_add_threat(lanes, area, position, half_size, velocity);
+        }
+    }
+
+    {   // Kamikaze Enemies
+        const Vector2 half_size = 0.5f * GameSettings::render_scale * GameSettings::enemy_collider_size;
+        const EntityData& kamikazes = state.kamikaze_enemies;
+
+        for (u64 i = 0; i < kamikazes.positions.size; i++)
+            lanes_add_threat(lanes, area, kamikazes.positions[i], half_size, kamikazes.velocities[i]);
+    }
+}
+
+// Closest safe lane to the target that the player can get to without anything hitting it on the way,
+// if there's none it goes for the lane that gets hit the latest
+static u32 choose_lane(const BotLanes& lanes, f32 player_x, f32 target_x)
+{
+    const u32 current = min((u32) max(player_x / lanes.width, 0.0f), lanes.count - 1);
+
+    u32 best_lane = current;
+    f32 best_distance = Math::infinity;
+
+    u32 latest_lane = current;
+    f32 latest_time = -1.0f;
+
+    for (u32 lane = 0; lane < lanes.count; lane++)
+    {
+        if (lanes.hit_time[lane] > latest_time)
+        {
+            latest_time = lanes.hit_time[lane];
+            latest_lane = lane;
+        }
+
+        if (lanes.hit_time[lane] != Math::infinity)
+            continue;
+
+        // Every lane on the way has to stay clear until the player is past it
+        bool reachable = true;
+        const s32 step = (lane >= current) ? 1 : -1;
+        for (s32 passed = (s32) current; reachable; passed += step)
+        {
+            const f32 travel_time = Math::abs(get_lane_center(lanes, passed) - player_x) / GameSettings::player_move_speed;
+            reachable = lanes.hit_time[passed] > travel_time;
+
+            if (passed == (s32) lane)
+                break;
+        }
+
+        const f32 distance = Math::abs(get_lane_center(lanes, lane) - target_x);
+        if (reachable && distance < best_distance)
+        {
+            best_distance = distance;
+            best_lane = lane;
+        }
+    }
+
+    return (best_distance != Math::infinity) ? best_lane : latest_lane;
+}
+
+GameBot make(Type<GameBot>, u64 seed, f32 skill)
+{
+    GameBot bot = {};
+    bot.skill = clamp(skill, 0.0f, 1.0f);
+    Math::random_seed(bot.rng, seed);
+
+    return bot;
+}
+
+GameInput game_bot_get_input(GameBot& bot, const GameState& state, f32 delta_time)
+{
+    bot.time_until_decision -= delta_time;
+    if (bot.time_until_decision > 0.0f)
+        return bot.input;
+
+    // Worse bots take longer (and less regular) breaks between decisions
+    bot.time_until_decision = lerp(0.25f, 0.0f, bot.skill) * (0.5f + Math::random(bot.rng));
+
+    BotThreatArea area = {};
+    area.player_half_width = 0.5f * GameSettings::render_scale.x * GameSettings::player_collider_size.x;
+    area.player_top        = state.player_position.y - 0.5f * GameSettings::render_scale.y * GameSettings::player_collider_size.y;
+    area.player_bottom     = state.player_position.y + 0.5f * GameSettings::render_scale.y * GameSettings::player_collider_size.y;
+    area.lookahead         = lerp(0.3f, 1.2f, bot.skill);
+
+    f32 target_x = 0.5f * state.game_playground.x;
+    const bool has_target = find_target_x(state, target_x);
+
+    BotLanes lanes;
+    build_lanes(lanes, state, area);
+
+    // Sometimes worse bots don't see the threats at all
+    const bool distracted = Math::random(bot.rng) < 0.3f * (1.0f - bot.skill);
+    const f32 destination = distracted ? target_x : get_lane_center(lanes, choose_lane(lanes, state.player_position.x, target_x));
+
+    GameInput input = {};
+    input.buttons = GameButton::SHOOT;
+
+    const f32 dead_zone = 0.1f * lanes.width;
+    if (destination > state.player_position.x + dead_zone)
+        input.buttons |= GameButton::RIGHT;
+    else if (destination < state.player_position.x - dead_zone)
+        input.buttons |= GameButton::LEFT;
+
+    // The lazer is only worth it with an enemy right above
+    const bool lined_up = has_target && Math::abs(target_x - state.player_position.x) <= area.player_half_width;
+    if (lined_up && state.lazer_charge >= GameSettings::lazer_power_requirement)
+        input.buttons |= GameButton::LAZER;
+
+    bot.input = input;
+    return input;
+}
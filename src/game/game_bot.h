@@ -0,0 +1,28 @@
+#pragma once
+
+#include "core/common.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "game_input.h"
+#include "game_state.h"
+
+// Autonomous player for soak runs and benchmarks
+// It only produces GameInput (the same thing the keyboard does), so whatever it plays can be recorded
+// and played back like a human run. Threats are binned into lanes across the playground first,
+// the bot then picks the safe lane closest to the nearest enemy and moves towards it.
+// Decisions only depend on the game state, the seed and the skill.
+
+struct GameBot
+{
+    Math::Random rng;   // Its own, the gameplay generator is never touched
+
+    // 0 reacts slowly and only sees threats that are about to hit, 1 reacts every tick and looks further ahead
+    f32 skill;
+
+    f32 time_until_decision;
+    GameInput input;    // Held until the next decision
+};
+
+GameBot make(Type<GameBot>, u64 seed, f32 skill);
+
+GameInput game_bot_get_input(GameBot& bot, const GameState& state, f32 delta_time);
@@ -0,0 +1,294 @@
+#include "game_hot_reload.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "core/logger.h"
+#include "core/types.h"
+#include "engine/sprite.h"
+#include "engine/sprite_serialization.h"
+#include "fileio/fileio.h"
+#include "graphics/texture.h"
+#include "platform/platform.h"
+#include "serialization/json.h"
+#include "bullet_patterns.h"
+#include "game_settings.h"
+#include "stage_schedule.h"
+
+// Short so stopping (and the other directory) never waits long on a quiet directory
+static constexpr u32 watch_poll_timeout_ms = 20;
+
+enum struct WatchedFile
+{
+    GAME_SETTINGS,
+    STAGE_SCHEDULE,
+    BULLET_PATTERNS,
+    SPRITESHEET,
+
+    NUM_FILES
+};
+
+static const char* watched_directories[] = {
+    "assets/settings",
+    "assets/art"
+};
+
+static constexpr u64 directory_count = sizeof(watched_directories) / sizeof(watched_directories[0]);
+
+struct WatchedFileInfo
+{
+    u64 directory_index;
+    const char* name;
+    const char* path;
+};
+
+// Applied in this order, the stage schedule is compiled from the game settings
+static const WatchedFileInfo watched_files[(u64) WatchedFile::NUM_FILES] = {
+    { 0, "game_settings.json",   "assets/settings/game_settings.json"   },
+    { 0, "stage_schedule.json",  "assets/settings/stage_schedule.json"  },
+    { 0, "bullet_patterns.json", "assets/settings/bullet_patterns.json" },
+    { 1, "Spritesheet.json",     "assets/art/Spritesheet.json"          },
+};
+
+struct PendingReload
+{
+    // Set by the watch thread once the document is parsed, cleared by hot_reload_apply once it's loaded
+    // The watch thread doesn't touch the rest while it's set
+    std::atomic<bool> ready;
+    bool deferred;      // Only used by hot_reload_apply, the wait was already logged
+
+    // Only used by the watch thread
+    bool changed;
+    f64 change_time;
+
+    f64 parse_time;
+    String json;
+    Json::Document document;
+};
+
+struct HotReloader
+{
+    PlatformFileWatch watches[directory_count];
+    PlatformThread thread;
+    std::atomic<bool> running;
+
+    PendingReload pending[(u64) WatchedFile::NUM_FILES];
+    HotReloadStats stats;
+};
+
+static HotReloader* reloader = nullptr;
+
+static void parse_pending(PendingReload& pending, const WatchedFileInfo& info)
+{
+    const f64 start_time = platform_get_time();
+
+    pending.changed = false;
+    pending.json = file_load_string(ref((char*) info.path));
+    pending.document = {};
+
+    if (!Json::parse_string(pending.json, pending.document))
+    {
+        // Probably saved halfway, the rest of the save comes with another change
+        gn_warn("Couldn't parse changed file, keeping the old values! (path: %)", info.path);
+
+        free(pending.document);
+        free(pending.json);
+        return;
+    }
+
+    pending.parse_time = platform_get_time() - start_time;
+    pending.ready.store(true, std::memory_order_release);
+}
+
+static void watch_main(void*)
+{
+    char filename[256];
+
+    while (reloader->running.load(std::memory_order_acquire))
+    {
+        for (u64 d = 0; d < directory_count; d++)
+        {
+            while (platform_file_watch_poll(reloader->watches[d], watch_poll_timeout_ms, filename, sizeof(filename)))
+            {
+                for (u64 i = 0; i < (u64) WatchedFile::NUM_FILES; i++)
+                {
+                    PendingReload& pending = reloader->pending[i];
+                    if (watched_files[i].directory_index != d || strcmp(watched_files[i].name, filename) != 0)
+                        continue;
+
+                    // Saves usually come as a few events, the latency counts from the first one
+                    if (!pending.changed)
+                        pending.change_time = platform_get_time();
+
+                    pending.changed = true;
+                }
+            }
+        }
+
+        // Files changed again before their last version was applied wait for that to happen first
+        for (u64 i = 0; i < (u64) WatchedFile::NUM_FILES; i++)
+        {
+            PendingReload& pending = reloader->pending[i];
+            if (pending.changed && !pending.ready.load(std::memory_order_acquire))
+                parse_pending(pending, watched_files[i]);
+        }
+    }
+}
+
+static void reload_animations(GameState& state, const Json::Document& document)
+{
+    // Animation indices are hard coded all over the game, a different count means a broken sprite sheet
+    const u64 animation_count = document.start()[ref("animations")].array().size();
+    if (animation_count != state.anims.size)
+    {
+        gn_warn("Reloaded sprite sheet has a different number of animations, ignoring it! (expected: %, actual: %)",
+                state.anims.size, animation_count);
+        return;
+    }
+
+    {   // Every sprite shares the same sheet, names point into the document they came from so they're left alone
+        // The sprites can point into a sprite atlas page instead, so the sheet is found by its path. Reloaded
+        // sprites draw from the sheet's own texture until the next start packs it again.
+        String atlas_path = animation_get_atlas_path(document);
+
+        Texture sheet;
+        if (texture_get_existing(atlas_path, sheet))
+            free(sheet);
+
+        free(atlas_path);
+    }
+
+    for (u64 i = 0; i < state.anims.size; i++)
+        free(state.anims[i].sprites);
+
+    animation_load_from_json(document, state.anims);
+    animation_build_frame_tables(state.anims, state.anim_tables);
+    game_background_upload(state);
+
+    game_state_clamp_animation_frames(state);
+    state.player_size = state.anims[(u64) PlayerState::NORMAL].sprites[0].size;
+}
+
+bool hot_reload_start()
+{
+    gn_assert_with_message(reloader == nullptr, "Hot reloading is already started!");
+
+    reloader = (HotReloader*) platform_allocate(sizeof(HotReloader));
+    platform_zero_memory(reloader, sizeof(HotReloader));
+
+    for (u64 d = 0; d < directory_count; d++)
+    {
+        if (platform_file_watch_start(reloader->watches[d], watched_directories[d]))
+            continue;
+
+        gn_warn("Couldn't watch directory, hot reloading is off! (directory: %)", watched_directories[d]);
+
+        for (u64 i = 0; i < d; i++)
+            platform_file_watch_stop(reloader->watches[i]);
+
+        platform_free(reloader);
+        reloader = nullptr;
+        return false;
+    }
+
+    reloader->running = true;
+
+    const bool started = platform_thread_start(reloader->thread, watch_main, nullptr);
+    gn_assert_with_message(started, "Couldn't start the file watch thread!");
+
+    return true;
+}
+
+void hot_reload_stop()
+{
+    if (!reloader)
+        return;
+
+    reloader->running = false;
+    platform_thread_join(reloader->thread);
+
+    for (u64 d = 0; d < directory_count; d++)
+        platform_file_watch_stop(reloader->watches[d]);
+
+    for (u64 i = 0; i < (u64) WatchedFile::NUM_FILES; i++)
+    {
+        PendingReload& pending = reloader->pending[i];
+        if (!pending.ready)
+            continue;
+
+        free(pending.document);
+        free(pending.json);
+    }
+
+    platform_free(reloader);
+    reloader = nullptr;
+}
+
+void hot_reload_apply(GameState& state, bool defer)
+{
+    if (!reloader)
+        return;
+
+    for (u64 i = 0; i < (u64) WatchedFile::NUM_FILES; i++)
+    {
+        PendingReload& pending = reloader->pending[i];
+        if (!pending.ready.load(std::memory_order_acquire))
+            continue;
+
+        // Left ready, so the watch thread keeps its hands off and the next call without defer loads it
+        if (defer)
+        {
+            if (!pending.deferred)
+                print("Deferred reloading % until the replay stops\n", watched_files[i].path);
+
+            pending.deferred = true;
+            continue;
+        }
+
+        pending.deferred = false;
+
+        switch ((WatchedFile) i)
+        {
+            case WatchedFile::GAME_SETTINGS:
+            {
+                // The current stage keeps its values, the ones after it come from the new settings
+                settings_load_from_json(pending.document);
+                stage_schedule_rebuild(state.stage_schedule);
+            } break;
+
+            case WatchedFile::STAGE_SCHEDULE:
+            {
+                stage_schedule_load_from_json(pending.document, state.stage_schedule);
+            } break;
+
+            case WatchedFile::BULLET_PATTERNS:
+            {
+                // Bullets already fired keep going, the script carries on from the same step
+                bullet_patterns_load_from_json(pending.document, state.bullet_patterns);
+            } break;
+
+            case WatchedFile::SPRITESHEET:
+            {
+                reload_animations(state, pending.document);
+            } break;
+
+            default: break;
+        }
+
+        reloader->stats.reload_count++;
+        reloader->stats.parse_time = pending.parse_time;
+        reloader->stats.latency    = platform_get_time() - pending.change_time;
+
+        print("Reloaded % (parse: % ms, latency: % ms)\n",
+              watched_files[i].path, reloader->stats.parse_time * 1000.0, reloader->stats.latency * 1000.0);
+
+        free(pending.document);
+        free(pending.json);
+        pending.ready.store(false, std::memory_order_release);
+    }
+}
+
+HotReloadStats hot_reload_get_stats()
+{
+    return reloader ? reloader->stats : HotReloadStats {};
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "core/types.h"
+#include "game_state.h"
+
+// Hot reloading of the tuning data (game settings, stage schedule, bullet patterns and sprite sheet)
+// A background thread watches the asset directories, reads and parses a file as soon as it
+// changes and hands the parsed document over. hot_reload_apply then loads it between two
+// ticks, so a tick never sees half of the old values and half of the new ones.
+//
+// The player settings aren't watched since the game writes them itself.
+
+struct HotReloadStats
+{
+    u32 reload_count;
+
+    // For the last reload, in seconds
+    f64 parse_time;     // Reading and parsing on the watch thread
+    f64 latency;        // From noticing the change to the new values being in use
+};
+
+// Returns false if the directories can't be watched, the game runs fine without it
+bool hot_reload_start();
+void hot_reload_stop();
+
+// Call between ticks, loads every file that was parsed since the last call
+// With defer the files wait until a later call without it, for replays that have no record of a reload.
+void hot_reload_apply(GameState& state, bool defer);
+
+HotReloadStats hot_reload_get_stats();
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/compiler_utils.h"
+#include "core/input.h"
+#include "player_settings.h"
+
+// Buttons that affect the gameplay, stored as bit flags
+namespace GameButton
+{
+    static constexpr u8 UP    = (1 << 0);
+    static constexpr u8 LEFT  = (1 << 1);
+    static constexpr u8 DOWN  = (1 << 2);
+    static constexpr u8 RIGHT = (1 << 3);
+    static constexpr u8 SHOOT = (1 << 4);
+    static constexpr u8 LAZER = (1 << 5);
+}
+
+// All the input the gameplay reads in a single tick
+// The gameplay never polls the keyboard directly so the input can also come from a replay
+struct GameInput
+{
+    u8 buttons;
+};
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+bool game_input_get(const GameInput& input, const u8 button)
+{
+    return (input.buttons & button) != 0;
+}
+
+inline GameInput game_input_from_keyboard(const ControlScheme control_scheme)
+{
+    GameInput input = {};
+
+    input.buttons |= GameButton::UP    * get_direction_input(Direction::UP,    control_scheme);
+    input.buttons |= GameButton::LEFT  * get_direction_input(Direction::LEFT,  control_scheme);
+    input.buttons |= GameButton::DOWN  * get_direction_input(Direction::DOWN,  control_scheme);
+    input.buttons |= GameButton::RIGHT * get_direction_input(Direction::RIGHT, control_scheme);
+    input.buttons |= GameButton::SHOOT * Input::get_key(Key::SPACE);
+    input.buttons |= GameButton::LAZER * Input::get_key(Key::Z);
+
+    return input;
+}
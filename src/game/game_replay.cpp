@@ -0,0 +1,271 @@
+#include "game_replay.h"
+
+#include <cstdio>
+
+#include "application/application.h"
+#include "containers/bytes.h"
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "fileio/fileio.h"
+#include "math/common.h"
+#include "serialization/binary.h"
+#include "game_input.h"
+#include "game_state.h"
+
+// Bump this whenever the layout or the simulation changes in a way that breaks old replays
+static constexpr u32 replay_version = 1;
+
+char replay_file_name[] = "last.replay";
+const u64 replay_file_name_size = sizeof(replay_file_name) - 1;
+
+static constexpr u8 max_frame_run = 0xff;
+
+static void record_frame(Replay& replay, const GameInput input)
+{
+    const u64 size = replay.frames.size;
+
+    if (size >= 2 && replay.frames[size - 2] == input.buttons && replay.frames[size - 1] < max_frame_run)
+        replay.frames[size - 1]++;
+    else
+    {
+        append(replay.frames, input.buttons);
+        append(replay.frames, (u8) 1);
+    }
+
+    replay.tick_count++;
+}
+
+static bool peek_frame(const Replay& replay, GameInput& out_input)
+{
+    if (replay.frame_offset + 1 >= replay.frames.size)
+        return false;
+
+    out_input.buttons = replay.frames[replay.frame_offset];
+    return true;
+}
+
+static void consume_frame(Replay& replay)
+{
+    replay.frame_run++;
+
+    if (replay.frame_run >= replay.frames[replay.frame_offset + 1])
+    {
+        replay.frame_offset += 2;
+        replay.frame_run = 0;
+    }
+}
+
+static void restart_game(Application& app, Replay& replay, GameState& state)
+{
+    replay.time = replay.start_time;
+    replay.accumulator = 0.0f;
+
+    app.time = replay.time;
+
+    Math::random_seed(state.rng, replay.seed);
+    game_state_reset(app, state);
+    state.current_screen = GameScreen::GAME;
+}
+
+void replay_start_recording(Application& app, Replay& replay, GameState& state, u64 seed, f32 time_step)
+{
+    if (replay.frames.data == nullptr)
+        replay.frames = make<DynamicArray<u8>>();
+
+    clear(replay.frames);
+
+    replay.mode        = ReplayMode::RECORDING;
+    replay.seed        = seed;
+    replay.time_step   = time_step;
+    replay.start_time  = app.time;
+    replay.tick_count  = 0;
+
+    restart_game(app, replay, state);
+}
+
+void replay_start_playback(Application& app, Replay& replay, GameState& state)
+{
+    gn_assert_with_message(replay.time_step > 0.0f, "Replay doesn't have a valid time step! (time step: %)", replay.time_step);
+
+    replay.mode         = ReplayMode::PLAYBACK;
+    replay.frame_offset = 0;
+    replay.frame_run    = 0;
+
+    restart_game(app, replay, state);
+}
+
+void replay_stop(Replay& replay)
+{
+    replay.mode = ReplayMode::NONE;
+}
+
+bool replay_step(Application& app, Replay& replay, GameState& state)
+{
+    switch (replay.mode)
+    {
+        case ReplayMode::RECORDING:
+        {
+            // Only record actual gameplay, going back to the main menu or dying ends the recording
+            if (!(state.current_screen & GameScreen::GAME) || (state.current_screen & GameScreen::GAME_OVER))
+            {
+                replay_stop(replay);
+                return false;
+            }
+        } break;
+
+        case ReplayMode::PLAYBACK:
+        {
+            if (!peek_frame(replay, state.input))
+            {
+                replay_stop(replay);
+                return false;
+            }
+        } break;
+
+        default:
+            return false;
+    }
+
+    // Paused ticks don't simulate anything so they're neither recorded nor consumed
+    if (state.current_screen & (GameScreen::PAUSE_MENU | GameScreen::SETTINGS_MENU))
+        return true;
+
+    app.time = replay.time;
+    app.delta_time = replay.time_step;
+
+    game_state_simulate(app, state);
+
+    if (replay.mode == ReplayMode::RECORDING)
+        record_frame(replay, state.input);
+    else
+        consume_frame(replay);
+
+    replay.time += replay.time_step;
+
+    return true;
+}
+
+void replay_update(Application& app, Replay& replay, GameState& state)
+{
+    // Edge triggered keys must only be looked at once per frame
+    game_state_update_screens(state);
+
+    const f32 frame_delta_time = app.delta_time;
+
+    if (state.current_screen & (GameScreen::PAUSE_MENU | GameScreen::SETTINGS_MENU))
+        replay.accumulator = 0.0f;
+    else
+        replay.accumulator += frame_delta_time;
+
+    while (replay.accumulator >= replay.time_step)
+    {
+        replay.accumulator -= replay.time_step;
+
+        if (replay.mode == ReplayMode::RECORDING)
+            state.input = game_input_from_keyboard(state.player_settings.control_scheme);
+
+        if (!replay_step(app, replay, state))
+            break;
+    }
+
+    // Rendering runs on the replay clock too, otherwise animations would jump
+    app.time = replay.time;
+    app.delta_time = frame_delta_time;
+
+    // Whatever is left in the accumulator is how far the frame is into the next tick
+    state.render_alpha = clamp(replay.accumulator / replay.time_step, 0.0f, 1.0f);
+}
+
+Bytes replay_encode_to_bytes(const Replay& replay)
+{
+    DynamicArray<u8> bytes = make<DynamicArray<u8>>(replay.frames.size + 64);
+
+    append(bytes, Binary::OBJECT_START);
+
+    append(bytes, Binary::INTEGER_U32);
+    Binary::append_integer(bytes, replay_version);
+
+    append(bytes, Binary::INTEGER_U64);
+    Binary::append_integer(bytes, replay.seed);
+
+    append(bytes, Binary::FLOAT_32);
+    Binary::append_float(bytes, replay.time_step);
+
+    append(bytes, Binary::FLOAT_32);
+    Binary::append_float(bytes, replay.start_time);
+
+    append(bytes, Binary::INTEGER_U64);
+    Binary::append_integer(bytes, replay.tick_count);
+
+    Binary::append_bytes(bytes, replay.frames.data, replay.frames.size);
+
+    append(bytes, Binary::OBJECT_END);
+
+    return Bytes { bytes.data, bytes.size };
+}
+
+bool replay_load_from_bytes(const Bytes& bytes, Replay& replay)
+{
+    if (bytes.size == 0 || bytes[0] != Binary::OBJECT_START)
+        return false;
+
+    u64 offset = 1; // Skip object start byte
+
+    const u32 version = Binary::get<u32>(bytes, offset);
+    if (version != replay_version)
+    {
+        gn_warn("Replay was recorded with a different version! (replay version: %, expected version: %)", version, replay_version);
+        return false;
+    }
+
+    replay.seed       = Binary::get<u64>(bytes, offset);
+    replay.time_step  = Binary::get<f32>(bytes, offset);
+    replay.start_time = Binary::get<f32>(bytes, offset);
+    replay.tick_count = Binary::get<u64>(bytes, offset);
+
+    {   // Input Frames
+        Bytes frame_bytes = Binary::get<Bytes>(bytes, offset);
+
+        if (replay.frames.data == nullptr)
+            replay.frames = make<DynamicArray<u8>>(frame_bytes.size);
+
+        clear(replay.frames);
+        append_many(replay.frames, frame_bytes.data, frame_bytes.size);
+    }
+
+    gn_assert_with_message(offset == bytes.size - 1, "For some reason there's extra data in the replay bytes! (file size: %, stopped parsing at: %)", bytes.size, offset);
+
+    replay.mode = ReplayMode::NONE;
+    return true;
+}
+
+void replay_save_file(const String& filepath, const Replay& replay)
+{
+    Bytes bytes = replay_encode_to_bytes(replay);
+    file_write_bytes(filepath, bytes);
+    free(bytes);
+}
+
+bool replay_load_file(const String& filepath, Replay& replay)
+{
+    // file_load_bytes asserts on missing files but having no replay is fine
+    FILE* file = fopen(filepath.data, "rb");
+    if (!file)
+        return false;
+
+    fclose(file);
+
+    Bytes bytes = file_load_bytes(filepath);
+    const bool success = replay_load_from_bytes(bytes, replay);
+    free(bytes);
+
+    return success;
+}
+
+void free(Replay& replay)
+{
+    free(replay.frames);
+    replay = {};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "application/application.h"
+#include "containers/bytes.h"
+#include "containers/darray.h"
+#include "containers/string.h"
+#include "core/types.h"
+#include "game_input.h"
+#include "game_state.h"
+
+// A replay stores the rng seed, the fixed time step and the input of every simulated tick.
+// All gameplay randomness comes from the seeded rng and all gameplay time comes from the
+// replay clock, so feeding the same input back reproduces the game bit for bit.
+
+enum struct ReplayMode : u8
+{
+    NONE,
+    RECORDING,
+    PLAYBACK
+};
+
+struct Replay
+{
+    ReplayMode mode;
+
+    u64 seed;
+    f32 time_step;
+    f32 start_time;
+    u64 tick_count;
+
+    // Run length encoded input, stored as (buttons, run length) pairs
+    DynamicArray<u8> frames;
+
+    // Playback Cursor
+    u64 frame_offset;
+    u8  frame_run;
+
+    // Simulation Clock
+    f32 time;
+    f32 accumulator;
+};
+
+static constexpr f32 replay_default_time_step = 1.0f / 60.0f;
+
+extern char replay_file_name[];
+extern const u64 replay_file_name_size;
+
+void replay_start_recording(Application& app, Replay& replay, GameState& state, u64 seed, f32 time_step = replay_default_time_step);
+void replay_start_playback(Application& app, Replay& replay, GameState& state);
+void replay_stop(Replay& replay);
+
+// Simulates a single tick, returns false once the replay has stopped
+// While recording, the input for the tick is taken from state.input so any input provider can be recorded
+bool replay_step(Application& app, Replay& replay, GameState& state);
+
+// Simulates as many ticks as fit in the frame time, used in place of game_state_update
+void replay_update(Application& app, Replay& replay, GameState& state);
+
+Bytes replay_encode_to_bytes(const Replay& replay);
+bool  replay_load_from_bytes(const Bytes& bytes, Replay& replay);
+
+void replay_save_file(const String& filepath, const Replay& replay);
+bool replay_load_file(const String& filepath, Replay& replay);
+
+void free(Replay& replay);
@@ -24,7 +24,7 @@ void save_settings(const Settings& settings, const WindowStyle window_style)
 
     {   // Dynamic Background
         append(builder, ref(", \"dynamic_background\": "));
-        append(builder, ref(settings.dynamic_background ? "true" : "false"));
+        append(builder, settings.dynamic_background ? ref("true") : ref("false"));
     }
 
     {   // Window Style
@@ -43,7 +43,7 @@ void save_settings(const Settings& settings, const WindowStyle window_style)
 
     {   // Mute Audio
         append(builder, ref(", \"mute_audio\": "));
-        append(builder, ref(settings.mute_audio ? "true" : "false"));
+        append(builder, settings.mute_audio ? ref("true") : ref("false"));
     }
 
     {   // High Score
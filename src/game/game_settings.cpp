@@ -3,6 +3,31 @@
 #include "core/types.h"
 #include "serialization/json.h"
 
+static void load_particle_emitter(const Json::Value& j_emitter, ParticleEmitter& emitter)
+{
+    emitter.count = j_emitter[ref("count")].int64();
+
+    const auto& j_speed = j_emitter[ref("speed")];
+    emitter.min_speed = j_speed[ref("min")].float64();
+    emitter.max_speed = j_speed[ref("max")].float64();
+
+    const auto& j_lifetime = j_emitter[ref("lifetime")];
+    emitter.min_lifetime = j_lifetime[ref("min")].float64();
+    emitter.max_lifetime = j_lifetime[ref("max")].float64();
+
+    const auto& j_start_color = j_emitter[ref("start_color")];
+    emitter.start_color.r = j_start_color[ref("r")].float64();
+    emitter.start_color.g = j_start_color[ref("g")].float64();
+    emitter.start_color.b = j_start_color[ref("b")].float64();
+    emitter.start_color.a = j_start_color[ref("a")].float64();
+
+    const auto& j_end_color = j_emitter[ref("end_color")];
+    emitter.end_color.r = j_end_color[ref("r")].float64();
+    emitter.end_color.g = j_end_color[ref("g")].float64();
+    emitter.end_color.b = j_end_color[ref("b")].float64();
+    emitter.end_color.a = j_end_color[ref("a")].float64();
+}
+
 void settings_load_from_json(const Json::Document& document)
 {
     const auto& j_data = document.start();
@@ -160,4 +185,16 @@ void settings_load_from_json(const Json::Document& document)
         GameSettings::screen_shake_amplitude_enemy = j_data[ref("screen_shake_amplitude_enemy")].float64();
         GameSettings::screen_shake_enemy_kill_duration = j_data[ref("screen_shake_enemy_kill_duration")].float64();
     }
+
+    {   // Particles
+        const auto& j_acceleration = j_data[ref("particle_acceleration")];
+        GameSettings::particle_acceleration.x = j_acceleration[ref("x")].float64();
+        GameSettings::particle_acceleration.y = j_acceleration[ref("y")].float64();
+
+        GameSettings::particle_drag = j_data[ref("particle_drag")].float64();
+        GameSettings::particle_size = j_data[ref("particle_size")].float64();
+
+        load_particle_emitter(j_data[ref("explosion_particles")], GameSettings::explosion_particles);
+        load_particle_emitter(j_data[ref("power_shot_particles")], GameSettings::power_shot_particles);
+    }
 }
\ No newline at end of file
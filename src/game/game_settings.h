@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/types.h"
+#include "engine/particles.h"
 #include "math/vecs/vector2.h"
 #include "serialization/json.h"
 
@@ -99,6 +100,13 @@ namespace GameSettings
     extern f32 screen_shake_amplitude_lazer;
     extern f32 screen_shake_amplitude_enemy;
     extern f32 screen_shake_enemy_kill_duration;
+
+    // Particles
+    extern Vector2 particle_acceleration;
+    extern f32 particle_drag;
+    extern f32 particle_size;
+    extern ParticleEmitter explosion_particles;
+    extern ParticleEmitter power_shot_particles;
 };
 
 void settings_load_from_json(const Json::Document& document);
\ No newline at end of file
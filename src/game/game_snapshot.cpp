@@ -0,0 +1,446 @@
+#include "game_snapshot.h"
+
+#include "application/application.h"
+#include "containers/bytes.h"
+#include "containers/darray.h"
+#include "core/coroutines.h"
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+#include "platform/platform.h"
+#include "serialization/binary.h"
+#include "game_state.h"
+
+// Bump this whenever GameState changes, or anything that is stored as raw bytes in it (e.g. AnimationData)
+static constexpr u32 snapshot_version = 5;
+
+// Tags, array lengths and scalar values, the columns are added on top of this
+static constexpr u64 snapshot_header_size = 2048;
+
+// Writing
+
+static inline void append_u32(DynamicArray<u8>& bytes, const u32 value)
+{
+    append(bytes, Binary::INTEGER_U32);
+    Binary::append_integer(bytes, value);
+}
+
+static inline void append_s32(DynamicArray<u8>& bytes, const s32 value)
+{
+    append(bytes, Binary::INTEGER_S32);
+    Binary::append_integer(bytes, value);
+}
+
+static inline void append_u64(DynamicArray<u8>& bytes, const u64 value)
+{
+    append(bytes, Binary::INTEGER_U64);
+    Binary::append_integer(bytes, value);
+}
+
+static inline void append_f32(DynamicArray<u8>& bytes, const f32 value)
+{
+    append(bytes, Binary::FLOAT_32);
+    Binary::append_float(bytes, value);
+}
+
+static inline void append_f64(DynamicArray<u8>& bytes, const f64 value)
+{
+    append(bytes, Binary::FLOAT_64);
+    Binary::append_float(bytes, value);
+}
+
+static inline void append_bool(DynamicArray<u8>& bytes, const bool value)
+{
+    append(bytes, value ? Binary::BOOLEAN_TRUE : Binary::BOOLEAN_FALSE);
+}
+
+static inline void append_vector2(DynamicArray<u8>& bytes, const Vector2 value)
+{
+    append_f32(bytes, value.x);
+    append_f32(bytes, value.y);
+}
+
+// Plain structs are stored as they are in memory
+template <typename T>
+static inline void append_raw(DynamicArray<u8>& bytes, const T& value)
+{
+    Binary::append_bytes(bytes, (const u8*) &value, sizeof(T));
+}
+
+template <typename T>
+static inline void append_column(DynamicArray<u8>& bytes, const DynamicArray<T>& column)
+{
+    Binary::append_bytes(bytes, (const u8*) column.data, column.size * sizeof(T));
+}
+
+static void append_entities(DynamicArray<u8>& bytes, const EntityData& entities)
+{
+    append_column(bytes, entities.positions);
+    append_column(bytes, entities.animations);
+
+    if (entities.steered)
+    {
+        append_column(bytes, entities.targets);
+        append_column(bytes, entities.velocities);
+    }
+}
+
+static void append_bullets(DynamicArray<u8>& bytes, const BulletPool& pool)
+{
+    Binary::append_bytes(bytes, (const u8*) pool.position_x, pool.count * sizeof(f32));
+    Binary::append_bytes(bytes, (const u8*) pool.position_y, pool.count * sizeof(f32));
+    Binary::append_bytes(bytes, (const u8*) pool.velocity_x, pool.count * sizeof(f32));
+    Binary::append_bytes(bytes, (const u8*) pool.velocity_y, pool.count * sizeof(f32));
+}
+
+static void append_coroutine(DynamicArray<u8>& bytes, const Coroutine& co)
+{
+    append_raw(bytes, co.line);
+    append_f64(bytes, co.prev_time);
+    append_u64(bytes, co.depth);
+
+    // Stack variables outlive a single resume (stack_ptr is reset at the end of each one) so the whole frame is stored
+    append_raw(bytes, co.stack_frame);
+    append_u64(bytes, co.stack_ptr);
+
+    append_bool(bytes, co.running);
+}
+
+template <typename T>
+static inline u64 column_size(const DynamicArray<T>& column)
+{
+    return column.size * sizeof(T) + 9; // data + tag + size
+}
+
+static u64 entities_size(const EntityData& entities)
+{
+    u64 size = column_size(entities.positions) + column_size(entities.animations);
+
+    if (entities.steered)
+        size += column_size(entities.targets) + column_size(entities.velocities);
+
+    return size;
+}
+
+static u64 bullets_size(const BulletPool& pool)
+{
+    return 4 * (pool.count * sizeof(f32) + 9);
+}
+
+// Reading
+
+template <typename T>
+static inline void get_raw(const Bytes& bytes, u64& offset, T& out_value)
+{
+    const Bytes data = Binary::get<Bytes>(bytes, offset);
+    gn_assert_with_message(data.size == sizeof(T), "Snapshot value has the wrong size! (value size: %, expected size: %, offset: %)", data.size, sizeof(T), offset);
+
+    platform_copy_memory(&out_value, data.data, sizeof(T));
+}
+
+template <typename T>
+static inline void get_column(const Bytes& bytes, u64& offset, DynamicArray<T>& column)
+{
+    const Bytes data = Binary::get<Bytes>(bytes, offset);
+    gn_assert_with_message(data.size % sizeof(T) == 0, "Snapshot column doesn't hold whole elements! (column size: %, element size: %, offset: %)", data.size, sizeof(T), offset);
+
+    const u64 count = data.size / sizeof(T);
+
+    // Arrays only ever grow here, after the first restore this is a single copy
+    if (column.capacity < count)
+        resize(column, count);
+
+    platform_copy_memory(column.data, data.data, data.size);
+    column.size = count;
+}
+
+static inline Vector2 get_vector2(const Bytes& bytes, u64& offset)
+{
+    Vector2 value;
+    value.x = Binary::get<f32>(bytes, offset);
+    value.y = Binary::get<f32>(bytes, offset);
+    return value;
+}
+
+static void get_entities(const Bytes& bytes, u64& offset, EntityData& entities)
+{
+    get_column(bytes, offset, entities.positions);
+    get_column(bytes, offset, entities.animations);
+
+    if (entities.steered)
+    {
+        get_column(bytes, offset, entities.targets);
+        get_column(bytes, offset, entities.velocities);
+    }
+
+    clear(entities.previous_positions);
+    append_many(entities.previous_positions, entities.positions.data, entities.positions.size);
+    entities.moved = false;
+}
+
+static void get_floats(const Bytes& bytes, u64& offset, f32* out_floats, u64 count)
+{
+    const Bytes data = Binary::get<Bytes>(bytes, offset);
+    gn_assert_with_message(data.size == count * sizeof(f32), "Snapshot bullet column has the wrong size! (column size: %, expected size: %, offset: %)", data.size, count * sizeof(f32), offset);
+
+    platform_copy_memory(out_floats, data.data, data.size);
+}
+
+static void get_bullets(const Bytes& bytes, u64& offset, BulletPool& pool, u64 count)
+{
+    gn_assert_with_message(count <= pool.capacity, "Snapshot has more bullets than the pool can hold! (count: %, capacity: %)", count, pool.capacity);
+
+    get_floats(bytes, offset, pool.position_x, count);
+    get_floats(bytes, offset, pool.position_y, count);
+    get_floats(bytes, offset, pool.velocity_x, count);
+    get_floats(bytes, offset, pool.velocity_y, count);
+    pool.count = count;
+}
+
+static void get_coroutine(const Bytes& bytes, u64& offset, Coroutine& co)
+{
+    get_raw(bytes, offset, co.line);
+    co.prev_time = Binary::get<f64>(bytes, offset);
+    co.depth     = Binary::get<u64>(bytes, offset);
+
+    get_raw(bytes, offset, co.stack_frame);
+    co.stack_ptr = Binary::get<u64>(bytes, offset);
+
+    co.running = Binary::get<bool>(bytes, offset);
+}
+
+void game_state_snapshot(const Application& app, const GameState& state, DynamicArray<u8>& bytes)
+{
+    {   // Reserve everything up front so the columns never trigger a reallocation
+        u64 size = snapshot_header_size;
+
+        for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+        {
+            size += column_size(state.enemy_slots[i]);
+            size += entities_size(state.enemies[i]);
+        }
+
+        size += column_size(state.formation.free_bits);
+
+        size += entities_size(state.player_bullets);
+        size += entities_size(state.enemy_bullets);
+        size += entities_size(state.explosions);
+        size += entities_size(state.power_shot_explosions);
+        size += entities_size(state.pickups);
+        size += entities_size(state.kamikaze_enemies);
+
+        size += bullets_size(state.pattern_bullets);
+        size += column_size(state.pickup_deck);
+        size += column_size(state.star_positions);
+        size += column_size(state.star_sprite_indices);
+
+        if (bytes.data == nullptr || bytes.capacity <= size)
+            resize(bytes, size + 1);
+
+        clear(bytes);
+    }
+
+    append(bytes, Binary::OBJECT_START);
+    append_u32(bytes, snapshot_version);
+
+    {   // Simulation
+        append_f32(bytes, app.time);
+        append_u64(bytes, state.rng.state);
+        append_raw(bytes, state.input);
+
+        append_coroutine(bytes, state.state_co);
+        append_coroutine(bytes, state.lazer_co);
+
+        append_u32(bytes, state.current_screen);
+        append_bool(bytes, state.new_high_score);
+    }
+
+    {   // Player
+        append_s32(bytes, state.player_lives);
+        append_s32(bytes, state.player_kill_streak);
+        append_u32(bytes, state.player_score);
+
+        append_vector2(bytes, state.player_position);
+        append_vector2(bytes, state.player_size);
+        append_f32(bytes, state.player_time_since_last_shot);
+        append_u64(bytes, state.player_previous_animation_index);
+        append_raw(bytes, state.player_animation);
+
+        append_u32(bytes, state.player_bullets_per_shot);
+        append_raw(bytes, state.player_equipped_bullet_type);
+
+        append_s32(bytes, state.player_power_shot_ammo);
+        append_s32(bytes, state.player_extra_shot_ammo);
+        append_s32(bytes, state.lazer_drops);
+    }
+
+    {   // Enemies
+        append_f32(bytes, state.enemy_time_since_last_shot);
+        append_f32(bytes, state.enemy_time_since_last_kamikaze);
+        append_f32(bytes, state.enemy_time_since_last_rearrangement);
+
+        append_raw(bytes, state.current_stage);
+        append_u32(bytes, state.enemy_count_multiplier);
+
+        for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+            append_column(bytes, state.enemy_slots[i]);
+
+        // Slot positions are rebuilt from the layout
+        append_raw(bytes, state.formation.layout);
+        append_column(bytes, state.formation.free_bits);
+        append_u64(bytes, state.formation.free_count);
+        append_u64(bytes, state.formation.first_free_word);
+        append_f32(bytes, state.time_since_screen_shake_start);
+
+        append_u32(bytes, state.bullet_wave_step);
+        append_u32(bytes, state.bullet_wave_fire_count);
+        append_f32(bytes, state.bullet_wave_time);
+    }
+
+    {   // Entities
+        append_entities(bytes, state.player_bullets);
+        append_entities(bytes, state.enemy_bullets);
+
+        for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+            append_entities(bytes, state.enemies[i]);
+
+        append_entities(bytes, state.explosions);
+        append_entities(bytes, state.power_shot_explosions);
+        append_entities(bytes, state.pickups);
+        append_entities(bytes, state.kamikaze_enemies);
+
+        append_u64(bytes, state.pattern_bullets.count);
+        append_bullets(bytes, state.pattern_bullets);
+        append_f32(bytes, state.pattern_bullets.last_time_step);
+
+        append_column(bytes, state.pickup_deck);
+        append_u64(bytes, state.pickup_deck_index);
+
+        append_column(bytes, state.star_positions);
+        append_column(bytes, state.star_sprite_indices);
+    }
+
+    {   // Lazer
+        append_raw(bytes, state.lazer_chunk);
+        append_u32(bytes, state.lazer_charge);
+        append_vector2(bytes, state.lazer_position);
+        append_u32(bytes, state.lazer_start);
+        append_u32(bytes, state.lazer_end);
+        append_bool(bytes, state.is_lazer_active);
+    }
+
+    append(bytes, Binary::OBJECT_END);
+}
+
+bool game_state_restore(Application& app, GameState& state, const Bytes& bytes)
+{
+    if (bytes.size == 0 || bytes[0] != Binary::OBJECT_START)
+        return false;
+
+    u64 offset = 1; // Skip object start byte
+
+    const u32 version = Binary::get<u32>(bytes, offset);
+    if (version != snapshot_version)
+    {
+        gn_warn("Snapshot was taken with a different version! (snapshot version: %, expected version: %)", version, snapshot_version);
+        return false;
+    }
+
+    {   // Simulation
+        app.time = Binary::get<f32>(bytes, offset);
+        state.rng.state = Binary::get<u64>(bytes, offset);
+        get_raw(bytes, offset, state.input);
+
+        get_coroutine(bytes, offset, state.state_co);
+        get_coroutine(bytes, offset, state.lazer_co);
+
+        state.current_screen = Binary::get<u32>(bytes, offset);
+        state.new_high_score = Binary::get<bool>(bytes, offset);
+    }
+
+    {   // Player
+        state.player_lives       = Binary::get<s32>(bytes, offset);
+        state.player_kill_streak = Binary::get<s32>(bytes, offset);
+        state.player_score       = Binary::get<u32>(bytes, offset);
+
+        state.player_position                 = get_vector2(bytes, offset);
+        state.player_size                     = get_vector2(bytes, offset);
+        state.player_time_since_last_shot     = Binary::get<f32>(bytes, offset);
+        state.player_previous_animation_index = Binary::get<u64>(bytes, offset);
+        get_raw(bytes, offset, state.player_animation);
+
+        state.player_bullets_per_shot = Binary::get<u32>(bytes, offset);
+        get_raw(bytes, offset, state.player_equipped_bullet_type);
+
+        state.player_power_shot_ammo = Binary::get<s32>(bytes, offset);
+        state.player_extra_shot_ammo = Binary::get<s32>(bytes, offset);
+        state.lazer_drops            = Binary::get<s32>(bytes, offset);
+    }
+
+    {   // Enemies
+        state.enemy_time_since_last_shot          = Binary::get<f32>(bytes, offset);
+        state.enemy_time_since_last_kamikaze      = Binary::get<f32>(bytes, offset);
+        state.enemy_time_since_last_rearrangement = Binary::get<f32>(bytes, offset);
+
+        get_raw(bytes, offset, state.current_stage);
+        state.enemy_count_multiplier = Binary::get<u32>(bytes, offset);
+
+        for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+            get_column(bytes, offset, state.enemy_slots[i]);
+
+        FormationLayout layout;
+        get_raw(bytes, offset, layout);
+        formation_set_layout(state.formation, layout);
+
+        get_column(bytes, offset, state.formation.free_bits);
+        state.formation.free_count      = Binary::get<u64>(bytes, offset);
+        state.formation.first_free_word = Binary::get<u64>(bytes, offset);
+        state.time_since_screen_shake_start = Binary::get<f32>(bytes, offset);
+
+        state.bullet_wave_step       = Binary::get<u32>(bytes, offset);
+        state.bullet_wave_fire_count = Binary::get<u32>(bytes, offset);
+        state.bullet_wave_time       = Binary::get<f32>(bytes, offset);
+    }
+
+    {   // Entities
+        get_entities(bytes, offset, state.player_bullets);
+        get_entities(bytes, offset, state.enemy_bullets);
+
+        for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+            get_entities(bytes, offset, state.enemies[i]);
+
+        get_entities(bytes, offset, state.explosions);
+        get_entities(bytes, offset, state.power_shot_explosions);
+        get_entities(bytes, offset, state.pickups);
+        get_entities(bytes, offset, state.kamikaze_enemies);
+
+        const u64 pattern_bullet_count = Binary::get<u64>(bytes, offset);
+        get_bullets(bytes, offset, state.pattern_bullets, pattern_bullet_count);
+        state.pattern_bullets.last_time_step = Binary::get<f32>(bytes, offset);
+
+        get_column(bytes, offset, state.pickup_deck);
+        state.pickup_deck_index = Binary::get<u64>(bytes, offset);
+
+        get_column(bytes, offset, state.star_positions);
+        get_column(bytes, offset, state.star_sprite_indices);
+    }
+
+    {   // Lazer
+        get_raw(bytes, offset, state.lazer_chunk);
+        state.lazer_charge    = Binary::get<u32>(bytes, offset);
+        state.lazer_position  = get_vector2(bytes, offset);
+        state.lazer_start     = Binary::get<u32>(bytes, offset);
+        state.lazer_end       = Binary::get<u32>(bytes, offset);
+        state.is_lazer_active = Binary::get<bool>(bytes, offset);
+    }
+
+    gn_assert_with_message(offset == bytes.size - 1, "For some reason there's extra data in the snapshot bytes! (snapshot size: %, stopped parsing at: %)", bytes.size, offset);
+
+    // Previous positions are only used for rendering so they aren't stored, the restored state isn't blended
+    state.player_previous_position = state.player_position;
+
+    // The stars came from the snapshot as well
+    game_background_upload(state);
+
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "application/application.h"
+#include "containers/bytes.h"
+#include "containers/darray.h"
+#include "core/types.h"
+#include "game_state.h"
+
+// A snapshot holds every piece of gameplay state that changes while simulating, including
+// the rng, the coroutines and the simulation clock. Assets (animations), settings and the
+// window dependent playground are not part of it.
+//
+// Every entity column is stored as a single contiguous byte array so taking a snapshot is a
+// handful of memcpys into a reused buffer and restoring is one copy per column into the
+// already allocated arrays of the state.
+//
+// Coroutines store raw line numbers, so snapshots are only valid for the executable that
+// took them. They are meant for rewinding, rollback and checkpoints, not for save files.
+
+// Clears the given bytes and writes the snapshot into them, reuse the same array to avoid allocations
+void game_state_snapshot(const Application& app, const GameState& state, DynamicArray<u8>& bytes);
+
+// Returns false (and leaves the state untouched) if the snapshot has a different version
+bool game_state_restore(Application& app, GameState& state, const Bytes& bytes);
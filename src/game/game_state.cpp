@@ -4,11 +4,13 @@
 #include "audio/audio.h"
 #include "core/coroutines.h"
 #include "core/input.h"
+#include "core/jobs.h"
 #include "core/utils.h"
 #include "containers/bytes.h"
 #include "containers/darray.h"
 #include "fileio/fileio.h"
 #include "engine/imgui.h"
+#include "engine/particles.h"
 #include "engine/sprite.h"
 #include "math/math.h"
 #include "serialization/json.h"
@@ -24,6 +26,9 @@ constexpr u64 enemy_explosion_animation_index = 10;
 constexpr u64 power_shot_explosion_animation_index = 23;
 constexpr u64 stars_animation_index = 24;
 
+constexpr u64 max_particle_count = 1 << 17;
+constexpr u64 max_pattern_bullet_count = 1 << 16;
+
 constexpr f32 min_volume = 0.0f;
 constexpr f32 max_volume = 100.0f;
 
@@ -49,20 +54,54 @@ static Audio::Source source_lazer;
 static Audio::Source source_main_menu;
 
 static DynamicArray<u64> enemy_list = {};           // For spawning enemies
-static DynamicArray<PickupType> pickup_deck = {};   // For spawning pickups
-static u64 pickup_deck_index = 0;
+static DynamicArray<f32> enemy_jitters = {};        // Drawn up front so enemy movement can run in parallel
+static DynamicArray<u8>  collision_candidates = {}; // Colliders that touch at least one enemy this tick
+
+// Batch sizes for the parallel parts of the simulation, smaller ranges stay on the calling thread
+constexpr u64 enemy_movement_batch_size = 256;
+constexpr u64 animation_batch_size      = 512;
+constexpr u64 collision_batch_tests     = 4096;     // AABB tests per batch
+
+// One bit per piece of simulation data, used as the read/write sets of the parallel phases
+namespace SimulationData
+{
+    static constexpr u64 ANIMATIONS            = (1 << 0);  // The animation assets
+    static constexpr u64 PLAYER_BULLETS        = (1 << 1);
+    static constexpr u64 ENEMY_BULLETS         = (1 << 2);
+    static constexpr u64 FLYING_ENEMIES        = (1 << 3);
+    static constexpr u64 DROPPER_ENEMIES       = (1 << 4);
+    static constexpr u64 KAMIKAZE_TYPE_ENEMIES = (1 << 5);  // Kamikaze type enemies still in formation
+    static constexpr u64 EXPLOSIONS            = (1 << 6);
+    static constexpr u64 POWER_SHOT_EXPLOSIONS = (1 << 7);
+    static constexpr u64 PICKUPS               = (1 << 8);
+    static constexpr u64 KAMIKAZE_ENEMIES      = (1 << 9);
+}
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
-static void entity_init(EntityData& entities)
+static void entity_init(EntityData& entities, bool steered = false)
 {
     entities.animations = make<DynamicArray<AnimationData>>();
     entities.positions  = make<DynamicArray<Vector2>>();
+    entities.previous_positions = make<DynamicArray<Vector2>>();
+    entities.moved = false;
+
+    entities.targets    = make<DynamicArray<Vector2>>();
+    entities.velocities = make<DynamicArray<Vector2>>();
+    entities.steered = steered;
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
 static void entity_add(EntityData& entities, const Vector2 position, u64 animation_index, f32 time)
 {
     append(entities.positions, position);
+    append(entities.previous_positions, position);
+
+    // Steered entities start on their target, the caller points them somewhere
+    if (entities.steered)
+    {
+        append(entities.targets, position);
+        append(entities.velocities, Vector2 { 0.0f, 0.0f });
+    }
     
     Animation2D::Instance instance;
     animation_start_instance(instance, time);
@@ -75,6 +114,13 @@ static void entity_remove(EntityData& entities, u64 index)
 {
     remove_swap(entities.animations, index);
     remove_swap(entities.positions, index);
+    remove_swap(entities.previous_positions, index);
+
+    if (entities.steered)
+    {
+        remove_swap(entities.targets, index);
+        remove_swap(entities.velocities, index);
+    }
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
@@ -82,16 +128,43 @@ static void entity_clear(EntityData& entities)
 {
     clear(entities.animations);
     clear(entities.positions);
+    clear(entities.previous_positions);
+    clear(entities.targets);
+    clear(entities.velocities);
 }
 
+// Copy on write, untouched positions already match their previous ones
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
-static void entity_animation_step(const DynamicArray<Animation2D>& anims, EntityData& entities, f32 time)
+static void entity_store_previous(EntityData& entities)
 {
-    for (u64 i = 0; i < entities.animations.size; i++)
+    if (!entities.moved)
+        return;
+
+    platform_copy_memory(entities.previous_positions.data, entities.positions.data, entities.positions.size * sizeof(Vector2));
+    entities.moved = false;
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void entity_animation_step(const AnimationFrameTables& tables, EntityData& entities, f32 time)
+{
+    Jobs::parallel_for(entities.animations.size, animation_batch_size, [&](u64 start, u64 end)
     {
-        Animation2D::Instance& instance = entities.animations[i].instance;
-        animation_step_instance(anims[entities.animations[i].animation_index], instance, time);
-    }
+        AnimationData* items = entities.animations.data + start;
+        animation_step_batch(tables, &items->animation_index, &items->instance, sizeof(AnimationData), end - start, time);
+    });
+}
+
+struct AnimationStepData
+{
+    const AnimationFrameTables* tables;
+    EntityData* entities;
+    f32 time;
+};
+
+static void animation_step_phase(void* data)
+{
+    const AnimationStepData& step = *(const AnimationStepData*) data;
+    entity_animation_step(*step.tables, *step.entities, step.time);
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
@@ -102,71 +175,15 @@ static void entity_render(const GameState& state, const EntityData& entities, f3
     for (u64 i = 0; i < entities.positions.size; i++)
     {
         const AnimationData& anim_data = entities.animations[i];
+        const Vector2 position = lerp(entities.previous_positions[i], entities.positions[i], state.render_alpha);
 
         const Sprite& sprite = state.anims[anim_data.animation_index].sprites[anim_data.instance.current_frame_index];
-        Imgui::render_sprite(sprite, entities.positions[i], z, GameSettings::render_scale);
+        Imgui::render_sprite(sprite, position, z, GameSettings::render_scale);
 
         z += z_offset;
     }
 }
 
-GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
-static void stage_init(Coroutine& co, StageSettings& stage)
-{
-    coroutine_start(co);
-
-    stage.number = 1;
-    stage.enemy_column_count = GameSettings::enemy_column_start_count;
-    stage.enemy_row_count = GameSettings::enemy_row_start_count;
-
-    stage.enemy_move_speed = GameSettings::enemy_move_speed;
-
-    stage.enemy_rearrange_delay = GameSettings::enemy_rearrange_delay;
-    stage.enemy_kamikaze_delay = GameSettings::enemy_kamikaze_delay;
-    stage.enemy_shot_delay = GameSettings::enemy_shot_delay;
-
-    stage.enemy_spawn_counts[0] = GameSettings::enemy_start_spawn_counts[0];
-    stage.enemy_spawn_counts[1] = GameSettings::enemy_start_spawn_counts[1];
-    stage.enemy_spawn_counts[2] = GameSettings::enemy_start_spawn_counts[2];
-
-    coroutine_yield(co);
-
-    while (true)
-    {
-        // Increase Rows
-        stage.enemy_row_count = min(stage.enemy_row_count + 1, 7u);
-        stage.number++;
-        coroutine_yield(co);
-        
-        // Reduce Shot Delay
-        stage.enemy_shot_delay = max(stage.enemy_shot_delay - 0.05f, GameSettings::player_shot_delay - 0.15f);
-        stage.number++;
-        coroutine_yield(co);
-
-        // Reduce Kamikaze Delay
-        stage.enemy_kamikaze_delay = max(stage.enemy_kamikaze_delay - 0.05f, 0.25f);
-        stage.number++;
-        coroutine_yield(co);
-        
-        // Increase Columns
-        stage.enemy_column_count = min(stage.enemy_column_count + 1, 7u);
-        stage.number++;
-        coroutine_yield(co);
-        
-        // Increase Move speed and Reduce Rearrange Delay
-        stage.enemy_move_speed += Vector2 { 0.15f, 0.25f };
-        stage.enemy_rearrange_delay = max(stage.enemy_rearrange_delay - 0.15f, 0.25f);
-        stage.number++;
-        coroutine_yield(co);
-    }
-
-    coroutine_end(co);
-
-    stage.enemy_spawn_counts[0] += GameSettings::enemy_spawn_count_increments[0] * (((stage.number) % GameSettings::enemy_spawn_count_increase_intervals[0]) == 0);
-    stage.enemy_spawn_counts[1] += GameSettings::enemy_spawn_count_increments[1] * (((stage.number) % GameSettings::enemy_spawn_count_increase_intervals[1]) == 0);
-    stage.enemy_spawn_counts[2] += GameSettings::enemy_spawn_count_increments[2] * (((stage.number) % GameSettings::enemy_spawn_count_increase_intervals[2]) == 0);
-}
-
 static inline void fill_pickup_deck(DynamicArray<PickupType>& pickup_deck, GameState& state)
 {
     const u64 deck_size = GameSettings::pickup_deck_size;
@@ -213,9 +230,9 @@ static inline EnemyType get_enemy_type_from_animation_index(u64 index)
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
-static u64 get_random_enemy_index_of_type(EnemyType type)
+static u64 get_random_enemy_index_of_type(Math::Random& rng, EnemyType type)
 {
-    const f32 num = Math::random();
+    const f32 num = Math::random(rng);
 
     switch (type)
     {
@@ -245,7 +262,7 @@ static u64 get_random_enemy_index_of_type(EnemyType type)
     return 0;
 }
 
-static inline void fill_enemy_list(DynamicArray<u64>& enemy_list, const GameState& state, u64 num_enemies)
+static inline void fill_enemy_list(DynamicArray<u64>& enemy_list, GameState& state, u64 num_enemies)
 {
     clear(enemy_list);
     resize(enemy_list, num_enemies);
@@ -253,26 +270,26 @@ static inline void fill_enemy_list(DynamicArray<u64>& enemy_list, const GameStat
     const StageSettings& stage = state.current_stage;
     
     {   // Fill Enemy List
-        const u64 kamikaze_end = stage.enemy_spawn_counts[(u64) EnemyType::KAMIKAZE];
-        const u64 dropper_end  = stage.enemy_spawn_counts[(u64) EnemyType::DROPPER] + kamikaze_end;
+        const u64 kamikaze_end = state.enemy_count_multiplier * stage.enemy_spawn_counts[(u64) EnemyType::KAMIKAZE];
+        const u64 dropper_end  = state.enemy_count_multiplier * stage.enemy_spawn_counts[(u64) EnemyType::DROPPER] + kamikaze_end;
         const u64 flying_end   = num_enemies;
 
         u64 filled = 0;
 
         // Fill Kamikaze
         for (; filled < kamikaze_end; filled++)
-            append(enemy_list, get_random_enemy_index_of_type(EnemyType::KAMIKAZE));
+            append(enemy_list, get_random_enemy_index_of_type(state.rng, EnemyType::KAMIKAZE));
         
         // Fill Droppers
         for (; filled < dropper_end; filled++)
-            append(enemy_list, get_random_enemy_index_of_type(EnemyType::DROPPER));
+            append(enemy_list, get_random_enemy_index_of_type(state.rng, EnemyType::DROPPER));
         
         // Fill Flying
         for (; filled < flying_end; filled++)
-            append(enemy_list, get_random_enemy_index_of_type(EnemyType::FLYING));
+            append(enemy_list, get_random_enemy_index_of_type(state.rng, EnemyType::FLYING));
     }
 
-    shuffle(enemy_list);
+    shuffle(enemy_list, state.rng);
 }
 
 static void init_enemies(Application& app, GameState& state)
@@ -285,41 +302,60 @@ static void init_enemies(Application& app, GameState& state)
     constexpr u64 enemy_options = 7;
 
     const StageSettings& stage = state.current_stage;
+    const u64 column_count = state.enemy_count_multiplier * stage.enemy_column_count;
 
-    const f32 x_offset = min(state.game_playground.x / stage.enemy_column_count, 72.0f);
-    const f32 x_start  = 0.5f * (state.game_playground.x - (stage.enemy_column_count - 1) * x_offset);
-    Vector2 position = Vector2 { x_start, 75.0f };
+    const f32 x_offset = min(state.game_playground.x / column_count, 72.0f);
+    const f32 x_start  = 0.5f * (state.game_playground.x - (column_count - 1) * x_offset);
 
-    const f32 start_height = -0.5f * GameSettings::enemy_move_speed.y;
+    FormationLayout layout = {};
+    layout.column_count = column_count;
+    layout.row_count    = stage.enemy_row_count;
+    layout.origin       = Vector2 { x_start, 75.0f };
+    layout.spacing      = Vector2 { x_offset, GameSettings::enemy_vertical_gap };
 
-    clear(state.enemy_slots[0]);
-    clear(state.enemy_slots[1]);
-    clear(state.enemy_slots[2]);
+    // Every slot gets an enemy, so none of them are free
+    formation_set_layout(state.formation, layout);
 
-    const u64 num_enemies = stage.enemy_row_count * stage.enemy_column_count;
+    const f32 start_height = -0.5f * GameSettings::enemy_move_speed.y;
+
+    const u64 num_enemies = formation_slot_count(state.formation);
     fill_enemy_list(enemy_list, state, num_enemies);
 
-    for (u64 y = 0; y < stage.enemy_row_count; y++)
-    {
-        for (u64 x = 0; x < stage.enemy_column_count; x++)
+    {   // Spawn Formation
+        u64 type_counts[(u64) EnemyType::NUM_TYPES] = {};
+        for (u64 i = 0; i < num_enemies; i++)
+            type_counts[(u64) get_enemy_type_from_animation_index(enemy_list[i])]++;
+
+        // Every array is grown once up front, the pass below only writes
+        for (u64 type = 0; type < (u64) EnemyType::NUM_TYPES; type++)
         {
-            const u64 index = y * stage.enemy_column_count + x;
+            EntityData& enemies = state.enemies[type];
 
-            const u64 random_enemy = enemy_list[index];
-            const u64 enemy_type_index = (u64) get_enemy_type_from_animation_index(random_enemy);
+            clear(state.enemy_slots[type]);
+            reserve(state.enemy_slots[type], type_counts[type]);
+            reserve(enemies.positions, type_counts[type]);
+            reserve(enemies.previous_positions, type_counts[type]);
+            reserve(enemies.animations, type_counts[type]);
+        }
 
-            append(state.enemy_slots[enemy_type_index], position);
+        Animation2D::Instance instance;
+        animation_start_instance(instance, app.time);
 
-            const f32 x_mult = 2.0f * Math::random() - 1.0f;
-            entity_add(state.enemies[enemy_type_index], Vector2 { position.x, start_height + position.y }, random_enemy, app.time);
-            position.x += x_offset;
-        }
+        const Vector2* slot_positions = state.formation.slot_positions.data;
+        for (u64 slot = 0; slot < num_enemies; slot++)
+        {
+            const u64 animation_index = enemy_list[slot];
+            const u64 type = (u64) get_enemy_type_from_animation_index(animation_index);
 
-        position.y += GameSettings::enemy_vertical_gap;
-        position.x = x_start;
-    }
+            EntityData& enemies = state.enemies[type];
+            const Vector2 position = Vector2 { slot_positions[slot].x, start_height + slot_positions[slot].y };
 
-    clear(state.empty_slots);
+            append(state.enemy_slots[type], (u32) slot);
+            append(enemies.positions, position);
+            append(enemies.previous_positions, position);
+            append(enemies.animations, AnimationData { animation_index, instance });
+        }
+    }
 
     state.enemy_time_since_last_kamikaze = state.enemy_time_since_last_rearrangement = state.enemy_time_since_last_shot = 0.0f;
 }
@@ -342,13 +378,21 @@ void game_background_init(Application& app, GameState& state)
         u64 sprite_index = state.anims[stars_animation_index].sprites.size * Math::random();
         append(state.star_sprite_indices, sprite_index);
     }
+
+    state.starfield = make<Starfield>();
+    game_background_upload(state);
+}
+
+void game_background_upload(GameState& state)
+{
+    starfield_upload(state.starfield, state.star_positions.data, state.star_sprite_indices.data, state.star_positions.size,
+                     state.anims[stars_animation_index]);
 }
 
 void game_state_reset(Application& app, GameState& state)
 {
     {   // Stage
-        coroutine_reset(state.stage_co);
-        stage_init(state.stage_co, state.current_stage);
+        state.current_stage = stage_schedule_get(state.stage_schedule, 1);
     }
 
     {   // Initialize Player Data
@@ -356,6 +400,7 @@ void game_state_reset(Application& app, GameState& state)
         state.player_size = state.anims[(u64) PlayerState::NORMAL].sprites[0].size;
 
         state.player_animation.animation_index = (u64) PlayerState::NORMAL;
+        state.player_previous_animation_index = (u64) PlayerState::NORMAL;
         animation_start_instance(state.player_animation.instance, app.time);
 
         state.player_lives = 3;
@@ -374,6 +419,8 @@ void game_state_reset(Application& app, GameState& state)
         entity_clear(state.power_shot_explosions);
         entity_clear(state.pickups);
         entity_clear(state.kamikaze_enemies);
+        bullet_pool_clear(state.pattern_bullets);
+        particles_clear(state.particles);
         
         entity_clear(state.enemies[0]);
         entity_clear(state.enemies[1]);
@@ -384,6 +431,15 @@ void game_state_reset(Application& app, GameState& state)
         state.player_time_since_last_shot = Math::infinity;
         state.time_since_screen_shake_start = Math::infinity;
         state.lazer_charge = 0;
+
+        state.bullet_wave_step = state.bullet_wave_fire_count = 0;
+        state.bullet_wave_time = 0.0f;
+    }
+
+    {   // Pickups
+        fill_pickup_deck(state.pickup_deck, state);
+        shuffle(state.pickup_deck, state.rng);
+        state.pickup_deck_index = 0;
     }
 
     {   // Initialize Stuff
@@ -393,6 +449,22 @@ void game_state_reset(Application& app, GameState& state)
     coroutine_reset(state.state_co);
 
     state.new_high_score = false;
+
+    game_state_sync_previous(state);
+}
+
+void game_state_skip_to_stage(Application& app, GameState& state, u32 stage_number)
+{
+    {   // Throw away the current wave
+        entity_clear(state.enemies[0]);
+        entity_clear(state.enemies[1]);
+        entity_clear(state.enemies[2]);
+        entity_clear(state.kamikaze_enemies);
+    }
+
+    state.current_stage = stage_schedule_get(state.stage_schedule, stage_number);
+
+    init_enemies(app, state);
 }
 
 static void button_callback_play_sound(Imgui::ID id)
@@ -405,34 +477,47 @@ void game_state_init(Application& app, GameState& state)
     game_state_window_resize(app, state);
     state.game_playground = Vector2 { state.game_rect.right - state.game_rect.left, state.game_rect.bottom - state.game_rect.top };
 
+    {   // Flatten the animations for batched stepping
+        animation_build_frame_tables(state.anims, state.anim_tables);
+    }
+
     {   // Initialize Bullets
         entity_init(state.player_bullets);
         entity_init(state.enemy_bullets);
+        state.pattern_bullets = make<BulletPool>(max_pattern_bullet_count);
 
         state.lazer_chunk.animation_index = (u64) BulletType::LAZER;
     }
 
+    {   // Initialize UI
+        state.menu_ui = make<Imgui::RetainedSection>();
+    }
+
     {   // Intialize Enemies
         entity_init(state.enemies[0]);
         entity_init(state.enemies[1]);
         entity_init(state.enemies[2]);
-        entity_init(state.kamikaze_enemies);
-        state.enemy_slots[0] = make<DynamicArray<Vector2>>();
-        state.enemy_slots[1] = make<DynamicArray<Vector2>>();
-        state.enemy_slots[2] = make<DynamicArray<Vector2>>();
-        state.kamikaze_targets = make<DynamicArray<Vector2>>();
+        entity_init(state.kamikaze_enemies, true);
+        state.formation = make<Formation>();
+        state.enemy_slots[0] = make<DynamicArray<u32>>();
+        state.enemy_slots[1] = make<DynamicArray<u32>>();
+        state.enemy_slots[2] = make<DynamicArray<u32>>();
     }
 
     {   // Initialize Explosions
         entity_init(state.explosions);
         entity_init(state.power_shot_explosions);
+        state.particles = make<ParticlePool>(max_particle_count);
     }
 
     {   // Initialize Pickups
         entity_init(state.pickups);
-        fill_pickup_deck(pickup_deck, state);
-        shuffle(pickup_deck);
-        pickup_deck_index = 0;
+        state.pickup_deck = make<DynamicArray<PickupType>>(GameSettings::pickup_deck_size);
+    }
+
+    {   // Seed the gameplay random number generator (replays reseed it)
+        const u64 seed = ((u64) rand() << 32) | (u64) rand();
+        Math::random_seed(state.rng, seed);
     }
 
     {   // Load sounds
@@ -523,10 +608,13 @@ void game_state_init(Application& app, GameState& state)
         }
     }
 
+    state.enemy_count_multiplier = 1;
+
     game_state_reset(app, state);
 
     state.current_screen = GameScreen::MAIN_MENU;
     state.is_debug = false;
+    state.render_alpha = 1.0f;
 
     {   // Load Settings
         String json = file_load_string(ref(settings_file_name, settings_file_name_size));
@@ -557,22 +645,73 @@ static bool test_aabb_vs_aabb(const Vector4& aabb1, const Vector4& aabb2)
     return (mask == 0xF);
 }
 
+// Marks every collider that overlaps at least one enemy (kamikaze enemies included).
+// Resolving collisions only ever removes enemies, so unmarked colliders can be skipped there.
+static void find_collision_candidates(const GameState& state, const EntityData& colliders, const Vector4 collider_aabb_coord, const Vector4 enemy_aabb_coord, DynamicArray<u8>& out_candidates)
+{
+    const u64 count = colliders.positions.size;
+
+    clear(out_candidates);
+    if (out_candidates.capacity < count)
+        resize(out_candidates, count);
+
+    out_candidates.size = count;
+
+    u64 enemy_count = state.kamikaze_enemies.positions.size;
+    for (u64 enemy_type = 0; enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
+        enemy_count += state.enemies[enemy_type].positions.size;
+
+    const u64 batch_size = max(collision_batch_tests / max(enemy_count, 1ull), 1ull);
+
+    Jobs::parallel_for(count, batch_size, [&](u64 start, u64 end)
+    {
+        for (u64 i = start; i < end; i++)
+        {
+            const Vector2 position = colliders.positions.data[i];
+            const Vector4 collider_aabb = collider_aabb_coord + Vector4 { position.x, position.y, position.x, position.y };
+
+            bool hit = false;
+
+            for (u64 enemy_type = 0; !hit && enemy_type <= (u64) EnemyType::NUM_TYPES; enemy_type++)
+            {
+                // The last "type" is the kamikaze enemies that left the formation
+                const EntityData& enemies = (enemy_type < (u64) EnemyType::NUM_TYPES) ? state.enemies[enemy_type] : state.kamikaze_enemies;
+
+                for (u64 enemy_i = 0; enemy_i < enemies.positions.size; enemy_i++)
+                {
+                    const Vector2 enemy_position = enemies.positions.data[enemy_i];
+                    const Vector4 enemy_aabb = enemy_aabb_coord + Vector4 { enemy_position.x, enemy_position.y, enemy_position.x, enemy_position.y };
+
+                    if (test_aabb_vs_aabb(collider_aabb, enemy_aabb))
+                    {
+                        hit = true;
+                        break;
+                    }
+                }
+            }
+
+            out_candidates.data[i] = hit;
+        }
+    });
+}
+
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
 static PickupType get_random_pickup_type(GameState& state)
 {
-    if (pickup_deck_index >= pickup_deck.size)
+    if (state.pickup_deck_index >= state.pickup_deck.size)
     {
-        pickup_deck_index = 0;
-        shuffle(pickup_deck);
+        state.pickup_deck_index = 0;
+        shuffle(state.pickup_deck, state.rng);
     }
     
-    return pickup_deck[pickup_deck_index++];
+    return state.pickup_deck[state.pickup_deck_index++];
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
 static void spawn_explosion(GameState& state, Vector2 position, f32 time)
 {
     entity_add(state.explosions, position, enemy_explosion_animation_index, time);
+    particles_emit(state.particles, GameSettings::explosion_particles, position);
     Audio::play_sound(sound_explosion, false);
 
     // Screen Shake
@@ -587,13 +726,13 @@ static void remove_enemy(GameState& state, u64 type_index, u64 index, f32 time)
 
     // Remove Enemy
     entity_remove(enemies, index);
-    const Vector2 slot_position = remove_swap(state.enemy_slots[type_index], index);
+    const u32 slot = remove_swap(state.enemy_slots[type_index], index);
 
     // Don't rearrange immediately
-    if (state.empty_slots.size == 0)
+    if (state.formation.free_count == 0)
         state.enemy_time_since_last_rearrangement = 0.0f;
 
-    append(state.empty_slots, slot_position);
+    formation_release(state.formation, slot);
 
     spawn_explosion(state, enemy_position, time);
 }
@@ -644,7 +783,7 @@ static void update_lazer(GameState& state, f32 time)
         coroutine_yield(state.lazer_co);
     }
 
-    coroutine_wait_seconds(state.lazer_co, GameSettings::lazer_duration);
+    coroutine_wait_seconds_at(state.lazer_co, GameSettings::lazer_duration, time);
     
     Audio::source_stop(source_lazer);
 
@@ -756,10 +895,9 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
     if (state.player_lives > 0)
     {
         {   // Player Movement
-            const ControlScheme scheme = state.player_settings.control_scheme;
             Vector2 input = Vector2 {
-                (f32) get_direction_input(Direction::RIGHT, scheme) - (f32) get_direction_input(Direction::LEFT, scheme),
-                (f32) get_direction_input(Direction::DOWN, scheme)  - (f32) get_direction_input(Direction::UP, scheme),
+                (f32) game_input_get(state.input, GameButton::RIGHT) - (f32) game_input_get(state.input, GameButton::LEFT),
+                (f32) game_input_get(state.input, GameButton::DOWN)  - (f32) game_input_get(state.input, GameButton::UP),
             };
 
             state.player_position += app.delta_time * GameSettings::player_move_speed * normalize(input);
@@ -770,7 +908,7 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
         }
         
         // Player Shooting
-        if (Input::get_key(Key::Z) && !state.is_lazer_active && state.lazer_charge >= GameSettings::lazer_power_requirement)
+        if (game_input_get(state.input, GameButton::LAZER) && !state.is_lazer_active && state.lazer_charge >= GameSettings::lazer_power_requirement)
         {
             animation_start_instance(state.lazer_chunk.instance, app.time);
             coroutine_reset(state.lazer_co);
@@ -784,7 +922,7 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
             state.player_time_since_last_shot += app.delta_time;
 
             constexpr f32 x_offsets[][3] = { {}, { -15.0f, 15.0f }, { -20.0f, 0.0f, 20.0f } };
-            if (Input::get_key(Key::SPACE) && state.player_time_since_last_shot >= GameSettings::player_shot_delay)
+            if (game_input_get(state.input, GameButton::SHOOT) && state.player_time_since_last_shot >= GameSettings::player_shot_delay)
             {
                 for (u32 i = 0; i < state.player_bullets_per_shot; i++)
                 {
@@ -824,14 +962,15 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
             state.enemy_time_since_last_rearrangement += app.delta_time;
 
             if (state.player_lives > 0 &&
-                state.empty_slots.size > 0 && enemies.positions.size > 0 &&
+                state.formation.free_count > 0 && enemies.positions.size > 0 &&
                 state.enemy_time_since_last_rearrangement >= state.current_stage.enemy_rearrange_delay)
             {
-                u64 enemy_index = Math::random() * enemies.positions.size;
+                u64 enemy_index = Math::random(state.rng) * enemies.positions.size;
 
-                Vector2 old_slot = state.enemy_slots[type_index][enemy_index];
-                state.enemy_slots[type_index][enemy_index] = remove(state.empty_slots, 0);
-                append(state.empty_slots, old_slot);
+                // Claimed before releasing, the enemy always moves to a different slot
+                const u32 old_slot = state.enemy_slots[type_index][enemy_index];
+                formation_claim(state.formation, state.enemy_slots[type_index][enemy_index]);
+                formation_release(state.formation, old_slot);
 
                 state.enemy_time_since_last_rearrangement = 0.0f;
             }
@@ -841,47 +980,77 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
             const f32 x_offset = GameSettings::enemy_move_range * Math::sin(app.time * GameSettings::enemy_wiggle_speed.x);
             const f32 y_offset = GameSettings::enemy_move_range * Math::cos(app.time * GameSettings::enemy_wiggle_speed.y);
 
+            // The jitter is drawn in enemy order first so the rng sequence doesn't depend on the thread count
+            clear(enemy_jitters);
+            for (u64 enemy_type = 0; enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
+            {
+                for (u64 i = 0; i < state.enemies[enemy_type].positions.size; i++)
+                {
+                    constexpr f32 range = 100.0f;
+                    append(enemy_jitters, range * Math::random(state.rng) - (range / 2.0f));
+                }
+            }
+
+            u64 jitter_offset = 0;
             for (u64 enemy_type = 0; enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
             {
                 EntityData& enemies = state.enemies[enemy_type];
+                enemies.moved = true;
 
-                for (u64 i = 0; i < enemies.positions.size; i++)
+                const u32* slots = state.enemy_slots[enemy_type].data;
+                const Vector2* slot_positions = state.formation.slot_positions.data;
+                const f32* y_gitters = enemy_jitters.data + jitter_offset;
+                const f32 delta_time = app.delta_time;
+
+                Jobs::parallel_for(enemies.positions.size, enemy_movement_batch_size, [&](u64 start, u64 end)
                 {
-                    constexpr f32 range = 100.0f;
-                    const f32 y_gitter = (range * Math::random() - (range / 2.0f));
+                    for (u64 i = start; i < end; i++)
+                    {
+                        const Vector2 slot = slot_positions[slots[i]];
+                        const Vector2 destination = Vector2 { slot.x + x_offset, slot.y + y_offset + y_gitters[i] };
+                        enemies.positions.data[i] = move_towards(enemies.positions.data[i], destination, GameSettings::enemy_move_speed, delta_time);
+                    }
+                });
 
-                    const Vector2 destination = Vector2 { state.enemy_slots[enemy_type][i].x + x_offset, state.enemy_slots[enemy_type][i].y + y_offset + y_gitter };
-                    enemies.positions[i] = move_towards(enemies.positions[i], destination, GameSettings::enemy_move_speed, app.delta_time);
-                }
+                jitter_offset += enemies.positions.size;
             }
         }
 
         {   // Kamikaze Enemy Movement
-            for (u64 i = 0; i < state.kamikaze_enemies.positions.size; i++)
+            EntityData& kamikazes = state.kamikaze_enemies;
+            kamikazes.moved = true;
+
+            // Above the player region they home in on the player, below it they keep going the way they were heading
+            steering_extend_targets(kamikazes.positions.data, kamikazes.targets.data, kamikazes.positions.size, 400.0f);
+
+            for (u64 i = 0; i < kamikazes.positions.size; i++)
             {
-                if (state.kamikaze_enemies.positions[i].y <= state.game_playground.y - GameSettings::player_region_height)
-                    state.kamikaze_targets[i] = state.player_position;
-                else
-                {
-                    const Vector2 direction = state.kamikaze_targets[i] - state.kamikaze_enemies.positions[i];
-                    state.kamikaze_targets[i] = 400.0f * normalize(direction) + state.kamikaze_enemies.positions[i];
-                }
+                if (kamikazes.positions[i].y <= state.game_playground.y - GameSettings::player_region_height)
+                    kamikazes.targets[i] = state.player_position;
+            }
+
+            SteeringSettings steering = {};
+            steering.behaviour       = SteeringBehaviour::SEEK;
+            steering.max_speed       = GameSettings::enemy_move_speed;
+            steering.arrive_distance = 100.0f;
 
-                state.kamikaze_enemies.positions[i] = move_towards(state.kamikaze_enemies.positions[i], state.kamikaze_targets[i], GameSettings::enemy_move_speed, app.delta_time);
+            steering_update(kamikazes.positions.data, kamikazes.targets.data, kamikazes.velocities.data, kamikazes.positions.size, steering, app.delta_time);
 
-                // Remove enemy if it's offscreen (It can't go up)
-                const Vector2 half_sprite_size = Vector2 { 30.0f, 30.0f }; // Hard coded for now
-                if (state.kamikaze_enemies.positions[i].y - half_sprite_size.y >= state.game_playground.y ||
-                    state.kamikaze_enemies.positions[i].x - half_sprite_size.x >= state.game_playground.x ||
-                    state.kamikaze_enemies.positions[i].x + half_sprite_size.x <= 0.0f)
-                    entity_remove(state.kamikaze_enemies, i);
+            // Remove enemies that are offscreen (They can't go up)
+            const Vector2 half_sprite_size = Vector2 { 30.0f, 30.0f }; // Hard coded for now
+            for (s64 i = kamikazes.positions.size - 1; i >= 0; i--)
+            {
+                if (kamikazes.positions[i].y - half_sprite_size.y >= state.game_playground.y ||
+                    kamikazes.positions[i].x - half_sprite_size.x >= state.game_playground.x ||
+                    kamikazes.positions[i].x + half_sprite_size.x <= 0.0f)
+                    entity_remove(kamikazes, i);
             }
         }
 
         if (state.player_lives > 0)
         {
             {   // Enemy Shooting
-                u64 random_enemy_index = Math::random() * (state.enemies[(u64) EnemyType::FLYING].positions.size + state.enemies[(u64) EnemyType::KAMIKAZE].positions.size);
+                u64 random_enemy_index = Math::random(state.rng) * (state.enemies[(u64) EnemyType::FLYING].positions.size + state.enemies[(u64) EnemyType::KAMIKAZE].positions.size);
 
                 const u64 type_index = (random_enemy_index < state.enemies[0].positions.size) ? (u64) EnemyType::FLYING : (u64) EnemyType::KAMIKAZE;
                 const EntityData& enemies = state.enemies[type_index];
@@ -901,10 +1070,49 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
                 }
             }
 
+            {   // Enemy Bullet Patterns
+                const BulletPatterns& patterns = state.bullet_patterns;
+
+                if (patterns.start_stage > 0 && state.current_stage.number >= patterns.start_stage && patterns.script.size > 0)
+                {
+                    state.bullet_wave_time += app.delta_time;
+
+                    // Hot reloading can shorten the script
+                    state.bullet_wave_step %= patterns.script.size;
+
+                    while (state.bullet_wave_time >= patterns.script[state.bullet_wave_step].delay)
+                    {
+                        const BulletWaveStep& step = patterns.script[state.bullet_wave_step];
+                        const EntityData& enemies = state.enemies[step.enemy_type];
+
+                        state.bullet_wave_time -= step.delay;
+                        state.bullet_wave_step = (state.bullet_wave_step + 1) % patterns.script.size;
+
+                        // Steps without a source enemy are skipped, the spiral only turns when something fires
+                        if (enemies.positions.size == 0)
+                            continue;
+
+                        const Vector2* origins = enemies.positions.data;
+                        u64 origin_count = enemies.positions.size;
+
+                        if (step.source == BulletWaveSource::RANDOM_ENEMY)
+                        {
+                            origins += (u64) (Math::random(state.rng) * origin_count);
+                            origin_count = 1;
+                        }
+
+                        bullet_pattern_fire(patterns.patterns[step.pattern_index], state.pattern_bullets, origins, origin_count,
+                                            state.player_position, state.bullet_wave_fire_count);
+
+                        state.bullet_wave_fire_count++;
+                        Audio::play_sound(sound_enemy_bullet, false);
+                    }
+                }
+            }
+
             {   // Enemy Kamikaze
                 constexpr u64 type_index = (u64) EnemyType::KAMIKAZE;
                 EntityData& enemies = state.enemies[type_index];
-                DynamicArray<Vector2>& slots = state.enemy_slots[type_index];
 
                 state.enemy_time_since_last_kamikaze += app.delta_time;
 
@@ -912,14 +1120,14 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
                 {
                     const u64 selected_enemy_index = enemies.positions.size - 1;
                     entity_add(state.kamikaze_enemies, enemies.positions[selected_enemy_index], enemies.animations[selected_enemy_index].animation_index, app.time);
-                    append(state.kamikaze_targets, state.player_position);
+                    state.kamikaze_enemies.targets[state.kamikaze_enemies.targets.size - 1] = state.player_position;
 
                     // Don't rearrange immediately
-                    if (state.empty_slots.size == 0)
+                    if (state.formation.free_count == 0)
                         state.enemy_time_since_last_rearrangement = 0.0f;
 
-                    Vector2 old_slot = remove_swap(state.enemy_slots[type_index], selected_enemy_index);
-                    append(state.empty_slots, old_slot);
+                    const u32 old_slot = remove_swap(state.enemy_slots[type_index], selected_enemy_index);
+                    formation_release(state.formation, old_slot);
 
                     entity_remove(enemies, selected_enemy_index);
 
@@ -932,6 +1140,9 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
     }
 
     {   // Update Bullets
+        state.player_bullets.moved = true;
+        state.enemy_bullets.moved = true;
+
         for (s64 i = state.player_bullets.positions.size - 1; i >= 0; i--)
         {
             Vector2& position = state.player_bullets.positions[i];
@@ -955,6 +1166,8 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
                 entity_remove(state.enemy_bullets, i);
         }
 
+        bullet_pool_update(state.pattern_bullets, app.delta_time, Vector4 { 0.0f, 0.0f, state.game_playground.x, state.game_playground.y });
+
         if (state.is_lazer_active)
         {
             const Vector2& player_size = GameSettings::render_scale * state.anims[(u64) PlayerState::NORMAL].sprites[0].size;
@@ -964,6 +1177,8 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
     }
 
     {   // Update pickups
+        state.pickups.moved = true;
+
         for (s64 i = state.pickups.positions.size - 1; i >= 0; i--)
         {
             Vector2& position = state.pickups.positions[i];
@@ -994,6 +1209,13 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
         }
     }
 
+    {   // Explosion debris
+        state.particles.acceleration = GameSettings::particle_acceleration;
+        state.particles.drag = GameSettings::particle_drag;
+
+        particles_update(state.particles, app.delta_time);
+    }
+
     if (!(state.current_screen & GameScreen::MAIN_MENU))
     {
         {   // Test Lazer vs Enemies
@@ -1074,8 +1296,13 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
 
             u32 kill_count = 0;
 
+            find_collision_candidates(state, state.power_shot_explosions, explosion_aabb_coord, enemy_aabb_coord, collision_candidates);
+
             for (u64 i = 0; i < state.power_shot_explosions.positions.size; i++)
             {
+                if (!collision_candidates[i])
+                    continue;
+
                 const Vector2 explosion_position = state.power_shot_explosions.positions[i];
                 const Vector4 explosion_aabb = explosion_aabb_coord + Vector4 { explosion_position.x, explosion_position.y, explosion_position.x, explosion_position.y };
                 
@@ -1136,12 +1363,21 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
 
             u32 kill_count = 0;
 
+            find_collision_candidates(state, state.player_bullets, bullet_aabb_coord, enemy_aabb_coord, collision_candidates);
+
             for (s64 bullet_i = state.player_bullets.positions.size - 1; bullet_i >= 0; bullet_i--)
             {
+                // Bullets are removed with a swap from the back, the candidates below bullet_i stay valid
+                if (!collision_candidates[bullet_i])
+                    continue;
+
                 const Vector2 bullet_position = state.player_bullets.positions[bullet_i];
                 const Vector4 bullet_aabb = bullet_aabb_coord + Vector4 { bullet_position.x, bullet_position.y, bullet_position.x, bullet_position.y };
+
+                // Bullet is removed on the first hit so it can't be tested again
+                bool bullet_hit = false;
                 
-                for (u64 enemy_type = 0; enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
+                for (u64 enemy_type = 0; !bullet_hit && enemy_type < (u64) EnemyType::NUM_TYPES; enemy_type++)
                 {
                     EntityData& enemies = state.enemies[enemy_type];
 
@@ -1154,7 +1390,10 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
                         {
                             // Trigger explosion if the bullet is a powered shot
                             if (state.player_bullets.animations[bullet_i].animation_index == (u64) BulletType::POWER_SHOT)
+                            {
                                 entity_add(state.power_shot_explosions, enemy_position, power_shot_explosion_animation_index, app.time);
+                                particles_emit(state.particles, GameSettings::power_shot_particles, enemy_position);
+                            }
 
                             state.player_kill_streak++;
 
@@ -1176,13 +1415,14 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
                             kill_count++;
 
                             // Only need to hit one enemy with one bullet
+                            bullet_hit = true;
                             break;
                         }
                     }
                 }
                 
                 // Kamikaze enemies
-                for (s64 enemy_i = state.kamikaze_enemies.positions.size - 1; enemy_i >= 0; enemy_i--)
+                for (s64 enemy_i = state.kamikaze_enemies.positions.size - 1; !bullet_hit && enemy_i >= 0; enemy_i--)
                 {
                     const Vector2 enemy_position = state.kamikaze_enemies.positions[enemy_i];
                     const Vector4 enemy_aabb = enemy_aabb_coord + Vector4 { enemy_position.x, enemy_position.y, enemy_position.x, enemy_position.y };
@@ -1302,6 +1542,22 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
             }
         }
 
+        {   // Test Pattern Bullets vs Player
+            const Vector4 bullet_aabb_coord = Vector4 {
+                GameSettings::render_scale.x * -0.5f * GameSettings::enemy_bullet_collider_size.x,    // left
+                GameSettings::render_scale.y * -0.5f * GameSettings::enemy_bullet_collider_size.y,    // top
+                GameSettings::render_scale.x *  0.5f * GameSettings::enemy_bullet_collider_size.x,    // right
+                GameSettings::render_scale.y *  0.5f * GameSettings::enemy_bullet_collider_size.y     // bottom
+            };
+
+            // The player aabb is swizzled for test_aabb_vs_aabb
+            const Vector4 unswizzled_player_aabb = Vector4 { player_aabb.z, player_aabb.w, player_aabb.x, player_aabb.y };
+
+            // Patterns overlap a lot, every bullet that hits is gone but a tick only costs one life
+            if (bullet_pool_remove_overlapping(state.pattern_bullets, bullet_aabb_coord, unswizzled_player_aabb) > 0)
+                damage_player(state, app.time);
+        }
+
         {   // Test Kamikaze Enemies vs Player
             const Vector4 enemy_aabb_coord = Vector4 {
                 GameSettings::render_scale.x * -0.5f * GameSettings::enemy_collider_size.x,   // left
@@ -1358,15 +1614,36 @@ static void internal_state_update_gameplay(Application& app, GameState& state)
         animation_step_instance(state.anims[state.player_animation.animation_index], state.player_animation.instance, app.time);
         animation_step_instance(state.anims[(u64) BulletType::LAZER], state.lazer_chunk.instance, app.time);
 
-        entity_animation_step(state.anims, state.player_bullets, app.time);
-        entity_animation_step(state.anims, state.enemy_bullets, app.time);
-        entity_animation_step(state.anims, state.enemies[0], app.time);
-        entity_animation_step(state.anims, state.enemies[1], app.time);
-        entity_animation_step(state.anims, state.enemies[2], app.time);
-        entity_animation_step(state.anims, state.explosions, app.time);
-        entity_animation_step(state.anims, state.power_shot_explosions, app.time);
-        entity_animation_step(state.anims, state.pickups, app.time);
-        entity_animation_step(state.anims, state.kamikaze_enemies, app.time);
+        struct
+        {
+            const char* name;
+            EntityData* entities;
+            u64 data;
+        } groups[] = {
+            { "player bullet animations",        &state.player_bullets,        SimulationData::PLAYER_BULLETS        },
+            { "enemy bullet animations",         &state.enemy_bullets,         SimulationData::ENEMY_BULLETS         },
+            { "flying enemy animations",         &state.enemies[0],            SimulationData::FLYING_ENEMIES        },
+            { "dropper enemy animations",        &state.enemies[1],            SimulationData::DROPPER_ENEMIES       },
+            { "kamikaze type enemy animations",  &state.enemies[2],            SimulationData::KAMIKAZE_TYPE_ENEMIES },
+            { "explosion animations",            &state.explosions,            SimulationData::EXPLOSIONS            },
+            { "power shot explosion animations", &state.power_shot_explosions, SimulationData::POWER_SHOT_EXPLOSIONS },
+            { "pickup animations",               &state.pickups,               SimulationData::PICKUPS               },
+            { "kamikaze enemy animations",       &state.kamikaze_enemies,      SimulationData::KAMIKAZE_ENEMIES      },
+        };
+
+        constexpr u64 group_count = sizeof(groups) / sizeof(groups[0]);
+
+        // Every group only writes its own instances, so they all end up running side by side
+        AnimationStepData steps[group_count];
+        Jobs::Phase phases[group_count];
+
+        for (u64 i = 0; i < group_count; i++)
+        {
+            steps[i]  = AnimationStepData { &state.anim_tables, groups[i].entities, app.time };
+            phases[i] = Jobs::Phase { groups[i].name, SimulationData::ANIMATIONS, groups[i].data, groups[i].entities->animations.size, animation_step_phase, &steps[i] };
+        }
+
+        Jobs::run_phases(phases, group_count);
     }
 }
 
@@ -1388,7 +1665,7 @@ static inline void resume_all_audio()
         Audio::source_resume(source_lazer_charged);
 }
 
-void game_state_update(Application& app, GameState& state)
+void game_state_update_screens(GameState& state)
 {
     if (Input::get_key_down(Key::GRAVE))
         state.is_debug = !state.is_debug;
@@ -1414,10 +1691,75 @@ void game_state_update(Application& app, GameState& state)
     
     if (state.current_screen & (GameScreen::SETTINGS_MENU) && Input::get_key(Key::ESCAPE))
         screen_switch_off(state, GameScreen::SETTINGS_MENU);
+}
+
+static void store_previous_positions(GameState& state)
+{
+    state.player_previous_position = state.player_position;
+
+    entity_store_previous(state.player_bullets);
+    entity_store_previous(state.enemy_bullets);
+
+    for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+        entity_store_previous(state.enemies[i]);
+
+    entity_store_previous(state.explosions);
+    entity_store_previous(state.power_shot_explosions);
+    entity_store_previous(state.pickups);
+    entity_store_previous(state.kamikaze_enemies);
+}
+
+void game_state_sync_previous(GameState& state)
+{
+    state.player_bullets.moved = state.enemy_bullets.moved = true;
+    state.explosions.moved = state.power_shot_explosions.moved = true;
+    state.pickups.moved = state.kamikaze_enemies.moved = true;
+
+    for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+        state.enemies[i].moved = true;
+
+    store_previous_positions(state);
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void animation_clamp_frame(const DynamicArray<Animation2D>& anims, AnimationData& anim_data)
+{
+    const u32 frame_count = (u32) anims[anim_data.animation_index].sprites.size;
+    anim_data.instance.current_frame_index = min(anim_data.instance.current_frame_index, frame_count - 1);
+}
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+static void entity_clamp_frames(const DynamicArray<Animation2D>& anims, EntityData& entities)
+{
+    for (u64 i = 0; i < entities.animations.size; i++)
+        animation_clamp_frame(anims, entities.animations[i]);
+}
+
+void game_state_clamp_animation_frames(GameState& state)
+{
+    animation_clamp_frame(state.anims, state.player_animation);
+    animation_clamp_frame(state.anims, state.lazer_chunk);
+
+    entity_clamp_frames(state.anims, state.player_bullets);
+    entity_clamp_frames(state.anims, state.enemy_bullets);
+
+    for (u64 i = 0; i < (u64) EnemyType::NUM_TYPES; i++)
+        entity_clamp_frames(state.anims, state.enemies[i]);
+
+    entity_clamp_frames(state.anims, state.explosions);
+    entity_clamp_frames(state.anims, state.power_shot_explosions);
+    entity_clamp_frames(state.anims, state.pickups);
+    entity_clamp_frames(state.anims, state.kamikaze_enemies);
+}
 
+void game_state_simulate(Application& app, GameState& state)
+{
     if (state.current_screen & (GameScreen::PAUSE_MENU | GameScreen::SETTINGS_MENU))
         return;
 
+    // The tick is about to write the current positions, everything it touches gets blended from here
+    store_previous_positions(state);
+
     u64 remaining_enemies;
 
     coroutine_start(state.state_co);
@@ -1433,7 +1775,7 @@ void game_state_update(Application& app, GameState& state)
 
         if (remaining_enemies == 0)
         {
-            stage_init(state.stage_co, state.current_stage);
+            state.current_stage = stage_schedule_get(state.stage_schedule, state.current_stage.number + 1);
             init_enemies(app, state);
             coroutine_yield(state.state_co);
         }
@@ -1445,353 +1787,56 @@ void game_state_update(Application& app, GameState& state)
     coroutine_end(state.state_co);
 }
 
-// Uses Imgui
-void game_state_render(Application& app, GameState& state, const Imgui::Font& font)
+void game_state_update(Application& app, GameState& state)
 {
-    const Vector2 relative_scale = Vector2 { (state.game_rect.right - state.game_rect.left) / state.game_playground.x, (state.game_rect.bottom - state.game_rect.top) / state.game_playground.y };
-    Imgui::set_scale(relative_scale.x, relative_scale.y);
-    Imgui::set_offset(state.game_rect.left, state.game_rect.top);
-
-    constexpr f32 z_offset = -0.00001f;
-    f32 z = 0.8f;
+    // One tick per frame, there's nothing to blend
+    state.render_alpha = 1.0f;
 
-    {   // Render Background
-        if (state.player_settings.dynamic_background)
-        {
-            for (u64 i = 0; i < state.star_positions.size; i++)
-            {
-                const Vector3 star_position = state.star_positions[i];
+    game_state_update_screens(state);
+    game_state_simulate(app, state);
+}
 
-                Vector3 position = Vector3 { state.game_playground.x, state.game_playground.y, 0.15f } * star_position;
+// Everything drawn here only changes with what MenuKey holds or when a widget is used, so it goes through a
+// retained section
+static void render_menus(Application& app, GameState& state, const Imgui::Font& font, f32& z)
+{
+    constexpr f32 z_offset = -0.00001f;
 
-                const f32 z_multiplier = 1.0f - star_position.z * star_position.z;
+    if (state.current_screen & GameScreen::SETTINGS_MENU)
+    {
+        constexpr f32 y_offset = 5.0f;
+        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
+        
+        {   // Darken Background
+            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
+            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
 
-                const f32 x_center = 0.5f * state.game_playground.x;
-                const f32 x_offset = (state.player_position.x - x_center) * z_multiplier;
-                position.x += -GameSettings::background_star_offset_multiplier * x_offset;
+            z += z_offset;
+        }
+        
+        {   // Main Text
+            constexpr f32 scale = Math::golden_ratio;
+            const f32 font_size = scale * font.size;
+            
+            char buffer[] = "Settings";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
-                const f32 y_center = state.game_playground.y - 0.5f * GameSettings::player_region_height;
-                const f32 y_offset = (state.player_position.y - y_center) * z_multiplier;
-                position.y += -GameSettings::background_star_offset_multiplier * y_offset;
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
 
-                const Sprite& sprite = state.anims[stars_animation_index].sprites[state.star_sprite_indices[i]];
-                Imgui::render_sprite(sprite, Vector2 { position.x, position.y }, z);
-            }
+            y += size.y + 2 * y_offset;
         }
-        else
-        {
-            for (u64 i = 0; i < state.star_positions.size; i++)
-            {
-                const Vector3 star_position = state.star_positions[i];
-                Vector3 position = Vector3 { state.game_playground.x, state.game_playground.y, 0.15f } * star_position;
 
-                const Sprite& sprite = state.anims[stars_animation_index].sprites[state.star_sprite_indices[i]];
-                Imgui::render_sprite(sprite, Vector2 { position.x, position.y }, z);
-            }
-        }
+        bool dirty = false;
+        Settings& settings = state.player_settings;
+        
+        {   // Control Scheme
+            constexpr f32 x_padding = 10.0f;
+            constexpr f32 y_padding = 5.0f;
 
-        z += z_offset;
-    }
-
-    if (!(state.current_screen & ~(GameScreen::GAME | GameScreen::GAME_OVER)))
-    {
-        if (state.is_lazer_active)
-        {
-            const f32 x_offset = state.game_rect.left + relative_scale.x * GameSettings::screen_shake_amplitude_lazer * (Math::random() * 2 - 1);
-            const f32 y_offset = state.game_rect.top  + relative_scale.y * GameSettings::screen_shake_amplitude_lazer * (Math::random() * 2 - 1);
-            Imgui::set_offset(x_offset, y_offset);
-        }
-        else if (state.time_since_screen_shake_start <= GameSettings::screen_shake_enemy_kill_duration)
-        {
-            const f32 x_offset = state.game_rect.left + relative_scale.x * GameSettings::screen_shake_amplitude_enemy * (Math::random() * 2 - 1);
-            const f32 y_offset = state.game_rect.top  + relative_scale.y * GameSettings::screen_shake_amplitude_enemy * (Math::random() * 2 - 1);
-            Imgui::set_offset(x_offset, y_offset);
-        }
-    }
-
-    entity_render(state, state.enemies[0], z);
-    entity_render(state, state.enemies[1], z);
-    entity_render(state, state.enemies[2], z);
-    entity_render(state, state.kamikaze_enemies, z);
-
-    if (state.is_lazer_active)
-    {
-        const Animation2D& anim = state.anims[(u64) BulletType::LAZER];
-        const Vector2 sprite_size = anim.sprites[0].size;
-
-        Vector2 position = state.lazer_position;
-        position.y -= state.lazer_start * GameSettings::render_scale.y * sprite_size.y;
-        for (u32 i = state.lazer_start; i < state.lazer_end; i++)
-        {
-            const Sprite& sprite = anim.sprites[state.lazer_chunk.instance.current_frame_index];
-            Imgui::render_sprite(sprite, position, z, GameSettings::render_scale);
-
-            position.y -= GameSettings::render_scale.y * sprite.size.y;
-        }
-
-        z += z_offset;
-    }
-
-    entity_render(state, state.explosions, z);
-    entity_render(state, state.power_shot_explosions, z);
-    entity_render(state, state.pickups, z);
-    entity_render(state, state.player_bullets, z);
-    entity_render(state, state.enemy_bullets, z);
-    
-    // Render Player
-    if (!(state.current_screen & GameScreen::GAME_OVER))
-    {
-        const Animation2D& anim = state.anims[state.player_animation.animation_index];
-        const Sprite& sprite = anim.sprites[state.player_animation.instance.current_frame_index];
-        Imgui::render_sprite(sprite, state.player_position, z, GameSettings::render_scale);
-
-        z += z_offset;
-    }
-
-    if (!(state.current_screen & (GameScreen::MAIN_MENU | GameScreen::GAME_OVER)))
-    {
-        // Render UI
-
-        {   // Render lives
-            constexpr f32 x_offset = 20.0f;
-            const f32 scale = GameSettings::render_scale.x / 2.0f;
-
-            const Sprite& sprite = state.anims[(u64) PlayerState::NORMAL].sprites[0];
-            Vector2 position = Vector2 { scale * (sprite.size.x / 2.0f), state.game_playground.y - scale * (sprite.size.y / 2.0f) };
-
-            for (u32 i = 0; i < state.player_lives; i++)
-            {
-                Imgui::render_sprite(sprite, position, z, Vector2 { scale, scale });
-                position.x += sprite.size.x + x_offset;
-            }
-        }
-
-        constexpr f32 x_padding = 10.0f;
-        char text_buffer[128];
-
-        {   // Render Ammo
-            Vector2 position = state.game_playground;
-
-            // Render Power Shot Ammo
-            if (state.player_equipped_bullet_type == BulletType::POWER_SHOT)
-            {
-                {   // Count
-                    constexpr f32 scale = 1.0f;
-                    const f32 font_size = scale * font.size;
-
-                    String text = ref(text_buffer, 0);
-                    to_string(text, state.player_power_shot_ammo);
-
-                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                    Imgui::render_text(text, font, position - size + Vector2 { 0.0f, 1.0f }, z, font_size);
-
-                    position.x -= size.x + x_padding;
-                }
-
-                {   // Sprite
-                    const Sprite& sprite = state.anims[(u64) PickupType::POWER_SHOT].sprites[0];
-                    const Vector2 scale = Vector2 { 2.5f, 2.5f };
-                    const Vector2 size = scale * sprite.size;
-
-                    Imgui::render_sprite(sprite, position - 0.5f * size, z, scale);
-                    position.x -= size.x + x_padding;
-                }
-
-                z += z_offset;
-            }
-
-            position.x -= x_padding;
-
-            // Render Extra Shot Ammo
-            if (state.player_bullets_per_shot > 1)
-            {
-                {   // Count
-                    constexpr f32 scale = 1.0f;
-                    const f32 font_size = scale * font.size;
-
-                    String text = ref(text_buffer, 0);
-                    to_string(text, state.player_extra_shot_ammo);
-
-                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                    Imgui::render_text(text, font, position - size + Vector2 { 0.0f, 1.0f }, z, font_size);
-
-                    position.x -= size.x + x_padding;
-                }
-
-                {   // Sprite
-                    const Sprite& sprite = state.anims[(u64) PickupType::EXTRA_SHOT].sprites[0];
-                    const Vector2 scale = Vector2 { 2.5f, 2.5f };
-                    const Vector2 size = scale * sprite.size;
-
-                    Imgui::render_sprite(sprite, position - 0.5f * size, z, scale);
-                    position.x -= size.x + x_padding;
-                }
-
-                z += z_offset;
-            }
-        }
-        
-        {   // Render Score
-            {   // Text
-                constexpr f32 scale = 1.0f;
-                const f32 font_size = scale * font.size;
-
-                Vector4 color = Vector4(1.0f);
-                if (state.player_score <= state.player_settings.high_score)
-                    sprintf(text_buffer, "Score: %u", state.player_score);
-                else
-                {
-                    sprintf(text_buffer, "High Score: %u", state.player_score);
-                    color = high_score_color;
-                }
-
-                String text = ref(text_buffer);
-
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), 0.0f };
-                Imgui::render_text(text, font, top_left, z, font_size, color);
-            }
-        }
-
-        {   // Render Lazer Charge
-            Vector2 position = Vector2 { 0.0f, 0.0f };
-
-            {   // Sprite
-                const Sprite& sprite = state.anims[(u64) PickupType::LAZER_CHARGE].sprites[0];
-                const Vector2 scale = Vector2 { 2.5f, 2.5f };
-                const Vector2 size = scale * sprite.size;
-
-                Imgui::render_sprite(sprite, position + 0.5f * size, z, scale);
-                position.x += size.x + x_padding;
-            }
-
-            {   // Count
-                constexpr f32 scale = 1.0f;
-                const f32 font_size = scale * font.size;
-
-                sprintf(text_buffer, "%u/%u", state.lazer_charge, GameSettings::lazer_power_requirement);
-
-                String text = ref(text_buffer);
-                Imgui::render_text(text, font, position - Vector2 { 0.0f, 3.0f }, z, font_size);
-            }
-        }
-        
-        {   // Render Active Bonuses
-            constexpr f32 y_padding = 10.0f;
-            f32 y = 0.0f;
-
-            {   // Total Bonus
-                constexpr f32 scale = 1.0f;
-                const f32 font_size = scale * font.size;
-
-                // Kill streak
-                const s32 kill_streaks = clamp(state.player_kill_streak / GameSettings::lazer_streak_requirement, 0, GameSettings::max_kill_streak_multipliers);
-                f32 multiplier = Math::pow(GameSettings::kill_streak_multiplier, kill_streaks);
-                multiplier *= (state.player_lives == 1) ? GameSettings::low_health_multiplier : 1.0f;
-
-                sprintf(text_buffer, "Bonus: x%.1f", multiplier);
-
-                String text = ref(text_buffer);
-
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
-                Imgui::render_text(text, font, top_left, z, font_size);
-
-                y += size.y + y_padding;
-            }
-            
-            {   // Kill Streaks
-                static f32 fade_out_start_time = -100.0f;
-
-                const s32 kill_streaks = clamp(state.player_kill_streak / GameSettings::lazer_streak_requirement, 0, GameSettings::max_kill_streak_multipliers);
-                if (kill_streaks > 0)
-                    fade_out_start_time = app.time;
-
-                const f32 time_since_fade_out = app.time - fade_out_start_time;
-                if (time_since_fade_out < GameSettings::ui_fade_out_time)
-                {
-                    constexpr f32 scale = 1.0f / Math::golden_ratio;
-                    const f32 font_size = scale * font.size;
-
-                    sprintf(text_buffer, "+ %dx Streaks", kill_streaks);
-
-                    String text = ref(text_buffer);
-
-                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                    const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
-
-                    const f32 alpha = 1.0f - (time_since_fade_out / GameSettings::ui_fade_out_time);
-                    Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, alpha });
-
-                    y += size.y + y_padding;
-                }
-            }
-            
-            {   // One the Wire ()
-                static f32 fade_out_start_time = -100.0f;
-
-                if (state.player_lives == 1)
-                    fade_out_start_time = app.time;
-
-                const f32 time_since_fade_out = app.time - fade_out_start_time;
-                if (time_since_fade_out < GameSettings::ui_fade_out_time)
-                {
-                    constexpr f32 scale = 1.0f / Math::golden_ratio;
-                    const f32 font_size = scale * font.size;
-
-                    String text = ref("+ On The Wire");
-
-                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-                    const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
-
-                    const f32 alpha = 1.0f - (time_since_fade_out / GameSettings::ui_fade_out_time);
-                    Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, alpha });
-
-                    y += size.y + y_padding;
-                }
-            }
-        }
-
-        z += z_offset;
-    }
-
-    Imgui::set_offset(state.game_rect.left, state.game_rect.top);
-
-    if (state.current_screen & GameScreen::SETTINGS_MENU)
-    {
-        constexpr f32 y_offset = 5.0f;
-        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
-        
-        {   // Darken Background
-            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
-            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
-
-            z += z_offset;
-        }
-        
-        {   // Main Text
-            constexpr f32 scale = Math::golden_ratio;
-            const f32 font_size = scale * font.size;
-            
-            char buffer[] = "Settings";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
-
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
-
-            y += size.y + 2 * y_offset;
-        }
-
-        bool dirty = false;
-        Settings& settings = state.player_settings;
-        
-        {   // Control Scheme
-            constexpr f32 x_padding = 10.0f;
-            constexpr f32 y_padding = 5.0f;
-
-            constexpr f32 scale = 1.0f;
-            const f32 font_size = scale * font.size;
+            constexpr f32 scale = 1.0f;
+            const f32 font_size = scale * font.size;
 
             char buffer[256];
             sprintf(buffer, "Control Scheme: %s", control_scheme_name(settings.control_scheme).data);
@@ -1871,7 +1916,7 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
                 const f32 font_size = scale * font.size;
 
                 char buffer[] = "Volume:";
-                String text = ref(buffer, sizeof(buffer) - 1);
+                String text = ref(buffer, (u64) (sizeof(buffer) - 1));
                 const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
 
                 x -= 0.5f * (size.x + x_padding + slider_width);
@@ -1957,29 +2002,259 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
         char text_buffer[256];
 
-        {   // Text
-            constexpr f32 scale = 1.0f;
+        {   // Text
+            constexpr f32 scale = 1.0f;
+            const f32 font_size = scale * font.size;
+
+            sprintf(text_buffer, "High Score: %u", state.player_settings.high_score);
+
+            String text = ref(text_buffer);
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), 0.0f };
+            Imgui::render_text(text, font, top_left, z, font_size);
+        }
+        
+        {   // Main Text
+            constexpr f32 scale = Math::golden_ratio;
+            const f32 font_size = scale * font.size;
+            
+            char buffer[] = "Invaders from Outer Space!";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
+
+            y += size.y + y_offset;
+        }
+        
+        {   // Help Text
+            const s32 blink_iterations = (s32) Math::floor(app.time / GameSettings::ui_blink_delay);
+            const f32 alpha = (blink_iterations % 2 == 0);
+
+            constexpr f32 scale = 1.0f;
+            const f32 font_size = scale * font.size;
+
+            char buffer[] = "Press ENTER to start";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 0.5f, 0.5f, 0.5f, alpha });
+
+            y += size.y + y_offset;
+        }
+
+        {   // "Tutorial"
+            const f32 font_size = GameSettings::ui_tutorial_font_scale * font.size;
+
+            char buffer[128];
+            sprintf(buffer, "%s to move\nSPACE to shoot\nZ to use lazer (when charged)", control_scheme_name(state.player_settings.control_scheme).data);
+            const String text = ref(buffer);
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.0f, state.game_playground.y - size.y };
+            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, 0.5f });
+
+            z += z_offset;
+        }
+
+        {   // Bottom Left Buttons
+            f32 y = state.game_playground.y;
+
+            {   // Quit button
+                constexpr f32 x_padding = 10.0f;
+                constexpr f32 y_padding = 5.0f;
+
+                constexpr f32 scale = 1.0f / Math::golden_ratio;
+                const f32 font_size = scale * font.size;
+
+                char buffer[] = "Quit";
+                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+
+                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+
+                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
+                    app.is_running = false;
+
+                y -= size.y + 3 * y_padding;
+            }
+
+            {   // Settings button
+                constexpr f32 x_padding = 10.0f;
+                constexpr f32 y_padding = 5.0f;
+
+                constexpr f32 scale = 1.0f / Math::golden_ratio;
+                const f32 font_size = scale * font.size;
+
+                char buffer[] = "Settings";
+                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+
+                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+
+                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
+                    screen_switch_to(state, GameScreen::SETTINGS_MENU);
+
+                y -= size.y + 3 * y_padding;
+            }
+
+            z += z_offset;
+        }
+    }
+    else if (state.current_screen & GameScreen::PAUSE_MENU)
+    {
+        constexpr f32 y_offset = 5.0f;
+        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
+
+        {   // Darken Background
+            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
+            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
+
+            z += z_offset;
+        }
+
+        {   // Main Text
+            constexpr f32 scale = Math::golden_ratio;
+            const f32 font_size = scale * font.size;
+
+            char buffer[] = "Paused";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
+
+            y += size.y + y_offset;
+        }
+        
+        {   // Help Text
+            const s32 blink_iterations = (s32) Math::floor(app.time / GameSettings::ui_blink_delay);
+            const f32 alpha = (blink_iterations % 2 == 0);
+            
+            constexpr f32 scale = 1.0f;
+            const f32 font_size = scale * font.size;
+
+            char buffer[] = "Press ESC to resume";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 0.5f, 0.5f, 0.5f, alpha });
+
+            y += size.y + y_offset;
+        }
+
+        {   // Bottom Left Buttons
+            f32 y = state.game_playground.y;
+
+            {   // Quit button
+                constexpr f32 x_padding = 10.0f;
+                constexpr f32 y_padding = 5.0f;
+
+                constexpr f32 scale = 1.0f / Math::golden_ratio;
+                const f32 font_size = scale * font.size;
+
+                char buffer[] = "Quit";
+                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+
+                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+
+                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
+                    app.is_running = false;
+
+                y -= size.y + 3 * y_padding;
+            }
+
+            {   // Settings button
+                constexpr f32 x_padding = 10.0f;
+                constexpr f32 y_padding = 5.0f;
+
+                constexpr f32 scale = 1.0f / Math::golden_ratio;
+                const f32 font_size = scale * font.size;
+
+                char buffer[] = "Settings";
+                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+
+                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+
+                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
+                    screen_switch_to(state, GameScreen::SETTINGS_MENU);
+
+                y -= size.y + 3 * y_padding;
+            }
+            
+            {   // Restart button
+                constexpr f32 x_padding = 10.0f;
+                constexpr f32 y_padding = 5.0f;
+
+                constexpr f32 scale = 1.0f / Math::golden_ratio;
+                const f32 font_size = scale * font.size;
+
+                char buffer[] = "Restart";
+                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+
+                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+
+                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
+                {
+                    game_state_reset(app, state);
+                    screen_clear_and_switch_to(state, GameScreen::GAME);
+                }
+
+                y -= size.y + 3 * y_padding;
+            }
+
+            z += z_offset;
+        }
+    }
+    else if (state.current_screen & GameScreen::HIGH_SCORE)
+    {
+        constexpr f32 y_offset = 5.0f;
+        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
+
+        {   // Darken Background
+            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
+            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
+
+            z += z_offset;
+        }
+
+        {   // Main Text
+            constexpr f32 scale = Math::golden_ratio;
             const f32 font_size = scale * font.size;
 
-            sprintf(text_buffer, "High Score: %u", state.player_settings.high_score);
-
-            String text = ref(text_buffer);
+            char buffer[] = "New High Score!";
+            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
             const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), 0.0f };
-            Imgui::render_text(text, font, top_left, z, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, high_score_color);
+
+            y += size.y + y_offset;
         }
         
-        {   // Main Text
-            constexpr f32 scale = Math::golden_ratio;
+        {   // Score Text
+            constexpr f32 scale = 1.0f;
             const f32 font_size = scale * font.size;
-            
-            char buffer[] = "Invaders from Outer Space!";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
+            char buffer[128];
+            sprintf(buffer, "Score: %u", state.player_score);
+            
+            const String text = ref(buffer);
             const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
             const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
+            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, 1.0f });
 
             y += size.y + y_offset;
         }
@@ -1991,7 +2266,7 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
             constexpr f32 scale = 1.0f;
             const f32 font_size = scale * font.size;
 
-            char buffer[] = "Press ENTER to start";
+            char buffer[] = "Press ENTER to continue";
             const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
             const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
@@ -2000,21 +2275,7 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
             y += size.y + y_offset;
         }
-
-        {   // "Tutorial"
-            const f32 font_size = GameSettings::ui_tutorial_font_scale * font.size;
-
-            char buffer[128];
-            sprintf(buffer, "%s to move\nSPACE to shoot\nZ to use lazer (when charged)", control_scheme_name(state.player_settings.control_scheme).data);
-            const String text = ref(buffer);
-
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.0f, state.game_playground.y - size.y };
-            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, 0.5f });
-
-            z += z_offset;
-        }
-
+        
         {   // Bottom Left Buttons
             f32 y = state.game_playground.y;
 
@@ -2060,19 +2321,8 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
             z += z_offset;
         }
-
-        if (Input::get_key_down(Key::ENTER))
-        {
-            screen_clear_and_switch_to(state, GameScreen::GAME);
-
-            // Delete all player bullets
-            clear(state.player_bullets.animations);
-            clear(state.player_bullets.positions);
-
-            Audio::source_stop(source_main_menu);
-        }
     }
-    else if (state.current_screen & GameScreen::PAUSE_MENU)
+    else if (state.current_screen & GameScreen::GAME_OVER)
     {
         constexpr f32 y_offset = 5.0f;
         f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
@@ -2088,7 +2338,7 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
             constexpr f32 scale = Math::golden_ratio;
             const f32 font_size = scale * font.size;
 
-            char buffer[] = "Paused";
+            char buffer[] = "You Died";
             const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
             const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
@@ -2098,14 +2348,37 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
             y += size.y + y_offset;
         }
         
+        {   // Score Text
+            constexpr f32 scale = 1.0f;
+            const f32 font_size = scale * font.size;
+
+            char buffer[128];
+            Vector4 color = Vector4(1.0f);
+
+            if (!state.new_high_score)
+                sprintf(buffer, "Score: %u", state.player_score);
+            else
+            {
+                sprintf(buffer, "New High Score: %u", state.player_score);
+                color = high_score_color;
+            }
+            
+            const String text = ref(buffer);
+            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
+            Imgui::render_text(text, font, top_left, z, font_size, color);
+
+            y += size.y + y_offset;
+        }
+        
         {   // Help Text
             const s32 blink_iterations = (s32) Math::floor(app.time / GameSettings::ui_blink_delay);
             const f32 alpha = (blink_iterations % 2 == 0);
-            
+
             constexpr f32 scale = 1.0f;
             const f32 font_size = scale * font.size;
 
-            char buffer[] = "Press ESC to resume";
+            char buffer[] = "Press ENTER to restart";
             const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
 
             const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
@@ -2114,7 +2387,7 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
             y += size.y + y_offset;
         }
-
+        
         {   // Bottom Left Buttons
             f32 y = state.game_playground.y;
 
@@ -2157,260 +2430,403 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
                 y -= size.y + 3 * y_padding;
             }
-            
-            {   // Restart button
-                constexpr f32 x_padding = 10.0f;
-                constexpr f32 y_padding = 5.0f;
 
-                constexpr f32 scale = 1.0f / Math::golden_ratio;
-                const f32 font_size = scale * font.size;
+            z += z_offset;
+        }
 
-                char buffer[] = "Restart";
-                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+        z += z_offset;
+    }
+}
 
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+// Uses Imgui
+void game_state_render(Application& app, GameState& state, const Imgui::Font& font)
+{
+    const Vector2 relative_scale = Vector2 { (state.game_rect.right - state.game_rect.left) / state.game_playground.x, (state.game_rect.bottom - state.game_rect.top) / state.game_playground.y };
+    Imgui::set_scale(relative_scale.x, relative_scale.y);
+    Imgui::set_offset(state.game_rect.left, state.game_rect.top);
 
-                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+    constexpr f32 z_offset = -0.00001f;
+    f32 z = 0.8f;
 
-                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
-                {
-                    game_state_reset(app, state);
-                    screen_clear_and_switch_to(state, GameScreen::GAME);
-                }
+    const Vector2 player_position = lerp(state.player_previous_position, state.player_position, state.render_alpha);
 
-                y -= size.y + 3 * y_padding;
-            }
+    {   // Render Background
+        StarfieldView view = {};
+        view.playground  = state.game_playground;
+        view.scale       = relative_scale;
+        view.offset      = Vector2 { state.game_rect.left, state.game_rect.top };
+        view.screen_size = Vector2 { (f32) app.window.ref_width, (f32) app.window.ref_height };
+        view.z           = z;
 
-            z += z_offset;
+        if (state.player_settings.dynamic_background)
+        {
+            const Vector2 center = Vector2 { 0.5f * state.game_playground.x, state.game_playground.y - 0.5f * GameSettings::player_region_height };
+            view.parallax = -GameSettings::background_star_offset_multiplier * (player_position - center);
         }
+
+        Imgui::render_starfield(state.starfield, view);
+
+        z += z_offset;
     }
-    else if (state.current_screen & GameScreen::HIGH_SCORE)
+
+    if (!(state.current_screen & ~(GameScreen::GAME | GameScreen::GAME_OVER)))
     {
-        constexpr f32 y_offset = 5.0f;
-        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
+        if (state.is_lazer_active)
+        {
+            const f32 x_offset = state.game_rect.left + relative_scale.x * GameSettings::screen_shake_amplitude_lazer * (Math::random() * 2 - 1);
+            const f32 y_offset = state.game_rect.top  + relative_scale.y * GameSettings::screen_shake_amplitude_lazer * (Math::random() * 2 - 1);
+            Imgui::set_offset(x_offset, y_offset);
+        }
+        else if (state.time_since_screen_shake_start <= GameSettings::screen_shake_enemy_kill_duration)
+        {
+            const f32 x_offset = state.game_rect.left + relative_scale.x * GameSettings::screen_shake_amplitude_enemy * (Math::random() * 2 - 1);
+            const f32 y_offset = state.game_rect.top  + relative_scale.y * GameSettings::screen_shake_amplitude_enemy * (Math::random() * 2 - 1);
+            Imgui::set_offset(x_offset, y_offset);
+        }
+    }
 
-        {   // Darken Background
-            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
-            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
+    entity_render(state, state.enemies[0], z);
+    entity_render(state, state.enemies[1], z);
+    entity_render(state, state.enemies[2], z);
+    entity_render(state, state.kamikaze_enemies, z);
 
-            z += z_offset;
+    if (state.is_lazer_active)
+    {
+        const Animation2D& anim = state.anims[(u64) BulletType::LAZER];
+        const Vector2 sprite_size = anim.sprites[0].size;
+
+        Vector2 position = state.lazer_position;
+        position.y -= state.lazer_start * GameSettings::render_scale.y * sprite_size.y;
+        for (u32 i = state.lazer_start; i < state.lazer_end; i++)
+        {
+            const Sprite& sprite = anim.sprites[state.lazer_chunk.instance.current_frame_index];
+            Imgui::render_sprite(sprite, position, z, GameSettings::render_scale);
+
+            position.y -= GameSettings::render_scale.y * sprite.size.y;
         }
 
-        {   // Main Text
-            constexpr f32 scale = Math::golden_ratio;
-            const f32 font_size = scale * font.size;
+        z += z_offset;
+    }
 
-            char buffer[] = "New High Score!";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+    entity_render(state, state.explosions, z);
+    entity_render(state, state.power_shot_explosions, z);
 
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, high_score_color);
+    {   // Render Particles
+        const Vector2 half_size = 0.5f * GameSettings::particle_size * GameSettings::render_scale;
 
-            y += size.y + y_offset;
+        for (u64 i = 0; i < state.particles.count; i++)
+        {
+            const Vector2 position = particles_get_position(state.particles, i, state.render_alpha);
+            const Rect rect = Rect { position.x - half_size.x, position.y - half_size.y, position.x + half_size.x, position.y + half_size.y };
+
+            Imgui::render_rect(rect, z, particles_get_color(state.particles, i));
         }
-        
-        {   // Score Text
-            constexpr f32 scale = 1.0f;
-            const f32 font_size = scale * font.size;
 
-            char buffer[128];
-            sprintf(buffer, "Score: %u", state.player_score);
-            
-            const String text = ref(buffer);
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, 1.0f });
+        z += z_offset;
+    }
 
-            y += size.y + y_offset;
-        }
-        
-        {   // Help Text
-            const s32 blink_iterations = (s32) Math::floor(app.time / GameSettings::ui_blink_delay);
-            const f32 alpha = (blink_iterations % 2 == 0);
+    entity_render(state, state.pickups, z);
+    entity_render(state, state.player_bullets, z);
+    entity_render(state, state.enemy_bullets, z);
 
-            constexpr f32 scale = 1.0f;
-            const f32 font_size = scale * font.size;
+    {   // Render Pattern Bullets
+        const Animation2D& animation = state.anims[bullet_enemy_animation_index];
 
-            char buffer[] = "Press ENTER to continue";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+        // All of them share a single instance, they're too many to animate one by one
+        Animation2D::Instance instance;
+        animation_start_instance(instance, 0.0f);
+        animation_step_instance(animation, instance, app.time);
 
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 0.5f, 0.5f, 0.5f, alpha });
+        const Sprite& sprite = animation.sprites[instance.current_frame_index];
 
-            y += size.y + y_offset;
+        for (u64 i = 0; i < state.pattern_bullets.count; i++)
+            Imgui::render_sprite(sprite, bullet_pool_get_position(state.pattern_bullets, i, state.render_alpha), z, GameSettings::render_scale);
+
+        z += z_offset;
+    }
+    
+    // Render Player
+    if (!(state.current_screen & GameScreen::GAME_OVER))
+    {
+        const Animation2D& anim = state.anims[state.player_animation.animation_index];
+        const Sprite& sprite = anim.sprites[state.player_animation.instance.current_frame_index];
+        Imgui::render_sprite(sprite, player_position, z, GameSettings::render_scale);
+
+        z += z_offset;
+    }
+
+    if (!(state.current_screen & (GameScreen::MAIN_MENU | GameScreen::GAME_OVER)))
+    {
+        // Render UI
+
+        {   // Render lives
+            constexpr f32 x_offset = 20.0f;
+            const f32 scale = GameSettings::render_scale.x / 2.0f;
+
+            const Sprite& sprite = state.anims[(u64) PlayerState::NORMAL].sprites[0];
+            Vector2 position = Vector2 { scale * (sprite.size.x / 2.0f), state.game_playground.y - scale * (sprite.size.y / 2.0f) };
+
+            for (s32 i = 0; i < state.player_lives; i++)
+            {
+                Imgui::render_sprite(sprite, position, z, Vector2 { scale, scale });
+                position.x += sprite.size.x + x_offset;
+            }
         }
-        
-        {   // Bottom Left Buttons
-            f32 y = state.game_playground.y;
 
-            {   // Quit button
-                constexpr f32 x_padding = 10.0f;
-                constexpr f32 y_padding = 5.0f;
+        constexpr f32 x_padding = 10.0f;
+        char text_buffer[128];
+
+        {   // Render Ammo
+            Vector2 position = state.game_playground;
+
+            // Render Power Shot Ammo
+            if (state.player_equipped_bullet_type == BulletType::POWER_SHOT)
+            {
+                {   // Count
+                    constexpr f32 scale = 1.0f;
+                    const f32 font_size = scale * font.size;
 
-                constexpr f32 scale = 1.0f / Math::golden_ratio;
-                const f32 font_size = scale * font.size;
+                    String text = ref(text_buffer, 0);
+                    to_string(text, state.player_power_shot_ammo);
 
-                char buffer[] = "Quit";
-                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    Imgui::render_text(text, font, position - size + Vector2 { 0.0f, 1.0f }, z, font_size);
 
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    position.x -= size.x + x_padding;
+                }
 
-                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+                {   // Sprite
+                    const Sprite& sprite = state.anims[(u64) PickupType::POWER_SHOT].sprites[0];
+                    const Vector2 scale = Vector2 { 2.5f, 2.5f };
+                    const Vector2 size = scale * sprite.size;
 
-                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
-                    app.is_running = false;
+                    Imgui::render_sprite(sprite, position - 0.5f * size, z, scale);
+                    position.x -= size.x + x_padding;
+                }
 
-                y -= size.y + 3 * y_padding;
+                z += z_offset;
             }
 
-            {   // Settings button
-                constexpr f32 x_padding = 10.0f;
-                constexpr f32 y_padding = 5.0f;
-
-                constexpr f32 scale = 1.0f / Math::golden_ratio;
-                const f32 font_size = scale * font.size;
+            position.x -= x_padding;
 
-                char buffer[] = "Settings";
-                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+            // Render Extra Shot Ammo
+            if (state.player_bullets_per_shot > 1)
+            {
+                {   // Count
+                    constexpr f32 scale = 1.0f;
+                    const f32 font_size = scale * font.size;
 
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    String text = ref(text_buffer, 0);
+                    to_string(text, state.player_extra_shot_ammo);
 
-                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    Imgui::render_text(text, font, position - size + Vector2 { 0.0f, 1.0f }, z, font_size);
 
-                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
-                    screen_switch_to(state, GameScreen::SETTINGS_MENU);
+                    position.x -= size.x + x_padding;
+                }
 
-                y -= size.y + 3 * y_padding;
-            }
-            
+                {   // Sprite
+                    const Sprite& sprite = state.anims[(u64) PickupType::EXTRA_SHOT].sprites[0];
+                    const Vector2 scale = Vector2 { 2.5f, 2.5f };
+                    const Vector2 size = scale * sprite.size;
 
-            if (Input::get_key_down(Key::ENTER))
-                screen_switch_off(state, GameScreen::HIGH_SCORE);
+                    Imgui::render_sprite(sprite, position - 0.5f * size, z, scale);
+                    position.x -= size.x + x_padding;
+                }
 
-            z += z_offset;
+                z += z_offset;
+            }
         }
-    }
-    else if (state.current_screen & GameScreen::GAME_OVER)
-    {
-        constexpr f32 y_offset = 5.0f;
-        f32 y = state.game_playground.y * (1.0f - (1.0f / Math::golden_ratio));
+        
+        {   // Render Score
+            {   // Text
+                constexpr f32 scale = 1.0f;
+                const f32 font_size = scale * font.size;
 
-        {   // Darken Background
-            Rect rect = Rect { 0.0f, 0.0f, (f32) state.game_playground.x, (f32) state.game_playground.y };
-            Imgui::render_rect(rect, z, Vector4 { 0.0f, 0.0f, 0.0f, GameSettings::ui_background_alpha });
+                Vector4 color = Vector4(1.0f);
+                if (state.player_score <= state.player_settings.high_score)
+                    sprintf(text_buffer, "Score: %u", state.player_score);
+                else
+                {
+                    sprintf(text_buffer, "High Score: %u", state.player_score);
+                    color = high_score_color;
+                }
 
-            z += z_offset;
+                String text = ref(text_buffer);
+
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), 0.0f };
+                Imgui::render_text(text, font, top_left, z, font_size, color);
+            }
         }
 
-        {   // Main Text
-            constexpr f32 scale = Math::golden_ratio;
-            const f32 font_size = scale * font.size;
+        {   // Render Lazer Charge
+            Vector2 position = Vector2 { 0.0f, 0.0f };
 
-            char buffer[] = "You Died";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+            {   // Sprite
+                const Sprite& sprite = state.anims[(u64) PickupType::LAZER_CHARGE].sprites[0];
+                const Vector2 scale = Vector2 { 2.5f, 2.5f };
+                const Vector2 size = scale * sprite.size;
 
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, heading_color);
+                Imgui::render_sprite(sprite, position + 0.5f * size, z, scale);
+                position.x += size.x + x_padding;
+            }
 
-            y += size.y + y_offset;
-        }
-        
-        {   // Score Text
-            constexpr f32 scale = 1.0f;
-            const f32 font_size = scale * font.size;
+            {   // Count
+                constexpr f32 scale = 1.0f;
+                const f32 font_size = scale * font.size;
 
-            char buffer[128];
-            Vector4 color = Vector4(1.0f);
+                sprintf(text_buffer, "%u/%u", state.lazer_charge, GameSettings::lazer_power_requirement);
 
-            if (!state.new_high_score)
-                sprintf(buffer, "Score: %u", state.player_score);
-            else
-            {
-                sprintf(buffer, "New High Score: %u", state.player_score);
-                color = high_score_color;
+                String text = ref(text_buffer);
+                Imgui::render_text(text, font, position - Vector2 { 0.0f, 3.0f }, z, font_size);
             }
-            
-            const String text = ref(buffer);
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, color);
-
-            y += size.y + y_offset;
         }
         
-        {   // Help Text
-            const s32 blink_iterations = (s32) Math::floor(app.time / GameSettings::ui_blink_delay);
-            const f32 alpha = (blink_iterations % 2 == 0);
+        {   // Render Active Bonuses
+            constexpr f32 y_padding = 10.0f;
+            f32 y = 0.0f;
 
-            constexpr f32 scale = 1.0f;
-            const f32 font_size = scale * font.size;
+            {   // Total Bonus
+                constexpr f32 scale = 1.0f;
+                const f32 font_size = scale * font.size;
 
-            char buffer[] = "Press ENTER to restart";
-            const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+                // Kill streak
+                const s32 kill_streaks = clamp(state.player_kill_streak / GameSettings::lazer_streak_requirement, 0, GameSettings::max_kill_streak_multipliers);
+                f32 multiplier = Math::pow(GameSettings::kill_streak_multiplier, kill_streaks);
+                multiplier *= (state.player_lives == 1) ? GameSettings::low_health_multiplier : 1.0f;
 
-            const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
-            const Vector2 top_left = Vector2 { 0.5f * (state.game_playground.x - size.x), y };
-            Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 0.5f, 0.5f, 0.5f, alpha });
+                sprintf(text_buffer, "Bonus: x%.1f", multiplier);
 
-            y += size.y + y_offset;
-        }
-        
-        {   // Bottom Left Buttons
-            f32 y = state.game_playground.y;
+                String text = ref(text_buffer);
 
-            {   // Quit button
-                constexpr f32 x_padding = 10.0f;
-                constexpr f32 y_padding = 5.0f;
+                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
+                Imgui::render_text(text, font, top_left, z, font_size);
 
-                constexpr f32 scale = 1.0f / Math::golden_ratio;
-                const f32 font_size = scale * font.size;
+                y += size.y + y_padding;
+            }
+            
+            {   // Kill Streaks
+                static f32 fade_out_start_time = -100.0f;
 
-                char buffer[] = "Quit";
-                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+                const s32 kill_streaks = clamp(state.player_kill_streak / GameSettings::lazer_streak_requirement, 0, GameSettings::max_kill_streak_multipliers);
+                if (kill_streaks > 0)
+                    fade_out_start_time = app.time;
 
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                const f32 time_since_fade_out = app.time - fade_out_start_time;
+                if (time_since_fade_out < GameSettings::ui_fade_out_time)
+                {
+                    constexpr f32 scale = 1.0f / Math::golden_ratio;
+                    const f32 font_size = scale * font.size;
 
-                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+                    sprintf(text_buffer, "+ %dx Streaks", kill_streaks);
 
-                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
-                    app.is_running = false;
+                    String text = ref(text_buffer);
 
-                y -= size.y + 3 * y_padding;
-            }
+                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
 
-            {   // Settings button
-                constexpr f32 x_padding = 10.0f;
-                constexpr f32 y_padding = 5.0f;
+                    const f32 alpha = 1.0f - (time_since_fade_out / GameSettings::ui_fade_out_time);
+                    Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, alpha });
 
-                constexpr f32 scale = 1.0f / Math::golden_ratio;
-                const f32 font_size = scale * font.size;
+                    y += size.y + y_padding;
+                }
+            }
+            
+            {   // One the Wire ()
+                static f32 fade_out_start_time = -100.0f;
 
-                char buffer[] = "Settings";
-                const String text = ref(buffer, (u64)(sizeof(buffer) - 1));
+                if (state.player_lives == 1)
+                    fade_out_start_time = app.time;
 
-                const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                const f32 time_since_fade_out = app.time - fade_out_start_time;
+                if (time_since_fade_out < GameSettings::ui_fade_out_time)
+                {
+                    constexpr f32 scale = 1.0f / Math::golden_ratio;
+                    const f32 font_size = scale * font.size;
 
-                Rect rect = Rect { state.game_playground.x - size.x - 2 * x_padding, y - size.y - 2 * y_padding, state.game_playground.x, y };
+                    String text = ref("+ On The Wire");
 
-                if (Imgui::render_text_button(imgui_gen_id(), rect, text, font, Vector2 { x_padding, y_padding }, z, font_size))
-                    screen_switch_to(state, GameScreen::SETTINGS_MENU);
+                    const Vector2 size = Imgui::get_rendered_text_size(text, font, font_size);
+                    const Vector2 top_left = Vector2 { (state.game_playground.x - size.x), y };
 
-                y -= size.y + 3 * y_padding;
+                    const f32 alpha = 1.0f - (time_since_fade_out / GameSettings::ui_fade_out_time);
+                    Imgui::render_text(text, font, top_left, z, font_size, Vector4 { 1.0f, 1.0f, 1.0f, alpha });
+
+                    y += size.y + y_padding;
+                }
             }
+        }
 
-            z += z_offset;
+        z += z_offset;
+    }
+
+    Imgui::set_offset(state.game_rect.left, state.game_rect.top);
+
+    {   // Render Menus
+        // Everything render_menus shows that can change without a widget being used
+        struct MenuKey
+        {
+            u32 screen;
+            u32 font_id;
+            s32 blink_phase;
+            u32 player_score;
+            u32 high_score;
+            u32 new_high_score;
+            u32 control_scheme;
+            u32 window_style;
+            u32 dynamic_background;
+            u32 mute_audio;
+            f32 volume;
+            f32 playground_x, playground_y;
+        };
+
+        // Only 4 byte fields, so there's no padding in the comparison
+        MenuKey key;
+        key.screen             = state.current_screen;
+        key.font_id            = font.id;
+        key.blink_phase        = (s32) Math::floor(app.time / GameSettings::ui_blink_delay) % 2;
+        key.player_score       = state.player_score;
+        key.high_score         = state.player_settings.high_score;
+        key.new_high_score     = state.new_high_score;
+        key.control_scheme     = (u32) state.player_settings.control_scheme;
+        key.window_style       = (u32) app.window.style;
+        key.dynamic_background = state.player_settings.dynamic_background;
+        key.mute_audio         = state.player_settings.mute_audio;
+        key.volume             = state.player_settings.volume;
+        key.playground_x       = state.game_playground.x;
+        key.playground_y       = state.game_playground.y;
+
+        if (Imgui::retained_begin(state.menu_ui, &key, sizeof(key), z))
+        {
+            render_menus(app, state, font, z);
+            Imgui::retained_end(state.menu_ui, z);
         }
+    }
 
-        if (Input::get_key_down(Key::ENTER))
+    if (!(state.current_screen & GameScreen::SETTINGS_MENU) && Input::get_key_down(Key::ENTER))
+    {
+        if (state.current_screen & GameScreen::MAIN_MENU)
         {
-            game_state_reset(app, state);
             screen_clear_and_switch_to(state, GameScreen::GAME);
-        }
 
-        z += z_offset;
+            // Delete all player bullets
+            clear(state.player_bullets.animations);
+            clear(state.player_bullets.positions);
+
+            Audio::source_stop(source_main_menu);
+        }
+        else if (!(state.current_screen & GameScreen::PAUSE_MENU))
+        {
+            if (state.current_screen & GameScreen::HIGH_SCORE)
+                screen_switch_off(state, GameScreen::HIGH_SCORE);
+            else if (state.current_screen & GameScreen::GAME_OVER)
+            {
+                game_state_reset(app, state);
+                screen_clear_and_switch_to(state, GameScreen::GAME);
+            }
+        }
     }
     
     {   // Render Black Bars to hide anything off the playground
@@ -2582,13 +2998,13 @@ void game_state_render(Application& app, GameState& state, const Imgui::Font& fo
 
         {   // Render Pickup Deck
             constexpr f32 padding = 5.0f;
-            const Vector2 sprite_size = state.anims[(u64) pickup_deck[0]].sprites[0].size; 
+            const Vector2 sprite_size = state.anims[(u64) state.pickup_deck[0]].sprites[0].size; 
 
-            Vector2 position = Vector2 { 0.5f * (state.game_playground.x - pickup_deck.size * sprite_size.x - (pickup_deck.size - 1) * padding), state.game_playground.y - sprite_size.y };
-            for (u64 i = 0; i < pickup_deck.size; i++)
+            Vector2 position = Vector2 { 0.5f * (state.game_playground.x - state.pickup_deck.size * sprite_size.x - (state.pickup_deck.size - 1) * padding), state.game_playground.y - sprite_size.y };
+            for (u64 i = 0; i < state.pickup_deck.size; i++)
             {
-                const Sprite& sprite = state.anims[(u64) pickup_deck[i]].sprites[0];
-                const f32 alpha = (i == pickup_deck_index) ? 1.0f : 0.5f;
+                const Sprite& sprite = state.anims[(u64) state.pickup_deck[i]].sprites[0];
+                const f32 alpha = (i == state.pickup_deck_index) ? 1.0f : 0.5f;
 
                 Imgui::render_sprite(sprite, position, z, Vector2 { 1.0f, 1.0f }, Vector4 { 1.0f, 1.0f, 1.0f, alpha });
                 position.x += sprite.size.x + padding;
@@ -3,10 +3,19 @@
 #include "application/application.h"
 #include "core/coroutines.h"
 #include "engine/imgui.h"
+#include "engine/particles.h"
 #include "engine/sprite.h"
+#include "engine/starfield.h"
+#include "engine/steering.h"
+#include "math/common.h"
 #include "math/vecs/vector2.h"
 #include "player_settings.h"
+#include "bullet_patterns.h"
+#include "bullet_pool.h"
+#include "formation.h"
+#include "game_input.h"
 #include "game_settings.h"
+#include "stage_schedule.h"
 
 struct AnimationData
 {
@@ -18,6 +27,18 @@ struct EntityData
 {
     DynamicArray<Vector2> positions;
     DynamicArray<AnimationData> animations;
+
+    // Positions at the start of the last tick, rendering blends from these to the current ones.
+    // Adding and removing keeps them in lockstep with positions, so they only have to be copied
+    // over at the start of a tick if the positions were written during the previous one (moved)
+    DynamicArray<Vector2> previous_positions;
+    bool moved;
+
+    // Steered entities (kamikaze enemies) also keep a target and the velocity of their last move,
+    // in lockstep the same way. Everything else leaves these empty
+    DynamicArray<Vector2> targets;
+    DynamicArray<Vector2> velocities;
+    bool steered;
 };
 
 // All enum values correspond to the index of their corresponding animation
@@ -67,33 +88,23 @@ namespace GameScreen
     static constexpr u32 HIGH_SCORE    = (1 << 5);
 }
 
-struct StageSettings
-{
-    u32 number;
-
-    u32 enemy_column_count;
-    u32 enemy_row_count;
-
-    Vector2 enemy_move_speed;
-
-    f32 enemy_rearrange_delay;
-    f32 enemy_kamikaze_delay;
-    f32 enemy_shot_delay;
-
-    s32 enemy_spawn_counts[3];
-};
-
 struct GameState
 {
     Coroutine state_co;
 
+    // All randomness in the gameplay comes from here so a seed reproduces the game
+    Math::Random rng;
+    GameInput input;
+
     DynamicArray<Animation2D> anims;
+    AnimationFrameTables anim_tables;
 
     s32 player_lives;
     s32 player_kill_streak;
     u32 player_score;
 
     Vector2 player_position;
+    Vector2 player_previous_position;
     Vector2 player_size;
     f32 player_time_since_last_shot;
     u64 player_previous_animation_index;
@@ -110,11 +121,15 @@ struct GameState
     f32 enemy_time_since_last_kamikaze;
     f32 enemy_time_since_last_rearrangement;
 
-    Coroutine stage_co;
+    StageSchedule stage_schedule;
     StageSettings current_stage;
 
-    DynamicArray<Vector2> enemy_slots[(u64) EnemyType::NUM_TYPES];
-    DynamicArray<Vector2> empty_slots;
+    // Scales the size of every wave, only changed to stress test the simulation
+    u32 enemy_count_multiplier;
+
+    // Formation slot of every enemy, in lockstep with its entity data
+    Formation formation;
+    DynamicArray<u32> enemy_slots[(u64) EnemyType::NUM_TYPES];
     f32 time_since_screen_shake_start;
 
     EntityData player_bullets;
@@ -125,10 +140,22 @@ struct GameState
     EntityData pickups;
     EntityData kamikaze_enemies;
 
-    DynamicArray<Vector2> kamikaze_targets;
+    // Enemy fire from the bullet patterns, the wave script fires the next step once its delay has passed
+    BulletPatterns bullet_patterns;
+    BulletPool pattern_bullets;
+    u32 bullet_wave_step;
+    u32 bullet_wave_fire_count;
+    f32 bullet_wave_time;
+
+    // Explosion debris, purely visual so snapshots leave it out
+    ParticlePool particles;
+
+    DynamicArray<PickupType> pickup_deck;
+    u64 pickup_deck_index;
 
     DynamicArray<Vector3> star_positions;
     DynamicArray<u64> star_sprite_indices;
+    Starfield starfield;
 
     AnimationData lazer_chunk;
     u32 lazer_charge;
@@ -141,16 +168,35 @@ struct GameState
     Rect    game_rect;
     Vector2 game_playground;
 
+    // How far rendering is between the previous and the current tick (0 to 1), fixed step callers set this
+    f32 render_alpha;
+
     u32 current_screen;
+    Imgui::RetainedSection menu_ui;     // The menus are only drawn again when something on them changed
     Settings player_settings;
     bool new_high_score;
     bool is_debug;
 };
 
 void game_background_init(Application& app, GameState& state);
+void game_background_upload(GameState& state);    // After the stars or their sprites change
 
 void game_state_init(Application& app, GameState& state);
+void game_state_reset(Application& app, GameState& state);
+void game_state_skip_to_stage(Application& app, GameState& state, u32 stage_number);
 void game_state_update(Application& app, GameState& state);
+
+// game_state_update is split in two so fixed step callers (replays) can handle
+// the menu keys once per frame and then simulate any number of ticks
+void game_state_update_screens(GameState& state);
+void game_state_simulate(Application& app, GameState& state);
+
+// Makes the previous positions match the current ones so rendering doesn't blend from stale data (e.g. after a restore)
+void game_state_sync_previous(GameState& state);
+
+// Keeps every animation instance inside its animation after the animations were reloaded with fewer frames
+void game_state_clamp_animation_frames(GameState& state);
+
 void game_state_render(Application& app, GameState& state, const Imgui::Font& font);
 
 void game_state_window_resize(const Application& app, GameState& state);
\ No newline at end of file
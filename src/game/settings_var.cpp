@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/types.h"
+#include "engine/particles.h"
 #include "math/vecs/vector2.h"
 #include "serialization/json.h"
 
@@ -99,4 +100,11 @@ namespace GameSettings
     f32 screen_shake_amplitude_lazer;
     f32 screen_shake_amplitude_enemy;
     f32 screen_shake_enemy_kill_duration;
+
+    // Particles
+    Vector2 particle_acceleration;
+    f32 particle_drag;
+    f32 particle_size;
+    ParticleEmitter explosion_particles;
+    ParticleEmitter power_shot_particles;
 };
\ No newline at end of file
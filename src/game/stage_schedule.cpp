@@ -0,0 +1,158 @@
+#include "stage_schedule.h"
+
+#include "core/logger.h"
+#include "core/types.h"
+#include "math/common.h"
+#include "math/constants.h"
+#include "serialization/json.h"
+#include "game_settings.h"
+
+static inline void stage_apply_spawn_increments(StageSettings& stage)
+{
+    for (u64 i = 0; i < 3; i++)
+    {
+        const bool should_increase = (stage.number % GameSettings::enemy_spawn_count_increase_intervals[i]) == 0;
+        stage.enemy_spawn_counts[i] += GameSettings::enemy_spawn_count_increments[i] * should_increase;
+    }
+}
+
+static StageSettings stage_first()
+{
+    StageSettings stage;
+
+    stage.number = 1;
+    stage.enemy_column_count = GameSettings::enemy_column_start_count;
+    stage.enemy_row_count = GameSettings::enemy_row_start_count;
+
+    stage.enemy_move_speed = GameSettings::enemy_move_speed;
+
+    stage.enemy_rearrange_delay = GameSettings::enemy_rearrange_delay;
+    stage.enemy_kamikaze_delay = GameSettings::enemy_kamikaze_delay;
+    stage.enemy_shot_delay = GameSettings::enemy_shot_delay;
+
+    stage.enemy_spawn_counts[0] = GameSettings::enemy_start_spawn_counts[0];
+    stage.enemy_spawn_counts[1] = GameSettings::enemy_start_spawn_counts[1];
+    stage.enemy_spawn_counts[2] = GameSettings::enemy_start_spawn_counts[2];
+
+    stage_apply_spawn_increments(stage);
+
+    return stage;
+}
+
+static StageSettings stage_next(const StageSettings& previous, const StageChange& change)
+{
+    StageSettings stage = previous;
+
+    stage.enemy_row_count    = min(stage.enemy_row_count + change.enemy_row_increase, change.enemy_row_max);
+    stage.enemy_column_count = min(stage.enemy_column_count + change.enemy_column_increase, change.enemy_column_max);
+
+    stage.enemy_move_speed += change.enemy_move_speed_increase;
+
+    stage.enemy_rearrange_delay = max(stage.enemy_rearrange_delay - change.enemy_rearrange_delay_decrease, change.enemy_rearrange_delay_min);
+    stage.enemy_kamikaze_delay  = max(stage.enemy_kamikaze_delay - change.enemy_kamikaze_delay_decrease, change.enemy_kamikaze_delay_min);
+    stage.enemy_shot_delay      = max(stage.enemy_shot_delay - change.enemy_shot_delay_decrease, change.enemy_shot_delay_min);
+
+    stage.number++;
+    stage_apply_spawn_increments(stage);
+
+    return stage;
+}
+
+static void stage_schedule_compile(StageSchedule& schedule, u64 stage_count)
+{
+    if (schedule.stages.size == 0)
+        append(schedule.stages, stage_first());
+
+    while (schedule.stages.size < stage_count)
+    {
+        const StageSettings& previous = schedule.stages[schedule.stages.size - 1];
+
+        // Going from stage 1 to 2 uses the first change of the cycle
+        const StageChange& change = schedule.cycle[(previous.number - 1) % schedule.cycle.size];
+        append(schedule.stages, stage_next(previous, change));
+    }
+}
+
+static inline void load_count_change(const Json::Value& j_change, u32& increase, u32& max_count)
+{
+    if (j_change.type() == Json::Type::NONE)
+        return;
+
+    increase  = j_change[ref("increase")].int64();
+    max_count = j_change[ref("max")].int64();
+}
+
+static inline void load_delay_change(const Json::Value& j_change, f32& decrease, f32& min_delay)
+{
+    if (j_change.type() == Json::Type::NONE)
+        return;
+
+    decrease  = j_change[ref("decrease")].float64();
+    min_delay = j_change[ref("min")].float64();
+}
+
+void stage_schedule_load_from_json(const Json::Document& document, StageSchedule& schedule)
+{
+    const auto& j_data = document.start();
+
+    clear(schedule.cycle);
+    clear(schedule.stages);
+
+    {   // Cycle
+        const auto& j_cycle = j_data[ref("cycle")].array();
+        gn_assert_with_message(j_cycle.size() > 0, "Stage schedule cycle is empty!");
+
+        for (u64 i = 0; i < j_cycle.size(); i++)
+        {
+            const auto& j_change = j_cycle[i];
+
+            // Nothing changes unless the schedule says so
+            StageChange change = {};
+            change.enemy_row_max    = 0xffffffff;
+            change.enemy_column_max = 0xffffffff;
+            change.enemy_rearrange_delay_min = -Math::infinity;
+            change.enemy_kamikaze_delay_min  = -Math::infinity;
+            change.enemy_shot_delay_min      = -Math::infinity;
+
+            load_count_change(j_change[ref("enemy_row_count")], change.enemy_row_increase, change.enemy_row_max);
+            load_count_change(j_change[ref("enemy_column_count")], change.enemy_column_increase, change.enemy_column_max);
+
+            {   // Move Speed
+                const auto& j_move_speed = j_change[ref("enemy_move_speed")];
+                if (j_move_speed.type() != Json::Type::NONE)
+                {
+                    const auto& j_increase = j_move_speed[ref("increase")];
+                    change.enemy_move_speed_increase.x = j_increase[ref("x")].float64();
+                    change.enemy_move_speed_increase.y = j_increase[ref("y")].float64();
+                }
+            }
+
+            load_delay_change(j_change[ref("enemy_rearrange_delay")], change.enemy_rearrange_delay_decrease, change.enemy_rearrange_delay_min);
+            load_delay_change(j_change[ref("enemy_kamikaze_delay")], change.enemy_kamikaze_delay_decrease, change.enemy_kamikaze_delay_min);
+            load_delay_change(j_change[ref("enemy_shot_delay")], change.enemy_shot_delay_decrease, change.enemy_shot_delay_min);
+
+            append(schedule.cycle, change);
+        }
+    }
+
+    stage_schedule_compile(schedule, j_data[ref("precompiled_stage_count")].int64());
+}
+
+void stage_schedule_rebuild(StageSchedule& schedule)
+{
+    const u64 stage_count = schedule.stages.size;
+
+    clear(schedule.stages);
+    stage_schedule_compile(schedule, stage_count);
+}
+
+const StageSettings& stage_schedule_get(StageSchedule& schedule, u32 stage_number)
+{
+    gn_assert_with_message(stage_number > 0, "Stage numbers start from 1!");
+    gn_assert_with_message(schedule.cycle.size > 0, "Stage schedule isn't loaded!");
+
+    if (stage_number > schedule.stages.size)
+        stage_schedule_compile(schedule, stage_number);
+
+    return schedule.stages[stage_number - 1];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "containers/darray.h"
+#include "core/types.h"
+#include "math/vecs/vector2.h"
+#include "serialization/json.h"
+
+struct StageSettings
+{
+    u32 number;
+
+    u32 enemy_column_count;
+    u32 enemy_row_count;
+
+    Vector2 enemy_move_speed;
+
+    f32 enemy_rearrange_delay;
+    f32 enemy_kamikaze_delay;
+    f32 enemy_shot_delay;
+
+    s32 enemy_spawn_counts[3];
+};
+
+// What changes when going from one stage to the next
+// Counts only go up and delays only go down, both get clamped to their limits.
+// Fields that aren't in the schedule file leave the value untouched.
+struct StageChange
+{
+    u32 enemy_row_increase;
+    u32 enemy_row_max;
+
+    u32 enemy_column_increase;
+    u32 enemy_column_max;
+
+    Vector2 enemy_move_speed_increase;
+
+    f32 enemy_rearrange_delay_decrease;
+    f32 enemy_rearrange_delay_min;
+
+    f32 enemy_kamikaze_delay_decrease;
+    f32 enemy_kamikaze_delay_min;
+
+    f32 enemy_shot_delay_decrease;
+    f32 enemy_shot_delay_min;
+};
+
+// Stage 1 comes from the game settings, every stage after it applies the next change of the
+// cycle (wrapping around) and the spawn count increments of the game settings.
+//
+// The whole curve is compiled into a flat table when the schedule is loaded, so getting any
+// stage is a lookup. Stages past the end of the table get compiled (and kept) the first time
+// they are asked for.
+struct StageSchedule
+{
+    DynamicArray<StageChange> cycle;
+    DynamicArray<StageSettings> stages;  // stages[0] is stage 1
+};
+
+// The game settings have to be loaded first since the first stage comes from them
+void stage_schedule_load_from_json(const Json::Document& document, StageSchedule& schedule);
+
+// Compiles the table again with the same size, needed when the game settings change
+void stage_schedule_rebuild(StageSchedule& schedule);
+
+const StageSettings& stage_schedule_get(StageSchedule& schedule, u32 stage_number);
@@ -1,6 +1,7 @@
 #include "texture.h"
 
 #include "core/types.h"
+#include "containers/darray.h"
 #include "containers/string.h"
 #include "containers/hash_table.h"
 
@@ -18,18 +19,53 @@ struct TextureData
 {
     s32 width, height, bytes_pp;
     String name;
+
+    u8* pixels;     // Only kept without a GPU, for the software rasterizer
 };
 
-constexpr u32 max_loaded_textures = 10;
-static TextureData texture_data_table[max_loaded_textures] = {};
+static DynamicArray<TextureData> texture_data_table = make<DynamicArray<TextureData>>();
 
 static inline Texture internal_create_texture()
 {
     Texture texture;
+
+    #ifdef GN_HEADLESS
+    // No GPU, hand out ids the same way OpenGL would
+    static u32 next_texture_id = 1;
+    texture.id = next_texture_id++;
+    #else
     glGenTextures(1, &texture.id);
+    #endif // GN_HEADLESS
+
+    // Ids are sequential, so the table only ever grows by a few entries
+    if (texture.id >= texture_data_table.size)
+    {
+        reserve(texture_data_table, max(2 * texture_data_table.capacity, (u64) texture.id + 1));
+        platform_set_memory(texture_data_table.data + texture_data_table.size, 0, (texture.id + 1 - texture_data_table.size) * sizeof(TextureData));
+        texture_data_table.size = texture.id + 1;
+    }
+
     return texture;
 }
 
+#ifdef GN_HEADLESS
+
+// Only the texture data (size, name) is needed without a GPU
+static inline void internal_set_pixels(Texture&, u8*, s32, s32, s32, const TextureSettings&)
+{
+}
+
+static inline void internal_keep_pixels(const Texture& texture, const u8* pixels, s32 width, s32 height, s32 bytes_pp)
+{
+    const u64 size = (u64) width * height * bytes_pp;
+
+    TextureData& data = texture_data_table[texture.id];
+    data.pixels = (u8*) platform_reallocate(data.pixels, size);
+    platform_copy_memory(data.pixels, pixels, size);
+}
+
+#else
+
 static inline void internal_set_pixels(Texture& texture, u8* pixels, s32 width, s32 height, s32 bytes_pp, const TextureSettings& settings)
 {
     GLint internal_format, format;
@@ -70,6 +106,13 @@ static inline void internal_set_pixels(Texture& texture, u8* pixels, s32 width,
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint) settings.wrap_t);
 }
 
+// The GPU keeps its own copy
+static inline void internal_keep_pixels(const Texture&, const u8*, s32, s32, s32)
+{
+}
+
+#endif // GN_HEADLESS
+
 static inline void internal_set_texture_data(const Texture& texture, const String name, s32 width, s32 height, s32 bytes_pp)
 {
     texture_data_table[texture.id].width    = width;
@@ -93,10 +136,14 @@ Texture texture_load_file(const String filepath, const TextureSettings& settings
     if (desired_channels != 0)
         bytes_pp = desired_channels;
 
+    // Callers are free to release the path once it's loaded
+    const String name = copy(filepath);
+
     Texture texture = internal_create_texture();
     internal_set_pixels(texture, pixels, width, height, bytes_pp, settings);
-    internal_set_texture_data(texture, filepath, width, height, bytes_pp);
-    put(loaded_textures, filepath, texture);
+    internal_keep_pixels(texture, pixels, width, height, bytes_pp);
+    internal_set_texture_data(texture, name, width, height, bytes_pp);
+    put(loaded_textures, name, texture);
 
     stbi_image_free(pixels);
     return texture;
@@ -108,10 +155,13 @@ Texture texture_load_pixels(const String name, u8* pixels, s32 width, s32 height
     if (tex)
         return tex.value();
 
+    const String name_copy = copy(name);
+
     Texture texture = internal_create_texture();
     internal_set_pixels(texture, pixels, width, height, bytes_pp, settings);
-    internal_set_texture_data(texture, name, width, height, bytes_pp);
-    put(loaded_textures, name, texture);   
+    internal_keep_pixels(texture, pixels, width, height, bytes_pp);
+    internal_set_texture_data(texture, name_copy, width, height, bytes_pp);
+    put(loaded_textures, name_copy, texture);
 
     return texture;
 }
@@ -119,6 +169,7 @@ Texture texture_load_pixels(const String name, u8* pixels, s32 width, s32 height
 void texture_set_pixels(Texture& texture, u8* pixels, s32 width, s32 height, s32 bytes_pp,  const TextureSettings& settings)
 {
     internal_set_pixels(texture, pixels, width, height, bytes_pp, settings);
+    internal_keep_pixels(texture, pixels, width, height, bytes_pp);
     internal_set_texture_data(texture, texture_get_name(texture), width, height, bytes_pp);
 }
 
@@ -131,7 +182,15 @@ void free(Texture& texture)
     gn_assert_with_message((bool) elem, "Texture id is not 0 but hasn't been loaded properly!");
     remove(elem);
 
+    free(texture_data_table[texture.id].name);
+
+    platform_free(texture_data_table[texture.id].pixels);
+    texture_data_table[texture.id].pixels = nullptr;
+
+    #ifndef GN_HEADLESS
     glDeleteTextures(1, &texture.id);
+    #endif // GN_HEADLESS
+
     texture.id = 0;
 }
 
@@ -170,6 +229,36 @@ const String texture_get_name(const Texture& texture)
     return texture_data_table[texture.id].name;
 }
 
+const u8* texture_get_pixels(const Texture& texture)
+{
+    return texture_data_table[texture.id].pixels;
+}
+
+void texture_read_pixels(const Texture& texture, u8* pixels)
+{
+    const TextureData& data = texture_data_table[texture.id];
+
+    #ifdef GN_HEADLESS
+
+    platform_copy_memory(pixels, data.pixels, (u64) data.width * data.height * data.bytes_pp);
+
+    #else
+
+    GLenum format;
+    switch (data.bytes_pp)
+    {
+        case 1:  format = GL_RED;  break;
+        case 3:  format = GL_RGB;  break;
+        default: format = GL_RGBA; break;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glGetTexImage(GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, pixels);
+
+    #endif // GN_HEADLESS
+}
+
 bool texture_get_existing(const String name, Texture& out_texture)
 {
     auto tex = find(loaded_textures, name);
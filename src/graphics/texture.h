@@ -28,7 +28,7 @@ struct TextureSettings
     Wrapping wrap_s = Wrapping::REPEAT;
     Wrapping wrap_t = Wrapping::REPEAT;
 
-    static TextureSettings default() { return TextureSettings(); }
+    static TextureSettings defaults() { return TextureSettings(); }
 };
 
 struct Texture
@@ -47,6 +47,13 @@ s32 texture_get_height(const Texture& texture);
 s32 texture_get_bytes_pp(const Texture& texture);
 const String texture_get_name(const Texture& texture);
 
+// Bottom row first like OpenGL, only kept in headless builds (nullptr otherwise)
+const u8* texture_get_pixels(const Texture& texture);
+
+// Copies the pixels back from wherever they're kept (the GPU or the headless copy), bottom row first
+// pixels needs width * height * bytes_pp bytes
+void texture_read_pixels(const Texture& texture, u8* pixels);
+
 bool texture_get_existing(const String name, Texture& out_texture);
 
 void texture_set_pixels(Texture& texture, u8* pixels, s32 width, s32 height, s32 bytes_pp,  const TextureSettings& settings);
\ No newline at end of file
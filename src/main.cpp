@@ -3,18 +3,86 @@
 #include "core/input.h"
 #include "engine/imgui.h"
 #include "engine/sprite.h"
+#include "engine/sprite_atlas.h"
 #include "engine/sprite_serialization.h"
 #include "engine/imgui_serialization.h"
+#include "engine/telemetry.h"
 #include "fileio/fileio.h"
+#include "game/game_bot.h"
+#include "game/game_hot_reload.h"
+#include "game/game_replay.h"
 #include "game/game_state.h"
 #include "serialization/json.h"
 
 struct GameData
 {
     Imgui::Font ui_font;
+    SpriteAtlas atlas;
     GameState state;
+    Replay replay;
+
+    // Plays instead of the keyboard while active
+    GameBot bot;
+    bool bot_active;
+
+    Telemetry telemetry;
+    f32 update_time;    // Of the current frame, recorded together with the render time
+    u64 allocation_count;
 };
 
+namespace TelemetryCategory
+{
+    enum
+    {
+        PLAYER_BULLETS,
+        ENEMY_BULLETS,
+        PATTERN_BULLETS,
+        ENEMIES,
+        KAMIKAZE_ENEMIES,
+        EXPLOSIONS,
+        PICKUPS,
+        PARTICLES,
+
+        COUNT
+    };
+}
+
+static const char* telemetry_category_names[TelemetryCategory::COUNT] = {
+    "player_bullets", "enemy_bullets", "pattern_bullets", "enemies", "kamikaze_enemies", "explosions", "pickups", "particles"
+};
+
+static constexpr u64 telemetry_sample_count = 512;
+
+static void record_telemetry(GameData& data, f32 render_time)
+{
+    const GameState& state = data.state;
+    const Imgui::FrameStats frame_stats = Imgui::get_frame_stats();
+    const u64 allocation_count = platform_get_allocation_count();
+
+    TelemetrySample sample = {};
+    sample.update_time        = data.update_time;
+    sample.render_time        = render_time;
+    sample.quad_count         = frame_stats.quad_count;
+    sample.draw_call_count    = frame_stats.draw_call_count;
+    sample.texture_bind_count = frame_stats.texture_bind_count;
+    sample.batch_split_count  = frame_stats.batch_split_count;
+    sample.upload_bytes       = (u32) frame_stats.upload_bytes;
+    sample.audio_source_count = (u32) Audio::get_total_source_count();
+    sample.allocation_count   = (u32) (allocation_count - data.allocation_count);
+
+    sample.entity_counts[TelemetryCategory::PLAYER_BULLETS]   = (u32) state.player_bullets.positions.size;
+    sample.entity_counts[TelemetryCategory::ENEMY_BULLETS]    = (u32) state.enemy_bullets.positions.size;
+    sample.entity_counts[TelemetryCategory::PATTERN_BULLETS]  = (u32) state.pattern_bullets.count;
+    sample.entity_counts[TelemetryCategory::ENEMIES]          = (u32) (state.enemies[0].positions.size + state.enemies[1].positions.size + state.enemies[2].positions.size);
+    sample.entity_counts[TelemetryCategory::KAMIKAZE_ENEMIES] = (u32) state.kamikaze_enemies.positions.size;
+    sample.entity_counts[TelemetryCategory::EXPLOSIONS]       = (u32) (state.explosions.positions.size + state.power_shot_explosions.positions.size);
+    sample.entity_counts[TelemetryCategory::PICKUPS]          = (u32) state.pickups.positions.size;
+    sample.entity_counts[TelemetryCategory::PARTICLES]        = (u32) state.particles.count;
+
+    telemetry_record(data.telemetry, sample);
+    data.allocation_count = allocation_count;
+}
+
 void on_init(Application& app)
 {
     GameData& data = *(GameData*) app.data;
@@ -43,6 +111,27 @@ void on_init(Application& app)
         free(json);
     }
 
+    {   // Pack Sprite Atlas
+        data.atlas = make<SpriteAtlas>();
+
+        // Every sprite shares the same sheet, it and the font's texture aren't needed once they're in the pages
+        Texture font_texture = data.ui_font.atlas;
+        Texture sheet        = data.state.anims[0].sprites[0].atlas;
+
+        Imgui::add_to_atlas(data.atlas);
+        sprite_atlas_add_texture(data.atlas, data.ui_font.atlas);
+        sprite_atlas_add_animations(data.atlas, data.state.anims);
+
+        sprite_atlas_pack(data.atlas, ref((char*) sprite_atlas_cache_path));
+
+        Imgui::move_to_atlas(data.atlas);
+        Imgui::font_move_to_atlas(data.ui_font, data.atlas);
+        sprite_atlas_remap_animations(data.atlas, data.state.anims);
+
+        sprite_atlas_free_source(data.atlas, font_texture);
+        sprite_atlas_free_source(data.atlas, sheet);
+    }
+
     {   // Load Settings
         String json = file_load_string(ref("assets/settings/game_settings.json"));
 
@@ -55,21 +144,125 @@ void on_init(Application& app)
         free(json);
     }
 
+    {   // Load Stage Schedule
+        String json = file_load_string(ref("assets/settings/stage_schedule.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        stage_schedule_load_from_json(document, data.state.stage_schedule);
+
+        free(document);
+        free(json);
+    }
+
+    {   // Load Bullet Patterns
+        String json = file_load_string(ref("assets/settings/bullet_patterns.json"));
+
+        Json::Document document = {};
+        Json::parse_string(json, document); // Ignoring success value
+
+        bullet_patterns_load_from_json(document, data.state.bullet_patterns);
+
+        free(document);
+        free(json);
+    }
+
     game_state_init(app, data.state);
 
     game_background_init(app, data.state);
+
+    data.telemetry = make<Telemetry>(telemetry_sample_count);
+    telemetry_set_entity_categories(data.telemetry, telemetry_category_names, TelemetryCategory::COUNT);
+    data.allocation_count = platform_get_allocation_count();
+
+    #ifndef GN_RELEASE
+
+    // Tuning data changes show up without restarting
+    hot_reload_start();
+
+    #endif // GN_RELEASE
 }
 
 void on_update(Application& app)
 {
     GameData& data = *(GameData*) app.data;
-    game_state_update(app, data.state);
+
+    #ifndef GN_RELEASE
+
+    // Before anything ticks so the whole frame runs with the same values
+    // Recordings and playbacks would desync if the tuning data changed halfway, so they wait until the replay stops
+    hot_reload_apply(data.state, data.replay.mode != ReplayMode::NONE);
+
+    if (data.state.is_debug)
+    {
+        // F5: Start / stop recording, F6: Play the last recording
+        if (Input::get_key_down(Key::F5))
+        {
+            if (data.replay.mode == ReplayMode::RECORDING)
+                replay_stop(data.replay);
+            else
+            {
+                const u64 seed = ((u64) rand() << 32) | (u64) rand();
+                replay_start_recording(app, data.replay, data.state, seed);
+            }
+        }
+
+        if (Input::get_key_down(Key::F6) && data.replay.mode != ReplayMode::RECORDING)
+        {
+            if (data.replay.frames.size > 0 || replay_load_file(ref(replay_file_name, replay_file_name_size), data.replay))
+                replay_start_playback(app, data.replay, data.state);
+        }
+
+        // F7: Let the bot play
+        if (Input::get_key_down(Key::F7))
+        {
+            if (!data.bot_active)
+                data.bot = make<GameBot>(((u64) rand() << 32) | (u64) rand(), 1.0f);
+
+            data.bot_active = !data.bot_active;
+        }
+
+        // F8: Save the telemetry of the last few seconds
+        if (Input::get_key_down(Key::F8))
+        {
+            telemetry_save_csv(data.telemetry, ref("telemetry.csv"));
+            telemetry_save_json(data.telemetry, ref("telemetry.json"));
+        }
+    }
+
+    #endif // GN_RELEASE
+
+    const f64 start_time = platform_get_time();
+
+    if (data.replay.mode != ReplayMode::NONE)
+    {
+        const bool was_recording = (data.replay.mode == ReplayMode::RECORDING);
+
+        replay_update(app, data.replay, data.state);
+
+        if (was_recording && data.replay.mode == ReplayMode::NONE)
+            replay_save_file(ref(replay_file_name, replay_file_name_size), data.replay);
+    }
+    else
+    {
+        if (data.bot_active)
+            data.state.input = game_bot_get_input(data.bot, data.state, app.delta_time);
+        else
+            data.state.input = game_input_from_keyboard(data.state.player_settings.control_scheme);
+
+        game_state_update(app, data.state);
+    }
+
+    data.update_time = (f32) (platform_get_time() - start_time);
 }
 
 void on_render(Application& app)
 {
     GameData& data = *(GameData*) app.data;
 
+    const f64 start_time = platform_get_time();
+
     Imgui::begin();
 
     game_state_render(app, data.state, data.ui_font);
@@ -78,20 +271,50 @@ void on_render(Application& app)
 
     if (data.state.is_debug)
     {
-        char buffer[256];
-        sprintf(buffer, "Frame Rate: %f\nActive Bullets: %d\nActive Enemies: %d\nActive Explosions: %d\nTotal Sources: %d",
+        const HotReloadStats reload_stats = hot_reload_get_stats();
+
+        // The stats of the last frame, this one isn't submitted yet
+        const u64 sample_count = telemetry_get_sample_count(data.telemetry);
+        const TelemetrySample last_sample = (sample_count > 0) ? telemetry_get_sample(data.telemetry, sample_count - 1) : TelemetrySample {};
+
+        char buffer[512];
+        sprintf(buffer, "Frame Rate: %f\nActive Bullets: %d\nActive Enemies: %d\nActive Explosions: %d\nTotal Sources: %d\nReloads: %d (Latency: %.2f ms)\n"
+                        "Draw Calls: %u (Splits: %u)\nQuads: %u (Uploaded: %.1f KB)\nTexture Binds: %u",
             1.0f / app.delta_time,
             (s32) data.state.player_bullets.positions.size,
             (s32) (data.state.enemies[0].positions.size + data.state.enemies[1].positions.size + data.state.enemies[2].positions.size),
             (s32) data.state.explosions.positions.size,
-            Audio::get_total_source_count()
+            Audio::get_total_source_count(),
+            (s32) reload_stats.reload_count,
+            reload_stats.latency * 1000.0,
+            last_sample.draw_call_count, last_sample.batch_split_count,
+            last_sample.quad_count, last_sample.upload_bytes / 1024.0,
+            last_sample.texture_bind_count
         );
         Imgui::render_text(ref(buffer), data.ui_font, Vector2 {}, 0);
+
+        // Last few seconds of frame times, anything over half the height missed the target
+        const f32 graph_width = 0.5f * app.window.ref_width;
+        const Rect graph_area = Rect { app.window.ref_width - graph_width - 10.0f, 10.0f, app.window.ref_width - 10.0f, 90.0f };
+        telemetry_render_graph(data.telemetry, graph_area, 0, 1.0f / 60.0f);
     }
 
     #endif // GN_RELEASE
 
     Imgui::end();
+
+    record_telemetry(data, (f32) (platform_get_time() - start_time));
+}
+
+void on_shutdown(Application& app)
+{
+    GameData& data = *(GameData*) app.data;
+    free(data.telemetry);
+    free(data.atlas);
+
+    #ifndef GN_RELEASE
+    hot_reload_stop();
+    #endif // GN_RELEASE
 }
 
 void on_window_resize(Application& app)
@@ -120,6 +343,7 @@ void create_app(Application& app)
     app.on_update = on_update;
     app.on_render = on_render;
     app.on_window_resize = on_window_resize;
+    app.on_shutdown = on_shutdown;
 
     app.data = platform_allocate(sizeof(GameData));
     *(GameData*) app.data = GameData {};
@@ -100,7 +100,7 @@ f32 almost_equals(f32 a, f32 b, f32 epsilon = 0.001f)
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
 f32 sign(f32 t)
 {
-    return __signbitvaluef(t);
+    return std::signbit(t);
 }
 
 GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
@@ -166,4 +166,31 @@ f32 random()
     return rand() / (f32) RAND_MAX;
 }
 
+// Seedable random number generator (xorshift64*)
+// Used wherever the sequence of numbers needs to be reproducible
+struct Random
+{
+    u64 state;
+};
+
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+void random_seed(Random& rng, u64 seed)
+{
+    // xorshift gets stuck if the state is ever 0
+    rng.state = (seed != 0) ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+// Gives a random float in the range [0, 1) and advances the generator
+GN_DISABLE_SECURITY_COOKIE_CHECK GN_FORCE_INLINE
+f32 random(Random& rng)
+{
+    rng.state ^= rng.state >> 12;
+    rng.state ^= rng.state << 25;
+    rng.state ^= rng.state >> 27;
+
+    // Top 24 bits fit exactly in the mantissa of a float
+    const u64 value = rng.state * 0x2545F4914F6CDD1Dull;
+    return (f32) (value >> 40) * (1.0f / 16777216.0f);
+}
+
 } // namespace Math
\ No newline at end of file
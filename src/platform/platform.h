@@ -25,6 +25,9 @@ void* platform_allocate(u64 size);                   // TODO: Option for aligned
 void* platform_reallocate(void* block, u64 size);    // TODO: Option for aligned memory
 void  platform_free(void* block);                    // TODO: Option for aligned memory
 
+// Calls to platform_allocate and platform_reallocate so far (frees aren't subtracted)
+u64 platform_get_allocation_count();
+
 void* platform_zero_memory(void* block, u64 size);
 void* platform_copy_memory(void* dest, const void* source, u64 size);
 void* platform_set_memory(void* dest, s32 value, u64 size);
@@ -37,6 +40,30 @@ void platform_init_clock();
 f64  platform_get_time_absolute();
 f64  platform_get_time();
 
+// Thread Stuff
+
+typedef void (*PlatformThreadProc)(void* data);
+
+struct PlatformThread
+{
+    void* handle;
+};
+
+struct PlatformSemaphore
+{
+    void* handle;
+};
+
+bool platform_thread_start(PlatformThread& thread, PlatformThreadProc proc, void* data);
+void platform_thread_join(PlatformThread& thread);
+void platform_thread_yield();
+u32  platform_get_processor_count();
+
+bool platform_semaphore_create(PlatformSemaphore& semaphore, u32 initial_count);
+void platform_semaphore_destroy(PlatformSemaphore& semaphore);
+void platform_semaphore_signal(PlatformSemaphore& semaphore, u32 count = 1);
+void platform_semaphore_wait(PlatformSemaphore& semaphore);
+
 // Input Stuff
 
 void platform_get_mouse_position(s32& x, s32& y);
@@ -45,4 +72,20 @@ void platform_show_mouse_cursor(bool value);
 
 // File Stuff
 
-bool platform_dialogue_open_file(const char filter[], char* out_filepath, u32 max_path_size);
\ No newline at end of file
+bool platform_dialogue_open_file(const char filter[], char* out_filepath, u32 max_path_size);
+
+// Only makes the last directory of the path, returns true if it's there afterwards (made now or already)
+bool platform_create_directory(const char* path);
+
+// Watches the files directly inside a directory for changes (including editors that save by renaming a temp file)
+struct PlatformFileWatch
+{
+    void* handle;
+};
+
+bool platform_file_watch_start(PlatformFileWatch& watch, const char* directory);
+void platform_file_watch_stop(PlatformFileWatch& watch);
+
+// Waits up to timeout_ms for a change and writes the name (relative to the directory) of the changed file
+// Returns false if nothing changed in time. A single save can report the same file more than once.
+bool platform_file_watch_poll(PlatformFileWatch& watch, u32 timeout_ms, char* out_filename, u32 max_filename_size);
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "platform.h"
+
+#ifdef GN_PLATFORM_LINUX
+
+#include "core/types.h"
+#include "core/logger.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Only the headless parts of the platform layer are implemented on linux for now.
+// This is enough for tools like the gameplay benchmark which never open a window.
+
+// Clock Stuff
+static f64 start_time;
+
+// Window Stuff
+
+bool platform_window_startup(PlatformState&, const char*, int, int, int, int, const char*, WindowStyle)
+{
+    print_error("Error: Windows are not supported on linux yet!\n");
+    return false;
+}
+
+void platform_window_shutdown(PlatformState&)
+{
+}
+
+bool platform_pump_messages()
+{
+    return true;
+}
+
+void platform_set_window_style(WindowStyle)
+{
+}
+
+// Memory Stuff
+static std::atomic<u64> allocation_count = { 0 };
+
+void* platform_allocate(u64 size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size);
+}
+
+void* platform_reallocate(void* block, u64 size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return realloc(block, size);
+}
+
+u64 platform_get_allocation_count()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+void platform_free(void* block)
+{
+    free(block);
+}
+
+void* platform_zero_memory(void* dest, u64 size)
+{
+    return memset(dest, 0, size);
+}
+
+void* platform_copy_memory(void* dest, const void* source, u64 size)
+{
+    return memcpy(dest, source, size);
+}
+
+void* platform_set_memory(void* dest, s32 value, u64 size)
+{
+    return memset(dest, value, size);
+}
+
+bool platform_compare_memory(const void* ptr1, const void* ptr2, u64 size)
+{
+    return memcmp(ptr1, ptr2, size) == 0;
+}
+
+// Time Stuff
+
+void platform_init_clock()
+{
+    start_time = platform_get_time_absolute();
+}
+
+f64 platform_get_time_absolute()
+{
+    timespec now_time;
+    clock_gettime(CLOCK_MONOTONIC, &now_time);
+    return (f64) now_time.tv_sec + (f64) now_time.tv_nsec * 1e-9;
+}
+
+f64 platform_get_time()
+{
+    return platform_get_time_absolute() - start_time;
+}
+
+// Thread Stuff
+
+struct ThreadStart
+{
+    PlatformThreadProc proc;
+    void* data;
+};
+
+static void* thread_start(void* data)
+{
+    // Copied so the allocation can be freed before the thread runs for a long time
+    const ThreadStart start = *(ThreadStart*) data;
+    platform_free(data);
+
+    start.proc(start.data);
+    return nullptr;
+}
+
+bool platform_thread_start(PlatformThread& thread, PlatformThreadProc proc, void* data)
+{
+    ThreadStart* start = (ThreadStart*) platform_allocate(sizeof(ThreadStart));
+    *start = ThreadStart { proc, data };
+
+    pthread_t* handle = (pthread_t*) platform_allocate(sizeof(pthread_t));
+    if (pthread_create(handle, nullptr, thread_start, start) != 0)
+    {
+        platform_free(start);
+        platform_free(handle);
+        thread.handle = nullptr;
+        return false;
+    }
+
+    thread.handle = handle;
+    return true;
+}
+
+void platform_thread_join(PlatformThread& thread)
+{
+    pthread_t* handle = (pthread_t*) thread.handle;
+    pthread_join(*handle, nullptr);
+
+    platform_free(handle);
+    thread.handle = nullptr;
+}
+
+void platform_thread_yield()
+{
+    sched_yield();
+}
+
+u32 platform_get_processor_count()
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (u32) count : 1;
+}
+
+bool platform_semaphore_create(PlatformSemaphore& semaphore, u32 initial_count)
+{
+    sem_t* handle = (sem_t*) platform_allocate(sizeof(sem_t));
+    if (sem_init(handle, 0, initial_count) != 0)
+    {
+        platform_free(handle);
+        semaphore.handle = nullptr;
+        return false;
+    }
+
+    semaphore.handle = handle;
+    return true;
+}
+
+void platform_semaphore_destroy(PlatformSemaphore& semaphore)
+{
+    sem_destroy((sem_t*) semaphore.handle);
+    platform_free(semaphore.handle);
+    semaphore.handle = nullptr;
+}
+
+void platform_semaphore_signal(PlatformSemaphore& semaphore, u32 count)
+{
+    for (u32 i = 0; i < count; i++)
+        sem_post((sem_t*) semaphore.handle);
+}
+
+void platform_semaphore_wait(PlatformSemaphore& semaphore)
+{
+    // Retry if a signal interrupted the wait
+    while (sem_wait((sem_t*) semaphore.handle) != 0)
+        ;
+}
+
+// Input Stuff
+
+void platform_get_mouse_position(s32& x, s32& y)
+{
+    x = y = 0;
+}
+
+void platform_set_mouse_position(s32, s32)
+{
+}
+
+void platform_show_mouse_cursor(bool)
+{
+}
+
+// File Stuff
+
+bool platform_dialogue_open_file(const char[], char*, u32)
+{
+    return false;
+}
+
+bool platform_create_directory(const char* path)
+{
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+struct FileWatchState
+{
+    int fd;
+
+    // A single read can return several events, the rest are handed out by the next polls
+    alignas(inotify_event) char events[4096];
+    u32 size;
+    u32 offset;
+};
+
+bool platform_file_watch_start(PlatformFileWatch& watch, const char* directory)
+{
+    watch.handle = nullptr;
+
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    if (inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    FileWatchState* state = (FileWatchState*) platform_allocate(sizeof(FileWatchState));
+    state->fd = fd;
+    state->size = state->offset = 0;
+
+    watch.handle = state;
+    return true;
+}
+
+void platform_file_watch_stop(PlatformFileWatch& watch)
+{
+    FileWatchState* state = (FileWatchState*) watch.handle;
+    close(state->fd);
+
+    platform_free(state);
+    watch.handle = nullptr;
+}
+
+bool platform_file_watch_poll(PlatformFileWatch& watch, u32 timeout_ms, char* out_filename, u32 max_filename_size)
+{
+    FileWatchState* state = (FileWatchState*) watch.handle;
+
+    while (true)
+    {
+        while (state->offset < state->size)
+        {
+            const inotify_event* event = (const inotify_event*) (state->events + state->offset);
+            state->offset += sizeof(inotify_event) + event->len;
+
+            // Events without a name are about the directory itself
+            if (event->len == 0)
+                continue;
+
+            strncpy(out_filename, event->name, max_filename_size - 1);
+            out_filename[max_filename_size - 1] = '\0';
+            return true;
+        }
+
+        pollfd poll_fd = { state->fd, POLLIN, 0 };
+        if (poll(&poll_fd, 1, (int) timeout_ms) <= 0)
+            return false;
+
+        const ssize_t size = read(state->fd, state->events, sizeof(state->events));
+        if (size <= 0)
+            return false;
+
+        state->size = (u32) size;
+        state->offset = 0;
+    }
+}
+
+#endif // GN_PLATFORM_LINUX
@@ -9,6 +9,7 @@
 #include "graphics/graphics.h"
 #include "application/application.h"
 #include "application/application_internal.h"
+#include <atomic>
 #include <cstdlib>
 #include <windows.h>
 
@@ -166,16 +167,25 @@ void platform_set_window_style(WindowStyle style)
 }
 
 // Memory Stuff
+static std::atomic<u64> allocation_count = { 0 };
+
 void* platform_allocate(u64 size)
 {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
     return malloc(size);
 }
 
 void* platform_reallocate(void* block, u64 size)
 {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
     return realloc(block, size);
 }
 
+u64 platform_get_allocation_count()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
 void platform_free(void* block)
 {
     free(block);
@@ -225,6 +235,80 @@ f64 platform_get_time()
     return (f64) (now_time.QuadPart - start_time.QuadPart) * clock_frequency;
 }
 
+// Thread Stuff
+
+struct ThreadStart
+{
+    PlatformThreadProc proc;
+    void* data;
+};
+
+static DWORD WINAPI thread_start(LPVOID data)
+{
+    // Copied so the allocation can be freed before the thread runs for a long time
+    const ThreadStart start = *(ThreadStart*) data;
+    platform_free(data);
+
+    start.proc(start.data);
+    return 0;
+}
+
+bool platform_thread_start(PlatformThread& thread, PlatformThreadProc proc, void* data)
+{
+    ThreadStart* start = (ThreadStart*) platform_allocate(sizeof(ThreadStart));
+    *start = ThreadStart { proc, data };
+
+    thread.handle = CreateThread(NULL, 0, thread_start, start, 0, NULL);
+    if (!thread.handle)
+    {
+        platform_free(start);
+        return false;
+    }
+
+    return true;
+}
+
+void platform_thread_join(PlatformThread& thread)
+{
+    WaitForSingleObject((HANDLE) thread.handle, INFINITE);
+    CloseHandle((HANDLE) thread.handle);
+    thread.handle = nullptr;
+}
+
+void platform_thread_yield()
+{
+    SwitchToThread();
+}
+
+u32 platform_get_processor_count()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (u32) info.dwNumberOfProcessors : 1;
+}
+
+bool platform_semaphore_create(PlatformSemaphore& semaphore, u32 initial_count)
+{
+    semaphore.handle = CreateSemaphoreA(NULL, (LONG) initial_count, MAXLONG, NULL);
+    return semaphore.handle != nullptr;
+}
+
+void platform_semaphore_destroy(PlatformSemaphore& semaphore)
+{
+    CloseHandle((HANDLE) semaphore.handle);
+    semaphore.handle = nullptr;
+}
+
+void platform_semaphore_signal(PlatformSemaphore& semaphore, u32 count)
+{
+    ReleaseSemaphore((HANDLE) semaphore.handle, (LONG) count, NULL);
+}
+
+void platform_semaphore_wait(PlatformSemaphore& semaphore)
+{
+    WaitForSingleObject((HANDLE) semaphore.handle, INFINITE);
+}
+
 LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM wParam, LPARAM lParam)
 {
     PlatformState* pstate = g_pstate;
@@ -385,4 +469,113 @@ bool platform_dialogue_open_file(const char filter[], char* out_filepath, u32 ma
     return false;
 }
 
+bool platform_create_directory(const char* path)
+{
+    return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+struct FileWatchState
+{
+    HANDLE directory;
+    OVERLAPPED overlapped;
+
+    // The system writes into changes while a read is pending, finished reads are copied to
+    // events so the next read can start right away and the events are handed out one per poll
+    alignas(DWORD) u8 changes[4096];
+    alignas(DWORD) u8 events[4096];
+    DWORD size;
+    DWORD offset;
+};
+
+static inline bool file_watch_read(FileWatchState* state)
+{
+    return ReadDirectoryChangesW(state->directory, state->changes, sizeof(state->changes), FALSE,
+                                 FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+                                 NULL, &state->overlapped, NULL);
+}
+
+bool platform_file_watch_start(PlatformFileWatch& watch, const char* directory)
+{
+    watch.handle = nullptr;
+
+    HANDLE handle = CreateFileA(directory, FILE_LIST_DIRECTORY,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    FileWatchState* state = (FileWatchState*) platform_allocate(sizeof(FileWatchState));
+    platform_zero_memory(state, sizeof(FileWatchState));
+
+    state->directory = handle;
+    state->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    if (!state->overlapped.hEvent || !file_watch_read(state))
+    {
+        if (state->overlapped.hEvent)
+            CloseHandle(state->overlapped.hEvent);
+
+        CloseHandle(handle);
+        platform_free(state);
+        return false;
+    }
+
+    watch.handle = state;
+    return true;
+}
+
+void platform_file_watch_stop(PlatformFileWatch& watch)
+{
+    FileWatchState* state = (FileWatchState*) watch.handle;
+
+    // The pending read has to finish before its buffer can be freed
+    CancelIo(state->directory);
+
+    DWORD bytes;
+    GetOverlappedResult(state->directory, &state->overlapped, &bytes, TRUE);
+
+    CloseHandle(state->overlapped.hEvent);
+    CloseHandle(state->directory);
+
+    platform_free(state);
+    watch.handle = nullptr;
+}
+
+bool platform_file_watch_poll(PlatformFileWatch& watch, u32 timeout_ms, char* out_filename, u32 max_filename_size)
+{
+    FileWatchState* state = (FileWatchState*) watch.handle;
+
+    while (true)
+    {
+        while (state->offset < state->size)
+        {
+            const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*) (state->events + state->offset);
+            state->offset = (info->NextEntryOffset != 0) ? state->offset + info->NextEntryOffset : state->size;
+
+            if (info->Action != FILE_ACTION_ADDED && info->Action != FILE_ACTION_MODIFIED && info->Action != FILE_ACTION_RENAMED_NEW_NAME)
+                continue;
+
+            const int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR),
+                                                   out_filename, max_filename_size - 1, NULL, NULL);
+            out_filename[length] = '\0';
+            return true;
+        }
+
+        if (WaitForSingleObject(state->overlapped.hEvent, timeout_ms) != WAIT_OBJECT_0)
+            return false;
+
+        DWORD size = 0;
+        GetOverlappedResult(state->directory, &state->overlapped, &size, FALSE);
+        ResetEvent(state->overlapped.hEvent);
+
+        // A size of 0 means the changes didn't fit, nothing to hand out but the watch goes on
+        platform_copy_memory(state->events, state->changes, size);
+        state->size = size;
+        state->offset = 0;
+
+        file_watch_read(state);
+    }
+}
+
 #endif // GN_PLATFORM_WINDOWS
\ No newline at end of file
@@ -138,7 +138,7 @@ static void encode_json_value_to_binary(DynamicArray<u8>& bytes, Json::Value val
 
 Bytes json_document_to_binary(const Json::Document& document)
 {
-    DynamicArray<u8> output = make<DynamicArray<u8>>(1024ui64);
+    DynamicArray<u8> output = make<DynamicArray<u8>>(1024ull);
 
     encode_json_value_to_binary(output, document.start());
 
@@ -139,17 +139,17 @@ static inline void append_string(DynamicArray<u8>& bytes, const String str)
 static inline void append_bytes(DynamicArray<u8>& bytes, const u8* raw_bytes, const u64 size)
 {
     // encode array length
-    if (size <= 0xffUi64)
+    if (size <= 0xffull)
     {
         append(bytes, Binary::BYTE_ARRAY_1_BYTE);
         Binary::append_integer(bytes, (u8) size);
     }
-    else if (size <= 0xffffUi64)
+    else if (size <= 0xffffull)
     {
         append(bytes, Binary::BYTE_ARRAY_2_BYTE);
         Binary::append_integer(bytes, (u16) size);
     }
-    else if (size <= 0xffffffffUi64)
+    else if (size <= 0xffffffffull)
     {
         append(bytes, Binary::BYTE_ARRAY_4_BYTE);
         Binary::append_integer(bytes, (u32) size);
@@ -24,7 +24,7 @@ inline static bool is_digit(char ch)
 bool lex(const String content, DynamicArray<Token>& tokens)
 {
     clear(tokens);
-    resize(tokens, max(2ui64, content.size / 10)); // Just an estimate
+    resize(tokens, max(2ull, content.size / 10)); // Just an estimate
 
     bool encountered_error = false;
     u64 current_index = 0;
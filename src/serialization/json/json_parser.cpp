@@ -113,7 +113,7 @@ static void parse_next(const DynamicArray<Token>& tokens, ParserContext& context
 
             // TODO: convert string to integer on your own with error checking
             Resource res = {};
-            res.integer64 = _atoi64(token.value.data);
+            res.integer64 = strtoll(token.value.data, nullptr, 10);
             append(out.resources, res);
 
             DependencyNode node = {};